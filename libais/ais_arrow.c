@@ -0,0 +1,951 @@
+/*
+ * Apache Arrow IPC stream output of decoded AIS messages.
+ *
+ * Rows are appended column by column into growable buffers and
+ * written out as one record batch per flush.  The message metadata is
+ * FlatBuffers-encoded (Schema.fbs and Message.fbs in the Arrow
+ * sources); the handful of tables needed are laid out by hand below,
+ * front to back, so that every offset points forward.
+ *
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <assert.h>
+
+#include "libais.h"
+#include "ais_arrow.h"
+
+/* a growable byte buffer */
+struct arrow_buf_t {
+    unsigned char *data;
+    size_t len;
+    size_t size;
+};
+
+enum arrow_kind_t {
+    arrow_uint8,
+    arrow_uint16,
+    arrow_uint32,
+    arrow_int8,
+    arrow_float,
+    arrow_double,
+    arrow_bool,
+    arrow_utf8,
+    arrow_binary,
+    arrow_timestamp,		/* seconds since the epoch, UTC */
+};
+
+struct arrow_field_t {
+    const char *name;
+    enum arrow_kind_t kind;
+    bool nullable;
+};
+
+struct arrow_column_t {
+    struct arrow_buf_t validity;
+    struct arrow_buf_t values;	/* for strings, the offsets */
+    struct arrow_buf_t data;	/* string bytes */
+    size_t nulls;
+};
+
+struct ais_arrow_t {
+    enum ais_arrow_family_t family;
+    FILE *fp;
+    const struct arrow_field_t *field;
+    size_t nfields;
+    struct arrow_column_t *column;
+    size_t rows;
+    size_t col;			/* next column of the row being added */
+    bool error;
+};
+
+#define ARROW_HEADER_FIELDS \
+    {"type", arrow_uint8, false}, \
+    {"repeat", arrow_uint8, false}, \
+    {"mmsi", arrow_uint32, false}
+
+static const struct arrow_field_t position_fields[] = {
+    ARROW_HEADER_FIELDS,
+    {"status", arrow_uint8, true},
+    {"turn", arrow_int8, true},
+    {"speed", arrow_float, true},
+    {"accuracy", arrow_bool, false},
+    {"lon", arrow_double, true},
+    {"lat", arrow_double, true},
+    {"course", arrow_float, true},
+    {"heading", arrow_uint16, true},
+    {"second", arrow_uint8, true},
+    {"raim", arrow_bool, false},
+};
+
+static const struct arrow_field_t static_fields[] = {
+    ARROW_HEADER_FIELDS,
+    {"imo", arrow_uint32, true},
+    {"ais_version", arrow_uint8, true},
+    {"callsign", arrow_utf8, true},
+    {"shipname", arrow_utf8, true},
+    {"shiptype", arrow_uint8, true},
+    {"vendorid", arrow_utf8, true},
+    {"model", arrow_uint8, true},
+    {"serial", arrow_uint32, true},
+    {"mothership_mmsi", arrow_uint32, true},
+    {"to_bow", arrow_uint16, true},
+    {"to_stern", arrow_uint16, true},
+    {"to_port", arrow_uint8, true},
+    {"to_starboard", arrow_uint8, true},
+    {"epfd", arrow_uint8, true},
+    {"eta_month", arrow_uint8, true},
+    {"eta_day", arrow_uint8, true},
+    {"eta_hour", arrow_uint8, true},
+    {"eta_minute", arrow_uint8, true},
+    {"draught", arrow_float, true},
+    {"destination", arrow_utf8, true},
+    {"dte", arrow_uint8, true},
+};
+
+static const struct arrow_field_t base_fields[] = {
+    ARROW_HEADER_FIELDS,
+    {"timestamp", arrow_timestamp, true},
+    {"year", arrow_uint16, true},
+    {"month", arrow_uint8, true},
+    {"day", arrow_uint8, true},
+    {"hour", arrow_uint8, true},
+    {"minute", arrow_uint8, true},
+    {"second", arrow_uint8, true},
+    {"accuracy", arrow_bool, false},
+    {"lon", arrow_double, true},
+    {"lat", arrow_double, true},
+    {"epfd", arrow_uint8, true},
+    {"raim", arrow_bool, false},
+};
+
+static const struct arrow_field_t binary_fields[] = {
+    ARROW_HEADER_FIELDS,
+    {"dest_mmsi", arrow_uint32, true},
+    {"dac", arrow_uint16, true},
+    {"fid", arrow_uint8, true},
+    {"bitcount", arrow_uint16, false},
+    {"data", arrow_binary, true},
+};
+
+static const struct {
+    const struct arrow_field_t *field;
+    size_t nfields;
+} families[AIS_ARROW_FAMILIES] = {
+    [ais_arrow_positions] = {position_fields, NITEMS(position_fields)},
+    [ais_arrow_static] = {static_fields, NITEMS(static_fields)},
+    [ais_arrow_base] = {base_fields, NITEMS(base_fields)},
+    [ais_arrow_binary] = {binary_fields, NITEMS(binary_fields)},
+};
+
+int ais_arrow_family(unsigned int type)
+/* the family a message type is written with, or -1 */
+{
+    switch (type) {
+    case 1:
+    case 2:
+    case 3:
+    case 18:
+    case 19:
+    case 27:
+	return ais_arrow_positions;
+    case 5:
+    case 24:
+	return ais_arrow_static;
+    case 4:
+    case 11:
+	return ais_arrow_base;
+    case 6:
+    case 8:
+    case 25:
+    case 26:
+	return ais_arrow_binary;
+    default:
+	return -1;
+    }
+}
+
+/*
+ * Buffers
+ */
+
+static bool buf_reserve(struct arrow_buf_t *b, size_t n)
+{
+    if (b->len + n > b->size) {
+	size_t size = b->size != 0 ? b->size : 256;
+	unsigned char *data;
+
+	while (size < b->len + n)
+	    size *= 2;
+	if ((data = realloc(b->data, size)) == NULL)
+	    return false;
+	b->data = data;
+	b->size = size;
+    }
+    return true;
+}
+
+static bool buf_put(struct arrow_buf_t *b, const void *p, size_t n)
+{
+    if (!buf_reserve(b, n))
+	return false;
+    (void)memcpy(b->data + b->len, p, n);
+    b->len += n;
+    return true;
+}
+
+static bool buf_le(struct arrow_buf_t *b, uint64_t val, size_t n)
+/* n bytes of val, little-endian */
+{
+    unsigned char *p;
+    size_t i;
+
+    if (!buf_reserve(b, n))
+	return false;
+    p = b->data + b->len;
+    for (i = 0; i < n; i++)
+	p[i] = (unsigned char)(val >> (CHAR_BIT * i));
+    b->len += n;
+    return true;
+}
+
+static bool buf_pad(struct arrow_buf_t *b, size_t align)
+{
+    size_t n = (align - b->len % align) % align;
+
+    if (!buf_reserve(b, n))
+	return false;
+    (void)memset(b->data + b->len, '\0', n);
+    b->len += n;
+    return true;
+}
+
+static bool buf_bit(struct arrow_buf_t *b, size_t i, bool set)
+/* set bit i of a bitmap that grows one bit at a time */
+{
+    if (i % CHAR_BIT == 0 && !buf_le(b, 0, 1))
+	return false;
+    if (set)
+	b->data[i / CHAR_BIT] |= (unsigned char)(1U << (i % CHAR_BIT));
+    return true;
+}
+
+/*
+ * Column appenders.  Each takes the next column of the current row.
+ */
+
+static struct arrow_column_t *arrow_next(struct ais_arrow_t *w, bool valid)
+{
+    struct arrow_column_t *c = &w->column[w->col++];
+
+    if (!buf_bit(&c->validity, w->rows, valid))
+	w->error = true;
+    if (!valid)
+	c->nulls++;
+    return c;
+}
+
+static void arrow_add_int(struct ais_arrow_t *w, long long val, bool valid)
+{
+    static const size_t width[] = {
+	[arrow_uint8] = 1, [arrow_uint16] = 2, [arrow_uint32] = 4,
+	[arrow_int8] = 1, [arrow_timestamp] = 8,
+    };
+    enum arrow_kind_t kind = w->field[w->col].kind;
+    struct arrow_column_t *c = arrow_next(w, valid);
+
+    if (!buf_le(&c->values, valid ? (uint64_t)val : 0, width[kind]))
+	w->error = true;
+}
+
+static void arrow_add_real(struct ais_arrow_t *w, double val, bool valid)
+{
+    enum arrow_kind_t kind = w->field[w->col].kind;
+    struct arrow_column_t *c = arrow_next(w, valid);
+    bool ok;
+
+    if (!valid)
+	val = 0;
+    if (kind == arrow_float) {
+	float f = (float)val;
+	uint32_t bits;
+
+	(void)memcpy(&bits, &f, sizeof(bits));
+	ok = buf_le(&c->values, bits, sizeof(bits));
+    } else {
+	uint64_t bits;
+
+	(void)memcpy(&bits, &val, sizeof(bits));
+	ok = buf_le(&c->values, bits, sizeof(bits));
+    }
+    if (!ok)
+	w->error = true;
+}
+
+static void arrow_add_bool(struct ais_arrow_t *w, bool val)
+{
+    struct arrow_column_t *c = arrow_next(w, true);
+
+    if (!buf_bit(&c->values, w->rows, val))
+	w->error = true;
+}
+
+static void arrow_add_bytes(struct ais_arrow_t *w,
+			    /*@null@*/const void *p, size_t len)
+/* a string or binary value; NULL for a null */
+{
+    struct arrow_column_t *c = arrow_next(w, p != NULL);
+
+    if ((p != NULL && !buf_put(&c->data, p, len))
+	|| !buf_le(&c->values, c->data.len, sizeof(int32_t)))
+	w->error = true;
+}
+
+static void arrow_add_text(struct ais_arrow_t *w,
+			   const char *str, size_t size, bool valid)
+/* a NUL-terminated string from a char array of the given size */
+{
+    arrow_add_bytes(w, valid ? str : NULL, valid ? strnlen(str, size) : 0);
+}
+
+#define ARROW_TEXT(w, member, valid) \
+	arrow_add_text(w, member, sizeof(member), valid)
+
+/*
+ * Rows, one function per family.  They must add exactly the columns of
+ * the family's field table, in order.
+ */
+
+static void arrow_header(struct ais_arrow_t *w, const struct ais_t *ais)
+{
+    arrow_add_int(w, ais->type, true);
+    arrow_add_int(w, ais->repeat, true);
+    arrow_add_int(w, ais->mmsi, true);
+}
+
+static void position_row(struct ais_arrow_t *w, const struct ais_t *ais)
+{
+    unsigned int status = 0, speed, course;
+    unsigned int heading = AIS_HEADING_NOT_AVAILABLE;
+    unsigned int second = AIS_SEC_NOT_AVAILABLE;
+    int turn = AIS_TURN_NOT_AVAILABLE, lon, lat;
+    bool accuracy, raim, longrange = false;
+    double div = AIS_LATLON_DIV;
+
+    switch (ais->type) {
+    case 18:
+	speed = ais->type18.speed;
+	accuracy = ais->type18.accuracy;
+	lon = ais->type18.lon;
+	lat = ais->type18.lat;
+	course = ais->type18.course;
+	heading = ais->type18.heading;
+	second = ais->type18.second;
+	raim = ais->type18.raim;
+	break;
+    case 19:
+	speed = ais->type19.speed;
+	accuracy = ais->type19.accuracy;
+	lon = ais->type19.lon;
+	lat = ais->type19.lat;
+	course = ais->type19.course;
+	heading = ais->type19.heading;
+	second = ais->type19.second;
+	raim = ais->type19.raim;
+	break;
+    case 27:
+	status = ais->type27.status;
+	speed = ais->type27.speed;
+	accuracy = ais->type27.accuracy;
+	lon = ais->type27.lon;
+	lat = ais->type27.lat;
+	course = ais->type27.course;
+	raim = ais->type27.raim;
+	div = AIS_LONGRANGE_LATLON_DIV;
+	longrange = true;
+	break;
+    default:
+	status = ais->type1.status;
+	turn = ais->type1.turn;
+	speed = ais->type1.speed;
+	accuracy = ais->type1.accuracy;
+	lon = ais->type1.lon;
+	lat = ais->type1.lat;
+	course = ais->type1.course;
+	heading = ais->type1.heading;
+	second = ais->type1.second;
+	raim = ais->type1.raim;
+	break;
+    }
+
+    arrow_header(w, ais);
+    arrow_add_int(w, status, ais->type <= 3 || longrange);
+    /* the decoder sign-extends the 8-bit field, so "not available" is -128 */
+    arrow_add_int(w, turn, ais->type <= 3 && abs(turn) != AIS_TURN_NOT_AVAILABLE);
+    if (longrange) {
+	arrow_add_real(w, speed, speed != AIS_LONGRANGE_SPEED_NOT_AVAILABLE);
+    } else
+	arrow_add_real(w, speed / 10.0, speed != AIS_SPEED_NOT_AVAILABLE);
+    arrow_add_bool(w, accuracy);
+    arrow_add_real(w, lon / div, abs(lon) <= 180 * div);
+    arrow_add_real(w, lat / div, abs(lat) <= 90 * div);
+    if (longrange)
+	arrow_add_real(w, course, course < AIS_LONGRANGE_COURSE_NOT_AVAILABLE
+		       && course < 360);
+    else
+	arrow_add_real(w, course / 10.0, course < AIS_COURSE_NOT_AVAILABLE);
+    arrow_add_int(w, heading, heading < 360);
+    arrow_add_int(w, second, second < AIS_SEC_NOT_AVAILABLE);
+    arrow_add_bool(w, raim);
+}
+
+static void static_row(struct ais_arrow_t *w, const struct ais_t *ais)
+{
+    bool t5 = (ais->type == 5);
+    bool a = !t5 && ais->type24.part != part_b;		/* has part A */
+    bool b = !t5 && ais->type24.part != part_a;		/* has part B */
+    bool aux = b && AIS_AUXILIARY_MMSI(ais->mmsi);
+
+    arrow_header(w, ais);
+    arrow_add_int(w, ais->type5.imo, t5);
+    arrow_add_int(w, ais->type5.ais_version, t5);
+    if (t5) {
+	ARROW_TEXT(w, ais->type5.callsign, true);
+	ARROW_TEXT(w, ais->type5.shipname, true);
+	arrow_add_int(w, ais->type5.shiptype, true);
+    } else {
+	ARROW_TEXT(w, ais->type24.callsign, b);
+	ARROW_TEXT(w, ais->type24.shipname, a);
+	arrow_add_int(w, ais->type24.shiptype, b);
+    }
+    ARROW_TEXT(w, ais->type24.vendorid, b);
+    arrow_add_int(w, ais->type24.model, b);
+    arrow_add_int(w, ais->type24.serial, b);
+    arrow_add_int(w, ais->type24.mothership_mmsi, aux);
+    if (t5) {
+	arrow_add_int(w, ais->type5.to_bow, true);
+	arrow_add_int(w, ais->type5.to_stern, true);
+	arrow_add_int(w, ais->type5.to_port, true);
+	arrow_add_int(w, ais->type5.to_starboard, true);
+    } else {
+	arrow_add_int(w, ais->type24.dim.to_bow, b && !aux);
+	arrow_add_int(w, ais->type24.dim.to_stern, b && !aux);
+	arrow_add_int(w, ais->type24.dim.to_port, b && !aux);
+	arrow_add_int(w, ais->type24.dim.to_starboard, b && !aux);
+    }
+    arrow_add_int(w, ais->type5.epfd, t5);
+    arrow_add_int(w, ais->type5.month,
+		  t5 && ais->type5.month != AIS_MONTH_NOT_AVAILABLE);
+    arrow_add_int(w, ais->type5.day, t5 && ais->type5.day != AIS_DAY_NOT_AVAILABLE);
+    arrow_add_int(w, ais->type5.hour,
+		  t5 && ais->type5.hour != AIS_HOUR_NOT_AVAILABLE);
+    arrow_add_int(w, ais->type5.minute,
+		  t5 && ais->type5.minute != AIS_MINUTE_NOT_AVAILABLE);
+    arrow_add_real(w, ais->type5.draught / 10.0, t5);
+    ARROW_TEXT(w, ais->type5.destination, t5);
+    arrow_add_int(w, ais->type5.dte, t5);
+}
+
+static long long days_from_civil(int y, unsigned int m, unsigned int d)
+/* days since 1970-01-01 of a proleptic Gregorian date */
+{
+    int era;
+    unsigned int yoe, doy, doe;
+
+    y -= m <= 2;
+    era = (y >= 0 ? y : y - 399) / 400;
+    yoe = (unsigned int)(y - era * 400);
+    doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (long long)era * 146097 + doe - 719468;
+}
+
+static void base_row(struct ais_arrow_t *w, const struct ais_t *ais)
+{
+    static const unsigned char mdays[] = {
+	31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31,
+    };
+    unsigned int year = ais->type4.year, month = ais->type4.month;
+    unsigned int day = ais->type4.day, hour = ais->type4.hour;
+    unsigned int minute = ais->type4.minute, second = ais->type4.second;
+    int lon = ais->type4.lon, lat = ais->type4.lat;
+    bool leap = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+    bool valid_year = year != AIS_YEAR_NOT_AVAILABLE && year <= 9999;
+    bool date = valid_year && month >= 1 && month <= 12
+	&& day >= 1 && day <= mdays[month - 1]
+	&& (month != 2 || day < 29 || leap);
+
+    long long t = (days_from_civil((int)year, month, day) * 24 + hour) * 3600
+	+ minute * 60 + second;
+
+    arrow_header(w, ais);
+    arrow_add_int(w, t, date && hour < 24 && minute < 60 && second < 60);
+    arrow_add_int(w, year, valid_year);
+    arrow_add_int(w, month, month != AIS_MONTH_NOT_AVAILABLE && month <= 12);
+    arrow_add_int(w, day, day != AIS_DAY_NOT_AVAILABLE && day <= 31);
+    arrow_add_int(w, hour, hour < AIS_HOUR_NOT_AVAILABLE);
+    arrow_add_int(w, minute, minute < AIS_MINUTE_NOT_AVAILABLE);
+    arrow_add_int(w, second, second < AIS_SECOND_NOT_AVAILABLE);
+    arrow_add_bool(w, ais->type4.accuracy);
+    arrow_add_real(w, lon / AIS_LATLON_DIV, abs(lon) <= 180 * AIS_LATLON_DIV);
+    arrow_add_real(w, lat / AIS_LATLON_DIV, abs(lat) <= 90 * AIS_LATLON_DIV);
+    arrow_add_int(w, ais->type4.epfd, true);
+    arrow_add_bool(w, ais->type4.raim);
+}
+
+static void binary_row(struct ais_arrow_t *w, const struct ais_t *ais)
+{
+    unsigned int dest = 0, app = 0;
+    bool addressed = false, structured = false, raw = true;
+    size_t bitcount, size;
+    const char *bits;
+
+    switch (ais->type) {
+    case 6:
+	addressed = true;
+	dest = ais->type6.dest_mmsi;
+	app = ais->type6.dac << 6 | ais->type6.fid;
+	structured = true;
+	/* decoded application data has overwritten the raw bits */
+	raw = !ais->type6.structured;
+	bitcount = ais->type6.bitcount;
+	bits = ais->type6.bitdata;
+	size = sizeof(ais->type6.bitdata);
+	break;
+    case 8:
+	app = ais->type8.dac << 6 | ais->type8.fid;
+	structured = true;
+	raw = !ais->type8.structured;
+	bitcount = ais->type8.bitcount;
+	bits = ais->type8.bitdata;
+	size = sizeof(ais->type8.bitdata);
+	break;
+    case 25:
+	addressed = ais->type25.addressed;
+	dest = ais->type25.dest_mmsi;
+	app = ais->type25.app_id;
+	structured = ais->type25.structured;
+	bitcount = ais->type25.bitcount;
+	bits = ais->type25.bitdata;
+	size = sizeof(ais->type25.bitdata);
+	break;
+    default:
+	addressed = ais->type26.addressed;
+	dest = ais->type26.dest_mmsi;
+	app = ais->type26.app_id;
+	structured = ais->type26.structured;
+	bitcount = ais->type26.bitcount;
+	bits = ais->type26.bitdata;
+	size = sizeof(ais->type26.bitdata);
+	break;
+    }
+    if (bitcount > size * CHAR_BIT)
+	bitcount = size * CHAR_BIT;
+
+    arrow_header(w, ais);
+    arrow_add_int(w, dest, addressed);
+    arrow_add_int(w, app >> 6, structured);
+    arrow_add_int(w, app & 0x3f, structured);
+    arrow_add_int(w, (long long)bitcount, true);
+    arrow_add_bytes(w, raw ? bits : NULL, BITS_TO_BYTES(bitcount));
+}
+
+static void (*const rows[AIS_ARROW_FAMILIES])(struct ais_arrow_t *,
+					      const struct ais_t *) = {
+    [ais_arrow_positions] = position_row,
+    [ais_arrow_static] = static_row,
+    [ais_arrow_base] = base_row,
+    [ais_arrow_binary] = binary_row,
+};
+
+/*
+ * FlatBuffers.  A table is written as its vtable followed by the table
+ * itself; offset fields are filled in by fb_patch() once the object
+ * they refer to has been written after them.
+ */
+
+struct fb_slot_t {
+    unsigned int size;		/* bytes, or 0 if the field is absent */
+    uint64_t value;		/* offsets are patched in later */
+};
+
+static size_t fb_table(struct arrow_buf_t *b, const struct fb_slot_t *slot,
+		       int n, /*@out@*/size_t *at)
+{
+    unsigned int off[16], end = 4;
+    size_t vtable, table;
+    int i;
+
+    assert(n <= NITEMS(off));
+    for (i = 0; i < n; i++) {
+	if (slot[i].size == 0) {
+	    off[i] = 0;
+	    continue;
+	}
+	end = (end + slot[i].size - 1) / slot[i].size * slot[i].size;
+	off[i] = end;
+	end += slot[i].size;
+    }
+    (void)buf_pad(b, 2);
+    vtable = b->len;
+    (void)buf_le(b, 4 + 2 * (unsigned int)n, 2);
+    (void)buf_le(b, end, 2);
+    for (i = 0; i < n; i++)
+	(void)buf_le(b, off[i], 2);
+    /* 8-aligned, so that aligned offsets within it are aligned absolutely */
+    (void)buf_pad(b, 8);
+    table = b->len;
+    (void)buf_le(b, table - vtable, 4);
+    for (i = 0; i < n; i++) {
+	if (slot[i].size == 0)
+	    continue;
+	while (b->len < table + off[i])
+	    (void)buf_le(b, 0, 1);
+	at[i] = b->len;
+	(void)buf_le(b, slot[i].value, slot[i].size);
+    }
+    return table;
+}
+
+static void fb_patch(struct arrow_buf_t *b, size_t at, size_t target)
+{
+    uint32_t off = (uint32_t)(target - at);
+
+    if (at + 4 <= b->len) {
+	b->data[at] = (unsigned char)off;
+	b->data[at + 1] = (unsigned char)(off >> 8);
+	b->data[at + 2] = (unsigned char)(off >> 16);
+	b->data[at + 3] = (unsigned char)(off >> 24);
+    }
+}
+
+static size_t fb_vector(struct arrow_buf_t *b, size_t n, size_t align)
+/* the length word of a vector whose elements follow aligned */
+{
+    size_t at;
+
+    (void)buf_pad(b, 4);
+    while ((b->len + 4) % align != 0)
+	(void)buf_le(b, 0, 4);
+    at = b->len;
+    (void)buf_le(b, n, 4);
+    return at;
+}
+
+static size_t fb_string(struct arrow_buf_t *b, const char *str)
+{
+    size_t at = fb_vector(b, strlen(str), 4);
+
+    (void)buf_put(b, str, strlen(str) + 1);
+    return at;
+}
+
+/* Message.fbs: MetadataVersion V5 and the MessageHeader union */
+#define ARROW_METADATA_V5	4
+#define ARROW_HEADER_SCHEMA	1
+#define ARROW_HEADER_BATCH	3
+/* Schema.fbs: the Type union */
+#define ARROW_TYPE_INT		2
+#define ARROW_TYPE_FLOAT	3
+#define ARROW_TYPE_BINARY	4
+#define ARROW_TYPE_UTF8		5
+#define ARROW_TYPE_BOOL		6
+#define ARROW_TYPE_TIMESTAMP	10
+
+static size_t fb_message(struct arrow_buf_t *b, unsigned int header,
+			 size_t body)
+/* a Message table; returns where its header offset goes */
+{
+    struct fb_slot_t slot[] = {
+	{2, ARROW_METADATA_V5},	/* version */
+	{1, header},		/* header_type */
+	{4, 0},			/* header */
+	{8, body},		/* bodyLength */
+    };
+    size_t at[NITEMS(slot)];
+
+    b->len = 0;
+    (void)buf_le(b, 0, 4);	/* root offset */
+    fb_patch(b, 0, fb_table(b, slot, NITEMS(slot), at));
+    return at[2];
+}
+
+static void fb_field(struct arrow_buf_t *b, size_t at,
+		     const struct arrow_field_t *field)
+/* a Field table, referred to from at */
+{
+    static const struct {
+	unsigned int type;
+	int bits;
+	bool is_signed;
+    } types[] = {
+	[arrow_uint8] = {ARROW_TYPE_INT, 8, false},
+	[arrow_uint16] = {ARROW_TYPE_INT, 16, false},
+	[arrow_uint32] = {ARROW_TYPE_INT, 32, false},
+	[arrow_int8] = {ARROW_TYPE_INT, 8, true},
+	[arrow_float] = {ARROW_TYPE_FLOAT, 1, false},	/* SINGLE */
+	[arrow_double] = {ARROW_TYPE_FLOAT, 2, false},	/* DOUBLE */
+	[arrow_bool] = {ARROW_TYPE_BOOL, 0, false},
+	[arrow_utf8] = {ARROW_TYPE_UTF8, 0, false},
+	[arrow_binary] = {ARROW_TYPE_BINARY, 0, false},
+	[arrow_timestamp] = {ARROW_TYPE_TIMESTAMP, 0, false},	/* SECOND */
+    };
+    unsigned int type = types[field->kind].type;
+    struct fb_slot_t slot[] = {
+	{4, 0},			/* name */
+	{1, field->nullable},	/* nullable */
+	{1, type},		/* type_type */
+	{4, 0},			/* type */
+	{0, 0},			/* dictionary */
+	{4, 0},			/* children, required though empty */
+    };
+    struct fb_slot_t param[2] = {{0, 0}, {0, 0}};
+    size_t fat[NITEMS(slot)], tat[2];
+    int nparam = 0;
+
+    fb_patch(b, at, fb_table(b, slot, NITEMS(slot), fat));
+    fb_patch(b, fat[0], fb_string(b, field->name));
+    switch (type) {
+    case ARROW_TYPE_INT:	/* bitWidth, is_signed */
+	param[0].size = 4;
+	param[0].value = (uint64_t)types[field->kind].bits;
+	param[1].size = 1;
+	param[1].value = types[field->kind].is_signed;
+	nparam = 2;
+	break;
+    case ARROW_TYPE_FLOAT:	/* precision */
+	param[0].size = 2;
+	param[0].value = (uint64_t)types[field->kind].bits;
+	nparam = 1;
+	break;
+    case ARROW_TYPE_TIMESTAMP:	/* unit, timezone */
+	param[0].size = 2;
+	param[1].size = 4;
+	nparam = 2;
+	break;
+    }
+    fb_patch(b, fat[3], fb_table(b, param, nparam, tat));
+    if (type == ARROW_TYPE_TIMESTAMP)
+	fb_patch(b, tat[1], fb_string(b, "UTC"));
+    fb_patch(b, fat[5], fb_vector(b, 0, 4));
+}
+
+/*
+ * Stream output
+ */
+
+static void arrow_write(struct ais_arrow_t *w, const void *p, size_t n)
+{
+    if (n > 0 && fwrite(p, 1, n, w->fp) != n)
+	w->error = true;
+}
+
+static void arrow_message(struct ais_arrow_t *w, struct arrow_buf_t *meta)
+/* the encapsulation: continuation marker, metadata length, metadata */
+{
+    unsigned char prefix[8] = {0xff, 0xff, 0xff, 0xff};
+    size_t len;
+
+    if (!buf_pad(meta, 8))
+	w->error = true;
+    len = meta->len;
+    prefix[4] = (unsigned char)len;
+    prefix[5] = (unsigned char)(len >> 8);
+    prefix[6] = (unsigned char)(len >> 16);
+    prefix[7] = (unsigned char)(len >> 24);
+    arrow_write(w, prefix, sizeof(prefix));
+    arrow_write(w, meta->data, len);
+}
+
+static void arrow_column_reset(struct ais_arrow_t *w)
+{
+    size_t i;
+
+    for (i = 0; i < w->nfields; i++) {
+	struct arrow_column_t *c = &w->column[i];
+
+	c->validity.len = c->values.len = c->data.len = 0;
+	c->nulls = 0;
+	/* offset of the first string */
+	if ((w->field[i].kind == arrow_utf8 || w->field[i].kind == arrow_binary)
+	    && !buf_le(&c->values, 0, sizeof(int32_t)))
+	    w->error = true;
+    }
+    w->rows = 0;
+}
+
+/*@null@*/struct ais_arrow_t *ais_arrow_open(enum ais_arrow_family_t family,
+					    FILE *fp)
+/* start a stream of one family on fp, writing its schema */
+{
+    struct ais_arrow_t *w;
+    struct arrow_buf_t meta = {NULL, 0, 0};
+    struct fb_slot_t slot[] = {
+	{0, 0},			/* endianness, Little by default */
+	{4, 0},			/* fields */
+    };
+    size_t at[NITEMS(slot)], header, vec, i;
+
+    if ((unsigned int)family >= AIS_ARROW_FAMILIES
+	|| (w = calloc(1, sizeof(*w))) == NULL)
+	return NULL;
+    w->family = family;
+    w->fp = fp;
+    w->field = families[family].field;
+    w->nfields = families[family].nfields;
+    if ((w->column = calloc(w->nfields, sizeof(*w->column))) == NULL) {
+	free(w);
+	return NULL;
+    }
+    arrow_column_reset(w);
+
+    header = fb_message(&meta, ARROW_HEADER_SCHEMA, 0);
+    fb_patch(&meta, header, fb_table(&meta, slot, NITEMS(slot), at));
+    vec = fb_vector(&meta, w->nfields, 4);
+    fb_patch(&meta, at[1], vec);
+    for (i = 0; i < w->nfields; i++)
+	(void)buf_le(&meta, 0, 4);
+    for (i = 0; i < w->nfields; i++)
+	fb_field(&meta, vec + 4 + 4 * i, &w->field[i]);
+    if (meta.data == NULL)
+	w->error = true;
+    else
+	arrow_message(w, &meta);
+    free(meta.data);
+    return w;
+}
+
+bool ais_arrow_append(struct ais_arrow_t *w, const struct ais_t *ais)
+/* add a message to the pending batch; false if it is of another family */
+{
+    if (ais_arrow_family(ais->type) != (int)w->family)
+	return false;
+    w->col = 0;
+    rows[w->family](w, ais);
+    assert(w->col == w->nfields);
+    w->rows++;
+    return true;
+}
+
+/* the buffers of a column as they go into the body */
+static size_t arrow_buffers(const struct ais_arrow_t *w, size_t i,
+			    const struct arrow_buf_t *buf[3])
+{
+    const struct arrow_column_t *c = &w->column[i];
+    enum arrow_kind_t kind = w->field[i].kind;
+
+    /* with no nulls, the validity bitmap may be left out */
+    buf[0] = c->nulls != 0 ? &c->validity : NULL;
+    buf[1] = &c->values;
+    buf[2] = &c->data;
+    return (kind == arrow_utf8 || kind == arrow_binary) ? 3 : 2;
+}
+
+bool ais_arrow_flush(struct ais_arrow_t *w)
+/* write the pending rows as one record batch */
+{
+    static const unsigned char zero[8];
+    struct arrow_buf_t meta = {NULL, 0, 0};
+    const struct arrow_buf_t *buf[3];
+    struct fb_slot_t slot[] = {
+	{8, w->rows},		/* length */
+	{4, 0},			/* nodes */
+	{4, 0},			/* buffers */
+    };
+    size_t at[NITEMS(slot)], nbuffers = 0, body = 0, i, j, n, header;
+
+    if (w->rows == 0 || w->error)
+	return !w->error;
+    for (i = 0; i < w->nfields; i++) {
+	n = arrow_buffers(w, i, buf);
+	for (j = 0; j < n; j++)
+	    if (buf[j] != NULL)
+		body += (buf[j]->len + 7) / 8 * 8;
+	nbuffers += n;
+    }
+
+    header = fb_message(&meta, ARROW_HEADER_BATCH, body);
+    fb_patch(&meta, header, fb_table(&meta, slot, NITEMS(slot), at));
+    /* FieldNode structs: length, null_count */
+    fb_patch(&meta, at[1], fb_vector(&meta, w->nfields, 8));
+    for (i = 0; i < w->nfields; i++) {
+	(void)buf_le(&meta, w->rows, 8);
+	(void)buf_le(&meta, w->column[i].nulls, 8);
+    }
+    /* Buffer structs: offset, length, each padded to 8 in the body */
+    fb_patch(&meta, at[2], fb_vector(&meta, nbuffers, 8));
+    for (body = 0, i = 0; i < w->nfields; i++) {
+	n = arrow_buffers(w, i, buf);
+	for (j = 0; j < n; j++) {
+	    size_t len = buf[j] != NULL ? buf[j]->len : 0;
+
+	    (void)buf_le(&meta, body, 8);
+	    (void)buf_le(&meta, len, 8);
+	    body += (len + 7) / 8 * 8;
+	}
+    }
+    if (meta.data == NULL)
+	w->error = true;
+    else
+	arrow_message(w, &meta);
+    free(meta.data);
+    for (i = 0; i < w->nfields; i++) {
+	n = arrow_buffers(w, i, buf);
+	for (j = 0; j < n; j++)
+	    if (buf[j] != NULL) {
+		arrow_write(w, buf[j]->data, buf[j]->len);
+		arrow_write(w, zero, (8 - buf[j]->len % 8) % 8);
+	    }
+    }
+    arrow_column_reset(w);
+    return !w->error;
+}
+
+bool ais_arrow_close(struct ais_arrow_t *w)
+/* flush, end the stream and free the writer; false if anything failed */
+{
+    static const unsigned char eos[8] = {0xff, 0xff, 0xff, 0xff, 0, 0, 0, 0};
+    bool ok;
+    size_t i;
+
+    (void)ais_arrow_flush(w);
+    arrow_write(w, eos, sizeof(eos));
+    ok = !w->error;
+    for (i = 0; i < w->nfields; i++) {
+	free(w->column[i].validity.data);
+	free(w->column[i].values.data);
+	free(w->column[i].data.data);
+    }
+    free(w->column);
+    free(w);
+    return ok;
+}
+
+size_t ais_arrow_write_batch(struct ais_arrow_t *writer[AIS_ARROW_FAMILIES],
+			     const struct aivdm_batch_t *batch)
+/*
+ * Route the messages of a batch decode to the writers of their
+ * families, NULL ones skipped, and write one record batch per family.
+ * Returns the number of messages written.
+ */
+{
+    size_t i, n = 0;
+    int family;
+
+    for (i = 0; i < batch->nais; i++) {
+	family = ais_arrow_family(batch->ais[i].type);
+	if (family >= 0 && writer[family] != NULL
+	    && ais_arrow_append(writer[family], &batch->ais[i]))
+	    n++;
+    }
+    for (family = 0; family < AIS_ARROW_FAMILIES; family++)
+	if (writer[family] != NULL)
+	    (void)ais_arrow_flush(writer[family]);
+    return n;
+}
+
+/* ais_arrow.c ends here */
@@ -0,0 +1,51 @@
+/* ais_arrow.h - Apache Arrow IPC stream output of decoded AIS messages
+ *
+ * Messages are grouped into families that share a schema, and each
+ * family is written as its own Arrow IPC stream (the "streaming
+ * format": a schema message, record batches, an end-of-stream
+ * marker).  pyarrow.ipc.open_stream() and the other Arrow readers
+ * load these directly, and every column type maps onto Parquet, so
+ * there is no need for an Arrow library on the writing side.
+ *
+ * Values are scaled to degrees, knots and metres.  A sentinel such as
+ * AIS_SPEED_NOT_AVAILABLE or AIS_HOUR_NOT_AVAILABLE, or an out-of-range
+ * value, becomes a null; so does a field the message does not carry,
+ * as when type 24 part A and part B share the static family.
+ *
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#ifndef _AIS_ARROW_H_
+#define _AIS_ARROW_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "gps.h"
+
+enum ais_arrow_family_t {
+    ais_arrow_positions,	/* types 1-3, 18, 19 and 27 */
+    ais_arrow_static,		/* types 5 and 24 */
+    ais_arrow_base,		/* types 4 and 11 */
+    ais_arrow_binary,		/* types 6, 8, 25 and 26 */
+};
+#define AIS_ARROW_FAMILIES	4
+
+struct ais_arrow_t;		/* one open stream */
+struct aivdm_batch_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+int ais_arrow_family(unsigned int);
+/*@null@*/struct ais_arrow_t *ais_arrow_open(enum ais_arrow_family_t, FILE *);
+bool ais_arrow_append(struct ais_arrow_t *, const struct ais_t *);
+bool ais_arrow_flush(struct ais_arrow_t *);
+bool ais_arrow_close(/*@only@*/struct ais_arrow_t *);
+size_t ais_arrow_write_batch(struct ais_arrow_t *[AIS_ARROW_FAMILIES],
+			     const struct aivdm_batch_t *);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AIS_ARROW_H_ */
+/* ais_arrow.h ends here */
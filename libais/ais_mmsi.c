@@ -0,0 +1,221 @@
+/*
+ * Sets of MMSIs for filtering at line rate.
+ *
+ * A set is a hash table or a bitmap, never both.  The table is made of
+ * 64-byte buckets of sixteen 32-bit slots, each bucket one cache line,
+ * and is kept at most half full.  A lookup compares a whole bucket at
+ * once, which compiles to a few vector compares, and only moves on to
+ * the next bucket if this one is full; with short probe sequences of
+ * unpredictable length, a branch per slot would be mispredicted about
+ * as often as not.  An MMSI never exceeds 30 bits, which leaves
+ * all-ones free to mark an empty slot.
+ *
+ * Past 16 MB the table no longer stays in cache, and then the bitmap
+ * is used instead.  Both miss the cache on a lookup, but the bitmap's
+ * single load with no branch on its result lets more misses overlap,
+ * and it measured twice as fast for at most eight times the memory.
+ *
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include "ais_mmsi.h"
+
+#define MMSI_EMPTY		UINT32_MAX
+#define MMSI_BUCKET		16	/* slots per bucket */
+#define MMSI_BITMAP_WORDS	((AIS_MMSI_MAX + 1) / 64)
+/* slots in the largest table, an eighth of the bitmap's size */
+#define MMSI_MAX_SLOTS		(MMSI_BITMAP_WORDS * sizeof(uint64_t) / 32)
+
+struct ais_mmsi_set_t {
+    size_t count;		/* distinct MMSIs */
+    /*@null@*/uint32_t *slot;	/* hash table of MMSIs, or NULL */
+    uint32_t mask;		/* number of buckets less one */
+    unsigned int shift;		/* 32 less the log2 of the number of buckets */
+    /*@null@*/uint64_t *bitmap;	/* bit n set for MMSI n, or NULL */
+};
+
+static inline uint32_t mmsi_hash(const struct ais_mmsi_set_t *set,
+				 unsigned int mmsi)
+/* Fibonacci hashing: MMSIs cluster by country, so mix before masking */
+{
+    return (uint32_t)(mmsi * 2654435769U) >> set->shift;
+}
+
+struct ais_mmsi_set_t *ais_mmsi_set_new(const unsigned int *mmsi, size_t n)
+/* build a set from an array of MMSIs, duplicates allowed */
+{
+    struct ais_mmsi_set_t *set;
+    size_t slots, i;
+
+    for (i = 0; i < n; i++)
+	if (mmsi[i] > AIS_MMSI_MAX) {
+	    errno = ERANGE;
+	    return NULL;
+	}
+    if ((set = calloc(1, sizeof(*set))) == NULL) {
+	errno = ENOMEM;
+	return NULL;
+    }
+
+    for (slots = 2 * MMSI_BUCKET, set->shift = 31; slots < 2 * n
+	     && slots <= MMSI_MAX_SLOTS; slots *= 2)
+	set->shift--;
+
+    if (slots > MMSI_MAX_SLOTS) {
+	/* calloc() of this size maps zero pages, touched only when set */
+	set->bitmap = calloc(MMSI_BITMAP_WORDS, sizeof(uint64_t));
+	if (set->bitmap == NULL) {
+	    free(set);
+	    errno = ENOMEM;
+	    return NULL;
+	}
+	for (i = 0; i < n; i++) {
+	    uint64_t bit = (uint64_t)1 << (mmsi[i] & 63);
+	    uint64_t *word = &set->bitmap[mmsi[i] >> 6];
+
+	    set->count += (*word & bit) == 0;
+	    *word |= bit;
+	}
+	return set;
+    }
+
+    if (posix_memalign((void **)&set->slot, MMSI_BUCKET * sizeof(uint32_t),
+		       slots * sizeof(uint32_t)) != 0) {
+	free(set);
+	errno = ENOMEM;
+	return NULL;
+    }
+    memset(set->slot, 0xff, slots * sizeof(uint32_t));
+    set->mask = (uint32_t)(slots / MMSI_BUCKET - 1);
+    for (i = 0; i < n; i++) {
+	uint32_t *s = &set->slot[mmsi_hash(set, mmsi[i]) * MMSI_BUCKET];
+	size_t j = 0;
+
+	/* the table is never full, so this finds the MMSI or a free slot */
+	while (s[j] != MMSI_EMPTY && s[j] != mmsi[i])
+	    if (++j == MMSI_BUCKET) {
+		s += MMSI_BUCKET;
+		if (s == set->slot + slots)
+		    s = set->slot;
+		j = 0;
+	    }
+	if (s[j] == MMSI_EMPTY) {
+	    s[j] = mmsi[i];
+	    set->count++;
+	}
+    }
+    return set;
+}
+
+struct ais_mmsi_set_t *ais_mmsi_set_read(FILE *fp, size_t *badline)
+/* build a set from its text form */
+{
+    unsigned int *mmsi = NULL;
+    size_t n = 0, size = 0, lineno = 0, linesize = 0;
+    char *line = NULL;
+    struct ais_mmsi_set_t *set;
+    int err = 0;
+
+    if (badline != NULL)
+	*badline = 0;
+    while (getline(&line, &linesize, fp) != -1) {
+	const char *cp = line;
+	unsigned long v = 0;
+	bool digits = false;
+
+	lineno++;
+	while (*cp == ' ' || *cp == '\t')
+	    cp++;
+	for (; *cp >= '0' && *cp <= '9'; cp++) {
+	    digits = true;
+	    if ((v = v * 10 + (unsigned long)(*cp - '0')) > AIS_MMSI_MAX)
+		err = ERANGE;
+	}
+	while (*cp == ' ' || *cp == '\t' || *cp == '\r' || *cp == '\n')
+	    cp++;
+	if (err == 0 && *cp != '\0' && *cp != '#')
+	    err = EINVAL;
+	if (err != 0) {
+	    if (badline != NULL)
+		*badline = lineno;
+	    break;
+	}
+	if (!digits)
+	    continue;		/* blank or comment */
+	if (n == size) {
+	    unsigned int *grown;
+
+	    size = size ? 2 * size : 1024;
+	    if ((grown = realloc(mmsi, size * sizeof(*mmsi))) == NULL) {
+		err = ENOMEM;
+		break;
+	    }
+	    mmsi = grown;
+	}
+	mmsi[n++] = (unsigned int)v;
+    }
+    if (err == 0 && ferror(fp))
+	err = EIO;
+    free(line);
+
+    set = (err == 0) ? ais_mmsi_set_new(mmsi, n) : NULL;
+    if (set == NULL && err != 0)
+	errno = err;
+    free(mmsi);
+    return set;
+}
+
+bool ais_mmsi_set_contains(const struct ais_mmsi_set_t *set,
+			   unsigned int mmsi)
+{
+    uint32_t h;
+
+    /* in no set, and all-ones would match every empty slot of the table */
+    if (mmsi > AIS_MMSI_MAX)
+	return false;
+    if (set->bitmap != NULL)
+	return (set->bitmap[mmsi >> 6] >> (mmsi & 63) & 1) != 0;
+
+    for (h = mmsi_hash(set, mmsi);; h = (h + 1) & set->mask) {
+	const uint32_t *s = &set->slot[h * MMSI_BUCKET];
+	unsigned int found = 0, empty = 0;
+	int j;
+
+	for (j = 0; j < MMSI_BUCKET; j++) {
+	    found |= s[j] == mmsi;
+	    empty |= s[j] == MMSI_EMPTY;
+	}
+	/* one test on the common path: the MMSI found or ruled out */
+	if ((found | empty) != 0)
+	    return found != 0;
+    }
+}
+
+size_t ais_mmsi_set_size(const struct ais_mmsi_set_t *set)
+{
+    return set->count;
+}
+
+size_t ais_mmsi_set_bytes(const struct ais_mmsi_set_t *set)
+{
+    if (set->bitmap != NULL)
+	return sizeof(*set) + MMSI_BITMAP_WORDS * sizeof(uint64_t);
+    return sizeof(*set)
+	+ ((size_t)set->mask + 1) * MMSI_BUCKET * sizeof(uint32_t);
+}
+
+void ais_mmsi_set_free(struct ais_mmsi_set_t *set)
+{
+    if (set == NULL)
+	return;
+    free(set->slot);
+    free(set->bitmap);
+    free(set);
+}
+
+/* ais_mmsi.c ends here */
@@ -0,0 +1,44 @@
+/* ais_mmsi.h - sets of MMSIs for filtering at line rate
+ *
+ * A watchlist such as a fleet registry or a sanctions list, built once
+ * and then only queried.  Up to about two million entries it is an
+ * open-addressing hash table at most half full; beyond that it is a
+ * bitmap over the whole 30-bit MMSI space, a fixed 128 MB, where a
+ * lookup is a single memory access.  The choice is made from the size
+ * of the input.
+ *
+ * The text form read by ais_mmsi_set_read() is one decimal MMSI per
+ * line.  Blank lines are skipped and '#' starts a comment that runs to
+ * the end of the line.
+ *
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#ifndef _AIS_MMSI_H_
+#define _AIS_MMSI_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define AIS_MMSI_MAX	((1U << 30) - 1)	/* MMSIs are 30 bits wide */
+
+struct ais_mmsi_set_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* NULL with errno set: ERANGE for an MMSI above AIS_MMSI_MAX, or ENOMEM */
+/*@null@*/struct ais_mmsi_set_t *ais_mmsi_set_new(const unsigned int *, size_t);
+/* as above, or EINVAL with the offending line number in *badline */
+/*@null@*/struct ais_mmsi_set_t *ais_mmsi_set_read(FILE *,
+						   /*@null@*/size_t *badline);
+bool ais_mmsi_set_contains(const struct ais_mmsi_set_t *, unsigned int);
+size_t ais_mmsi_set_size(const struct ais_mmsi_set_t *);	/* distinct MMSIs */
+size_t ais_mmsi_set_bytes(const struct ais_mmsi_set_t *);	/* memory held */
+void ais_mmsi_set_free(/*@only@*//*@null@*/struct ais_mmsi_set_t *);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AIS_MMSI_H_ */
+/* ais_mmsi.h ends here */
@@ -0,0 +1,522 @@
+/*
+ * Fixed-layout binary records for decoded AIS messages.
+ *
+ * The record layouts are tables of fields over struct ais_t, so the
+ * encoder and the schema handed to readers cannot drift apart.  See
+ * ais_record.h for the format itself.
+ *
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <limits.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "ais_record.h"
+
+#define FIELD(name, format, size, member) \
+	{name, format, (unsigned short)(size), \
+	 (unsigned short)offsetof(struct ais_t, member), 0}
+#define MEMBER_SIZE(member)	sizeof(((struct ais_t *)0)->member)
+
+#define UINT8(t, m)	FIELD(#m, 'B', 1, t.m)
+#define UINT16(t, m)	FIELD(#m, 'H', 2, t.m)
+#define UINT32(t, m)	FIELD(#m, 'I', 4, t.m)
+#define INT8(t, m)	FIELD(#m, 'b', 1, t.m)
+#define INT32(t, m)	FIELD(#m, 'i', 4, t.m)
+#define FLAG(t, m)	FIELD(#m, '?', 1, t.m)
+#define TEXT(t, m)	FIELD(#m, 's', MEMBER_SIZE(t.m) - 1, t.m)
+#define PAYLOAD(t) \
+	{"data", 'p', (unsigned short)MEMBER_SIZE(t.bitdata), \
+	 (unsigned short)offsetof(struct ais_t, t.bitcount), \
+	 (unsigned short)offsetof(struct ais_t, t.bitdata)}
+
+/* Types 1-3 */
+static const struct ais_record_field_t type1_fields[] = {
+    UINT8(type1, status),
+    INT8(type1, turn),
+    UINT16(type1, speed),
+    FLAG(type1, accuracy),
+    INT32(type1, lon),
+    INT32(type1, lat),
+    UINT16(type1, course),
+    UINT16(type1, heading),
+    UINT8(type1, second),
+    UINT8(type1, maneuver),
+    FLAG(type1, raim),
+    UINT32(type1, radio),
+};
+
+/* Types 4 and 11 */
+static const struct ais_record_field_t type4_fields[] = {
+    UINT16(type4, year),
+    UINT8(type4, month),
+    UINT8(type4, day),
+    UINT8(type4, hour),
+    UINT8(type4, minute),
+    UINT8(type4, second),
+    FLAG(type4, accuracy),
+    INT32(type4, lon),
+    INT32(type4, lat),
+    UINT8(type4, epfd),
+    FLAG(type4, raim),
+    UINT32(type4, radio),
+};
+
+static const struct ais_record_field_t type5_fields[] = {
+    UINT8(type5, ais_version),
+    UINT32(type5, imo),
+    TEXT(type5, callsign),
+    TEXT(type5, shipname),
+    UINT8(type5, shiptype),
+    UINT16(type5, to_bow),
+    UINT16(type5, to_stern),
+    UINT8(type5, to_port),
+    UINT8(type5, to_starboard),
+    UINT8(type5, epfd),
+    UINT8(type5, month),
+    UINT8(type5, day),
+    UINT8(type5, hour),
+    UINT8(type5, minute),
+    UINT8(type5, draught),
+    TEXT(type5, destination),
+    UINT8(type5, dte),
+};
+
+static const struct ais_record_field_t type6_fields[] = {
+    UINT8(type6, seqno),
+    UINT32(type6, dest_mmsi),
+    FLAG(type6, retransmit),
+    UINT16(type6, dac),
+    UINT8(type6, fid),
+    FLAG(type6, structured),
+    PAYLOAD(type6),
+};
+
+/* Types 7 and 13 */
+static const struct ais_record_field_t type7_fields[] = {
+    UINT32(type7, mmsi1),
+    UINT32(type7, mmsi2),
+    UINT32(type7, mmsi3),
+    UINT32(type7, mmsi4),
+};
+
+static const struct ais_record_field_t type8_fields[] = {
+    UINT16(type8, dac),
+    UINT8(type8, fid),
+    FLAG(type8, structured),
+    PAYLOAD(type8),
+};
+
+static const struct ais_record_field_t type9_fields[] = {
+    UINT16(type9, alt),
+    UINT16(type9, speed),
+    FLAG(type9, accuracy),
+    INT32(type9, lon),
+    INT32(type9, lat),
+    UINT16(type9, course),
+    UINT8(type9, second),
+    UINT8(type9, regional),
+    UINT8(type9, dte),
+    FLAG(type9, assigned),
+    FLAG(type9, raim),
+    UINT32(type9, radio),
+};
+
+static const struct ais_record_field_t type10_fields[] = {
+    UINT32(type10, dest_mmsi),
+};
+
+static const struct ais_record_field_t type12_fields[] = {
+    UINT8(type12, seqno),
+    UINT32(type12, dest_mmsi),
+    FLAG(type12, retransmit),
+    TEXT(type12, text),
+};
+
+static const struct ais_record_field_t type14_fields[] = {
+    TEXT(type14, text),
+};
+
+static const struct ais_record_field_t type15_fields[] = {
+    UINT32(type15, mmsi1),
+    UINT8(type15, type1_1),
+    UINT16(type15, offset1_1),
+    UINT8(type15, type1_2),
+    UINT16(type15, offset1_2),
+    UINT32(type15, mmsi2),
+    UINT8(type15, type2_1),
+    UINT16(type15, offset2_1),
+};
+
+static const struct ais_record_field_t type16_fields[] = {
+    UINT32(type16, mmsi1),
+    UINT16(type16, offset1),
+    UINT16(type16, increment1),
+    UINT32(type16, mmsi2),
+    UINT16(type16, offset2),
+    UINT16(type16, increment2),
+};
+
+static const struct ais_record_field_t type17_fields[] = {
+    INT32(type17, lon),
+    INT32(type17, lat),
+    PAYLOAD(type17),
+};
+
+static const struct ais_record_field_t type18_fields[] = {
+    UINT8(type18, reserved),
+    UINT16(type18, speed),
+    FLAG(type18, accuracy),
+    INT32(type18, lon),
+    INT32(type18, lat),
+    UINT16(type18, course),
+    UINT16(type18, heading),
+    UINT8(type18, second),
+    UINT8(type18, regional),
+    FLAG(type18, cs),
+    FLAG(type18, display),
+    FLAG(type18, dsc),
+    FLAG(type18, band),
+    FLAG(type18, msg22),
+    FLAG(type18, assigned),
+    FLAG(type18, raim),
+    UINT32(type18, radio),
+};
+
+static const struct ais_record_field_t type19_fields[] = {
+    UINT8(type19, reserved),
+    UINT16(type19, speed),
+    FLAG(type19, accuracy),
+    INT32(type19, lon),
+    INT32(type19, lat),
+    UINT16(type19, course),
+    UINT16(type19, heading),
+    UINT8(type19, second),
+    UINT8(type19, regional),
+    TEXT(type19, shipname),
+    UINT8(type19, shiptype),
+    UINT16(type19, to_bow),
+    UINT16(type19, to_stern),
+    UINT8(type19, to_port),
+    UINT8(type19, to_starboard),
+    UINT8(type19, epfd),
+    FLAG(type19, raim),
+    UINT8(type19, dte),
+    FLAG(type19, assigned),
+};
+
+static const struct ais_record_field_t type20_fields[] = {
+    UINT16(type20, offset1),
+    UINT8(type20, number1),
+    UINT8(type20, timeout1),
+    UINT16(type20, increment1),
+    UINT16(type20, offset2),
+    UINT8(type20, number2),
+    UINT8(type20, timeout2),
+    UINT16(type20, increment2),
+    UINT16(type20, offset3),
+    UINT8(type20, number3),
+    UINT8(type20, timeout3),
+    UINT16(type20, increment3),
+    UINT16(type20, offset4),
+    UINT8(type20, number4),
+    UINT8(type20, timeout4),
+    UINT16(type20, increment4),
+};
+
+static const struct ais_record_field_t type21_fields[] = {
+    UINT8(type21, aid_type),
+    TEXT(type21, name),
+    FLAG(type21, accuracy),
+    INT32(type21, lon),
+    INT32(type21, lat),
+    UINT16(type21, to_bow),
+    UINT16(type21, to_stern),
+    UINT8(type21, to_port),
+    UINT8(type21, to_starboard),
+    UINT8(type21, epfd),
+    UINT8(type21, second),
+    FLAG(type21, off_position),
+    UINT8(type21, regional),
+    FLAG(type21, raim),
+    FLAG(type21, virtual_aid),
+    FLAG(type21, assigned),
+};
+
+static const struct ais_record_field_t type22_fields[] = {
+    UINT16(type22, channel_a),
+    UINT16(type22, channel_b),
+    UINT8(type22, txrx),
+    FLAG(type22, power),
+    FIELD("ne_lon", 'i', 4, type22.area.ne_lon),
+    FIELD("ne_lat", 'i', 4, type22.area.ne_lat),
+    FIELD("sw_lon", 'i', 4, type22.area.sw_lon),
+    FIELD("sw_lat", 'i', 4, type22.area.sw_lat),
+    FIELD("dest1", 'I', 4, type22.mmsi.dest1),
+    FIELD("dest2", 'I', 4, type22.mmsi.dest2),
+    FLAG(type22, addressed),
+    FLAG(type22, band_a),
+    FLAG(type22, band_b),
+    UINT8(type22, zonesize),
+};
+
+static const struct ais_record_field_t type23_fields[] = {
+    INT32(type23, ne_lon),
+    INT32(type23, ne_lat),
+    INT32(type23, sw_lon),
+    INT32(type23, sw_lat),
+    UINT8(type23, stationtype),
+    UINT8(type23, shiptype),
+    UINT8(type23, txrx),
+    UINT8(type23, interval),
+    UINT8(type23, quiet),
+};
+
+static const struct ais_record_field_t type24_fields[] = {
+    UINT8(type24, part),
+    TEXT(type24, shipname),
+    UINT8(type24, shiptype),
+    TEXT(type24, vendorid),
+    UINT8(type24, model),
+    UINT32(type24, serial),
+    TEXT(type24, callsign),
+    UINT32(type24, mothership_mmsi),
+    FIELD("to_bow", 'H', 2, type24.dim.to_bow),
+    FIELD("to_stern", 'H', 2, type24.dim.to_stern),
+    FIELD("to_port", 'B', 1, type24.dim.to_port),
+    FIELD("to_starboard", 'B', 1, type24.dim.to_starboard),
+};
+
+static const struct ais_record_field_t type25_fields[] = {
+    FLAG(type25, addressed),
+    FLAG(type25, structured),
+    UINT32(type25, dest_mmsi),
+    UINT16(type25, app_id),
+    PAYLOAD(type25),
+};
+
+static const struct ais_record_field_t type26_fields[] = {
+    FLAG(type26, addressed),
+    FLAG(type26, structured),
+    UINT32(type26, dest_mmsi),
+    UINT16(type26, app_id),
+    UINT32(type26, radio),
+    PAYLOAD(type26),
+};
+
+static const struct ais_record_field_t type27_fields[] = {
+    FLAG(type27, accuracy),
+    FLAG(type27, raim),
+    UINT8(type27, status),
+    INT32(type27, lon),
+    INT32(type27, lat),
+    UINT8(type27, speed),
+    UINT16(type27, course),
+    FLAG(type27, gnss),
+};
+
+#define LAYOUT(table)	{table, sizeof(table) / sizeof(table[0])}
+
+static const struct {
+    const struct ais_record_field_t *fields;
+    size_t nfields;
+} layouts[] = {
+    [1] = LAYOUT(type1_fields),
+    [2] = LAYOUT(type1_fields),
+    [3] = LAYOUT(type1_fields),
+    [4] = LAYOUT(type4_fields),
+    [5] = LAYOUT(type5_fields),
+    [6] = LAYOUT(type6_fields),
+    [7] = LAYOUT(type7_fields),
+    [8] = LAYOUT(type8_fields),
+    [9] = LAYOUT(type9_fields),
+    [10] = LAYOUT(type10_fields),
+    [11] = LAYOUT(type4_fields),
+    [12] = LAYOUT(type12_fields),
+    [13] = LAYOUT(type7_fields),
+    [14] = LAYOUT(type14_fields),
+    [15] = LAYOUT(type15_fields),
+    [16] = LAYOUT(type16_fields),
+    [17] = LAYOUT(type17_fields),
+    [18] = LAYOUT(type18_fields),
+    [19] = LAYOUT(type19_fields),
+    [20] = LAYOUT(type20_fields),
+    [21] = LAYOUT(type21_fields),
+    [22] = LAYOUT(type22_fields),
+    [23] = LAYOUT(type23_fields),
+    [24] = LAYOUT(type24_fields),
+    [25] = LAYOUT(type25_fields),
+    [26] = LAYOUT(type26_fields),
+    [27] = LAYOUT(type27_fields),
+};
+
+/*@null@*/const struct ais_record_field_t *ais_record_fields(unsigned int type,
+							    size_t *nfields)
+/* the body layout of a message type, or NULL if it has none */
+{
+    if (type >= sizeof(layouts) / sizeof(layouts[0])
+	|| layouts[type].fields == NULL) {
+	*nfields = 0;
+	return NULL;
+    }
+    *nfields = layouts[type].nfields;
+    return layouts[type].fields;
+}
+
+static unsigned char *put16(unsigned char *p, unsigned int val)
+{
+    p[0] = (unsigned char)val;
+    p[1] = (unsigned char)(val >> 8);
+    return p + 2;
+}
+
+static unsigned char *put32(unsigned char *p, unsigned int val)
+{
+    p[0] = (unsigned char)val;
+    p[1] = (unsigned char)(val >> 8);
+    p[2] = (unsigned char)(val >> 16);
+    p[3] = (unsigned char)(val >> 24);
+    return p + 4;
+}
+
+size_t ais_record_dump(const struct ais_t *ais,
+		       /*@out@*/unsigned char *buf, size_t buflen)
+/*
+ * Write one record; returns its length, or 0 if it would not fit.
+ * Records are never truncated, so a buffer of AIS_RECORD_MAX bytes
+ * always suffices.
+ */
+{
+    const char *base = (const char *)ais;
+    const struct ais_record_field_t *field;
+    size_t nfields, i;
+    unsigned char *p = buf, *end = buf + buflen;
+
+    if (buflen < AIS_RECORD_HEADER)
+	return 0;
+    p += 2;			/* length goes in last */
+    *p++ = AIS_RECORD_VERSION;
+    *p++ = (unsigned char)ais->type;
+    *p++ = (unsigned char)ais->repeat;
+    p = put32(p, ais->mmsi);
+
+    field = ais_record_fields(ais->type, &nfields);
+    for (i = 0; i < nfields; i++, field++) {
+	const char *from = base + field->offset;
+	size_t n;
+
+	switch (field->format) {
+	case 'p':
+	    n = *(const size_t *)from;
+	    if (n > (size_t)field->size * CHAR_BIT)
+		n = (size_t)field->size * CHAR_BIT;
+	    /* decoded application data has overwritten the raw bits */
+	    if ((ais->type == 6 && ais->type6.structured)
+		|| (ais->type == 8 && ais->type8.structured))
+		n = 0;
+	    if ((size_t)(end - p) < 2 + (n + CHAR_BIT - 1) / CHAR_BIT)
+		return 0;
+	    p = put16(p, (unsigned int)n);
+	    n = (n + CHAR_BIT - 1) / CHAR_BIT;
+	    (void)memcpy(p, base + field->data, n);
+	    p += n;
+	    continue;
+	case 's':
+	    if ((size_t)(end - p) < field->size)
+		return 0;
+	    n = strnlen(from, field->size);
+	    (void)memcpy(p, from, n);
+	    (void)memset(p + n, '\0', field->size - n);
+	    p += field->size;
+	    continue;
+	}
+	if ((size_t)(end - p) < field->size)
+	    return 0;
+	switch (field->format) {
+	case '?':
+	    *p++ = (unsigned char)*(const bool *)from;
+	    break;
+	case 'B':
+	case 'b':
+	    *p++ = (unsigned char)*(const unsigned int *)from;
+	    break;
+	case 'H':
+	    p = put16(p, *(const unsigned int *)from);
+	    break;
+	case 'I':
+	case 'i':
+	    p = put32(p, *(const unsigned int *)from);
+	    break;
+	}
+    }
+    (void)put16(buf, (unsigned int)(p - buf));
+    return (size_t)(p - buf);
+}
+
+static const char *format_name(const struct ais_record_field_t *field,
+			       char *buf, size_t buflen)
+/* the format of a field as the schema spells it */
+{
+    if (field->format == 's')
+	(void)snprintf(buf, buflen, "%us", (unsigned int)field->size);
+    else
+	(void)snprintf(buf, buflen, "%c", field->format);
+    return buf;
+}
+
+size_t ais_record_schema(/*@out@*/char *buf, size_t buflen)
+/*
+ * Describe the record layouts as JSON:
+ *
+ *   {"version":1,"header":[["length","H"],...],
+ *    "types":{"1":[["status","B"],...],...}}
+ *
+ * Returns the length, or buflen if the buffer was too small.
+ */
+{
+    static const struct ais_record_field_t header[] = {
+	{"length", 'H', 2, 0, 0},
+	{"version", 'B', 1, 0, 0},
+	{"type", 'B', 1, 0, 0},
+	{"repeat", 'B', 1, 0, 0},
+	{"mmsi", 'I', 4, 0, 0},
+    };
+    char format[8];
+    const char *sep = "";
+    size_t len = 0, i, j;
+    int n;
+
+#define SCHEMA_PRINTF(...) \
+    do { \
+	n = snprintf(buf + len, buflen - len, __VA_ARGS__); \
+	if (n < 0 || (size_t)n >= buflen - len) \
+	    return buflen; \
+	len += (size_t)n; \
+    } while (0)
+
+    if (buflen == 0)
+	return 0;
+    SCHEMA_PRINTF("{\"version\":%d,\"header\":[", AIS_RECORD_VERSION);
+    for (i = 0; i < sizeof(header) / sizeof(header[0]); i++)
+	SCHEMA_PRINTF("%s[\"%s\",\"%s\"]", i ? "," : "", header[i].name,
+		      format_name(&header[i], format, sizeof(format)));
+    SCHEMA_PRINTF("],\"types\":{");
+    for (i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++) {
+	if (layouts[i].fields == NULL)
+	    continue;
+	SCHEMA_PRINTF("%s\"%u\":[", sep, (unsigned int)i);
+	sep = ",";
+	for (j = 0; j < layouts[i].nfields; j++)
+	    SCHEMA_PRINTF("%s[\"%s\",\"%s\"]", j ? "," : "",
+			  layouts[i].fields[j].name,
+			  format_name(&layouts[i].fields[j],
+				      format, sizeof(format)));
+	SCHEMA_PRINTF("]");
+    }
+    SCHEMA_PRINTF("}}");
+#undef SCHEMA_PRINTF
+    return len;
+}
+
+/* ais_record.c ends here */
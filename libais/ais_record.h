@@ -0,0 +1,77 @@
+/* ais_record.h - fixed-layout binary records for decoded AIS messages
+ *
+ * A compact alternative to json_aivdm_dump() for bulk jobs: values are
+ * written in their raw AIS units, with no text formatting on the way
+ * out and no parsing on the way in.
+ *
+ * Every record starts with the same 9-byte header; all integers are
+ * little-endian and nothing is aligned or padded:
+ *
+ *	offset	format	name
+ *	0	H	length		record length in bytes, header included
+ *	2	B	version		AIS_RECORD_VERSION
+ *	3	B	type		message type, 1-27
+ *	4	B	repeat		repeat indicator
+ *	5	I	mmsi		source MMSI
+ *
+ * The body that follows is the fields of ais_record_fields(type), in
+ * order.  Each field is one of
+ *
+ *	B, H, I		unsigned integer of 1, 2 or 4 bytes
+ *	b, i		signed integer of 1 or 4 bytes
+ *	?		boolean, one byte holding 0 or 1
+ *	s		string of exactly size bytes, NUL-padded
+ *	p		binary payload: an H bit count, then that many
+ *			bits rounded up to whole bytes
+ *
+ * which, apart from p, are the format characters of Python's struct
+ * module, so a reader can build "<HBBBI" plus a body format directly
+ * from the table.  A payload is always the last field of its record.
+ * ais_record_schema() renders the whole table as JSON for readers that
+ * cannot link against this library.
+ *
+ * Fields keep the names used by the JSON dump.  Where the decoder
+ * keeps alternatives in a union, both are listed over the same bytes
+ * and the record says which one applies: dest1/dest2 or the corners in
+ * type 22 (addressed), mothership_mmsi or the dimensions in type 24
+ * (AIS_AUXILIARY_MMSI of the mmsi).  For types 6 and 8 the payload is
+ * only carried when structured is false; structured application data
+ * is not part of version 1, and its payload has a bit count of 0.
+ *
+ * The version is bumped whenever an existing layout changes.  Adding
+ * a layout for a type that had none does not bump it.
+ *
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#ifndef _AIS_RECORD_H_
+#define _AIS_RECORD_H_
+
+#include <stddef.h>
+
+#include "gps.h"
+
+#define AIS_RECORD_VERSION	1
+#define AIS_RECORD_HEADER	9	/* bytes before the body */
+#define AIS_RECORD_MAX		256	/* no record is longer than this */
+
+struct ais_record_field_t {
+    const char *name;
+    char format;		/* see above */
+    unsigned short size;	/* bytes in the record, or payload maximum */
+    unsigned short offset;	/* where the value lives in struct ais_t */
+    unsigned short data;	/* for payloads, offset of the bits */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*@null@*/const struct ais_record_field_t *ais_record_fields(unsigned int,
+							    /*@out@*/size_t *);
+size_t ais_record_dump(const struct ais_t *, /*@out@*/unsigned char *, size_t);
+size_t ais_record_schema(/*@out@*/char *, size_t);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AIS_RECORD_H_ */
+/* ais_record.h ends here */
@@ -138,10 +138,11 @@ void shiftleft(unsigned char *data, int size, unsigned short left)
     unsigned char *byte;
 
     if (left >= CHAR_BIT) {
-	size -= left/CHAR_BIT;
+	size -= left - left % CHAR_BIT;
 	memmove(data, data + left/CHAR_BIT, (size + CHAR_BIT - 1)/CHAR_BIT);
 	left %= CHAR_BIT;
     }
+    size = (size + CHAR_BIT - 1) / CHAR_BIT;	/* bits to bytes */
 
     for (byte = data; size--; ++byte )
     {
@@ -15,6 +15,8 @@
 #define _GPSD_BITS_H_
 
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
 #include <limits.h>
 
 /* number of bytes requited to contain a bit array of specified length */
@@ -60,4 +62,63 @@ extern void shiftleft(unsigned char *, int, unsigned short);
 extern uint64_t ubits(unsigned char buf[], unsigned int, unsigned int, bool);
 extern int64_t sbits(signed char buf[], unsigned int, unsigned int, bool);
 
+/*
+ * Word-at-a-time extraction of MSB-first bitfields, as used by AIS.
+ * buflen is the number of valid bytes in buf.  Any field that fits in
+ * one unaligned 64-bit big-endian load is extracted with a single
+ * load, shift and mask; fields near the end of the data take the
+ * guarded byte loop, which reads bytes at or past buflen as zero.
+ * ubits() above stays as the reference implementation.
+ */
+static inline uint64_t ubits_be(const unsigned char *buf, size_t buflen,
+				unsigned int start, unsigned int width)
+{
+    size_t off = start / CHAR_BIT;
+    unsigned int shift = start % CHAR_BIT;
+    uint64_t fld;
+
+    if (width == 0)
+	return 0;
+    if (off + sizeof(uint64_t) <= buflen
+	&& shift + width <= sizeof(uint64_t) * CHAR_BIT) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	(void)memcpy(&fld, buf + off, sizeof(fld));
+	fld = __builtin_bswap64(fld);
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	(void)memcpy(&fld, buf + off, sizeof(fld));
+#else
+	fld = getbeu64(buf, off);
+#endif
+	return (fld << shift) >> (sizeof(uint64_t) * CHAR_BIT - width);
+    } else {
+	size_t end = (start + width + CHAR_BIT - 1) / CHAR_BIT;
+	unsigned int tail = (start + width) % CHAR_BIT;
+
+	fld = 0;
+	for (; off < end; off++) {
+	    fld <<= CHAR_BIT;
+	    if (off < buflen)
+		fld |= buf[off];
+	}
+	if (tail != 0)
+	    fld >>= CHAR_BIT - tail;
+	if (width < sizeof(uint64_t) * CHAR_BIT)
+	    fld &= ((uint64_t)1 << width) - 1;
+	return fld;
+    }
+}
+
+static inline int64_t sbits_be(const unsigned char *buf, size_t buflen,
+			       unsigned int start, unsigned int width)
+{
+    uint64_t fld = ubits_be(buf, buflen, start, width);
+    uint64_t sign;
+
+    if (width == 0)
+	return 0;
+    /* twos-complement sign extension without shifting negative values */
+    sign = (uint64_t)1 << (width - 1);
+    return (int64_t)((fld ^ sign) - sign);
+}
+
 #endif /* _GPSD_BITS_H_ */
@@ -28,7 +28,8 @@
  * Parse the data from the device
  */
 
-static void from_sixbit(unsigned char *bitvec, uint start, int count, char *to)
+static void from_sixbit(const unsigned char *bitvec, size_t buflen,
+			uint start, int count, char *to)
 /* beginning at bitvec bit start, unpack count sixbit characters */
 {
     /*@ +type @*/
@@ -44,7 +45,7 @@ static void from_sixbit(unsigned char *bitvec, uint start, int count, char *to)
     /* six-bit to ASCII */
     for (i = 0; i < count; i++) {
 	char newchar;
-	newchar = sixchr[ubits(bitvec, start + 6 * i, 6U, false)];
+	newchar = sixchr[ubits_be(bitvec, buflen, start + 6 * i, 6U)];
 	if (newchar == '@')
 	    break;
 	else
@@ -60,25 +61,115 @@ static void from_sixbit(unsigned char *bitvec, uint start, int count, char *to)
     /*@ -type @*/
 }
 
+static void ais_clear_member(struct ais_t *ais)
+/* zero only the union member that this message type decodes into */
+{
+    size_t len;
+
+    switch (ais->type) {
+    case 1:
+    case 2:
+    case 3:
+	len = sizeof(ais->type1);
+	break;
+    case 4:
+    case 11:
+	len = sizeof(ais->type4);
+	break;
+    case 5:
+	len = sizeof(ais->type5);
+	break;
+    case 6:
+	len = sizeof(ais->type6);
+	break;
+    case 7:
+    case 13:
+	len = sizeof(ais->type7);
+	break;
+    case 8:
+	len = sizeof(ais->type8);
+	break;
+    case 9:
+	len = sizeof(ais->type9);
+	break;
+    case 10:
+	len = sizeof(ais->type10);
+	break;
+    case 12:
+	len = sizeof(ais->type12);
+	break;
+    case 14:
+	len = sizeof(ais->type14);
+	break;
+    case 15:
+	len = sizeof(ais->type15);
+	break;
+    case 16:
+	len = sizeof(ais->type16);
+	break;
+    case 17:
+	len = sizeof(ais->type17);
+	break;
+    case 18:
+	len = sizeof(ais->type18);
+	break;
+    case 19:
+	len = sizeof(ais->type19);
+	break;
+    case 20:
+	len = sizeof(ais->type20);
+	break;
+    case 21:
+	len = sizeof(ais->type21);
+	break;
+    case 22:
+	len = sizeof(ais->type22);
+	break;
+    case 23:
+	len = sizeof(ais->type23);
+	break;
+    case 24:
+	len = sizeof(ais->type24);
+	break;
+    case 25:
+	len = sizeof(ais->type25);
+	break;
+    case 26:
+	len = sizeof(ais->type26);
+	break;
+    case 27:
+	len = sizeof(ais->type27);
+	break;
+    default:
+	return;
+    }
+    (void)memset(&ais->type1, '\0', len);
+}
+
 /*@ +charint @*/
-bool ais_binary_decode(const struct gpsd_errout_t *errout,
-		       struct ais_t *ais,
-		       const unsigned char *bits, size_t bitlen,
-		       struct ais_type24_queue_t *type24_queue)
-/* decode an AIS binary packet */
+bool ais_binary_decode_fields(const struct gpsd_errout_t *errout,
+			      struct ais_t *ais,
+			      const unsigned char *bits, size_t bitlen,
+			      struct ais_type24_queue_t *type24_queue,
+			      unsigned int fields)
+/* decode the AIS_FIELDS_* groups of an AIS binary packet */
 {
     unsigned int u; int i;
 
 #ifdef S_SPLINT_S
     assert(type24_queue != NULL);
 #endif /* S_SPLINT_S */
-#define UBITS(s, l)	ubits((unsigned char *)bits, s, l, false)
-#define SBITS(s, l)	sbits((signed char *)bits, s, l, false)
-#define UCHARS(s, to)	from_sixbit((unsigned char *)bits, s, sizeof(to)-1, to)
-#define ENDCHARS(s, to)	from_sixbit((unsigned char *)bits, s, (bitlen-(s))/6,to)
+    /* fields are read only from the valid bytes; anything past them is zero */
+    size_t buflen = BITS_TO_BYTES(bitlen);
+#define UBITS(s, l)	ubits_be(bits, buflen, s, l)
+#define SBITS(s, l)	sbits_be(bits, buflen, s, l)
+#define UCHARS(s, to)	from_sixbit(bits, buflen, s, sizeof(to)-1, to)
+#define ENDCHARS(s, to)	from_sixbit(bits, buflen, s, (bitlen-(s))/6,to)
+#define WANT(group)	((fields & (group)) != 0)
     ais->type = UBITS(0, 6);
     ais->repeat = UBITS(6, 2);
     ais->mmsi = UBITS(8, 30);
+    ais_clear_member(ais);
 //    gpsd_report(errout, LOG_INF,
 //		"AIVDM message type %d, MMSI %09d:\n",
 //		ais->type, ais->mmsi);
@@ -113,36 +204,50 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
     case 2:
     case 3:
 	PERMISSIVE_LENGTH_CHECK(168)
-	ais->type1.status	= UBITS(38, 4);
-	ais->type1.turn		= SBITS(42, 8);
-	ais->type1.speed	= UBITS(50, 10);
-	ais->type1.accuracy	= UBITS(60, 1)!=0;
-	ais->type1.lon		= SBITS(61, 28);
-	ais->type1.lat		= SBITS(89, 27);
-	ais->type1.course	= UBITS(116, 12);
-	ais->type1.heading	= UBITS(128, 9);
-	ais->type1.second	= UBITS(137, 6);
-	ais->type1.maneuver	= UBITS(143, 2);
+	if (WANT(AIS_FIELDS_STATUS)) {
+	    ais->type1.status	= UBITS(38, 4);
+	    ais->type1.maneuver	= UBITS(143, 2);
+	}
+	if (WANT(AIS_FIELDS_MOTION)) {
+	    ais->type1.turn	= SBITS(42, 8);
+	    ais->type1.speed	= UBITS(50, 10);
+	    ais->type1.course	= UBITS(116, 12);
+	    ais->type1.heading	= UBITS(128, 9);
+	}
+	if (WANT(AIS_FIELDS_POSITION)) {
+	    ais->type1.accuracy	= UBITS(60, 1)!=0;
+	    ais->type1.lon	= SBITS(61, 28);
+	    ais->type1.lat	= SBITS(89, 27);
+	    ais->type1.raim	= UBITS(148, 1)!=0;
+	}
+	if (WANT(AIS_FIELDS_TIME))
+	    ais->type1.second	= UBITS(137, 6);
 	//ais->type1.spare	= UBITS(145, 3);
-	ais->type1.raim		= UBITS(148, 1)!=0;
-	ais->type1.radio	= UBITS(149, 19);
+	if (WANT(AIS_FIELDS_RADIO))
+	    ais->type1.radio	= UBITS(149, 19);
 	break;
     case 4: 	/* Base Station Report */
     case 11:	/* UTC/Date Response */
 	PERMISSIVE_LENGTH_CHECK(168)
-	ais->type4.year		= UBITS(38, 14);
-	ais->type4.month	= UBITS(52, 4);
-	ais->type4.day		= UBITS(56, 5);
-	ais->type4.hour		= UBITS(61, 5);
-	ais->type4.minute	= UBITS(66, 6);
-	ais->type4.second	= UBITS(72, 6);
-	ais->type4.accuracy	= UBITS(78, 1)!=0;
-	ais->type4.lon		= SBITS(79, 28);
-	ais->type4.lat		= SBITS(107, 27);
-	ais->type4.epfd		= UBITS(134, 4);
+	if (WANT(AIS_FIELDS_TIME)) {
+	    ais->type4.year	= UBITS(38, 14);
+	    ais->type4.month	= UBITS(52, 4);
+	    ais->type4.day	= UBITS(56, 5);
+	    ais->type4.hour	= UBITS(61, 5);
+	    ais->type4.minute	= UBITS(66, 6);
+	    ais->type4.second	= UBITS(72, 6);
+	}
+	if (WANT(AIS_FIELDS_POSITION)) {
+	    ais->type4.accuracy	= UBITS(78, 1)!=0;
+	    ais->type4.lon	= SBITS(79, 28);
+	    ais->type4.lat	= SBITS(107, 27);
+	    ais->type4.raim	= UBITS(148, 1)!=0;
+	}
+	if (WANT(AIS_FIELDS_STATUS))
+	    ais->type4.epfd	= UBITS(134, 4);
 	//ais->type4.spare	= UBITS(138, 10);
-	ais->type4.raim		= UBITS(148, 1)!=0;
-	ais->type4.radio	= UBITS(149, 19);
+	if (WANT(AIS_FIELDS_RADIO))
+	    ais->type4.radio	= UBITS(149, 19);
 	break;
     case 5: /* Ship static and voyage related data */
 	if (bitlen != 424) {
@@ -156,35 +261,45 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 	    if (bitlen < 420)
 		return false;
 	}
-	ais->type5.ais_version  = UBITS(38, 2);
-	ais->type5.imo          = UBITS(40, 30);
-	UCHARS(70, ais->type5.callsign);
-	UCHARS(112, ais->type5.shipname);
-	ais->type5.shiptype     = UBITS(232, 8);
-	ais->type5.to_bow       = UBITS(240, 9);
-	ais->type5.to_stern     = UBITS(249, 9);
-	ais->type5.to_port      = UBITS(258, 6);
-	ais->type5.to_starboard = UBITS(264, 6);
-	ais->type5.epfd         = UBITS(270, 4);
-	ais->type5.month        = UBITS(274, 4);
-	ais->type5.day          = UBITS(278, 5);
-	ais->type5.hour         = UBITS(283, 5);
-	ais->type5.minute       = UBITS(288, 6);
-	ais->type5.draught      = UBITS(294, 8);
-	UCHARS(302, ais->type5.destination);
-	if (bitlen >= 423)
-	    ais->type5.dte          = UBITS(422, 1);
+	if (WANT(AIS_FIELDS_STATIC)) {
+	    ais->type5.ais_version  = UBITS(38, 2);
+	    ais->type5.imo          = UBITS(40, 30);
+	    ais->type5.shiptype     = UBITS(232, 8);
+	    ais->type5.to_bow       = UBITS(240, 9);
+	    ais->type5.to_stern     = UBITS(249, 9);
+	    ais->type5.to_port      = UBITS(258, 6);
+	    ais->type5.to_starboard = UBITS(264, 6);
+	    ais->type5.month        = UBITS(274, 4);
+	    ais->type5.day          = UBITS(278, 5);
+	    ais->type5.hour         = UBITS(283, 5);
+	    ais->type5.minute       = UBITS(288, 6);
+	    ais->type5.draught      = UBITS(294, 8);
+	}
+	if (WANT(AIS_FIELDS_TEXT)) {
+	    UCHARS(70, ais->type5.callsign);
+	    UCHARS(112, ais->type5.shipname);
+	    UCHARS(302, ais->type5.destination);
+	}
+	if (WANT(AIS_FIELDS_STATUS)) {
+	    ais->type5.epfd         = UBITS(270, 4);
+	    if (bitlen >= 423)
+		ais->type5.dte      = UBITS(422, 1);
+	}
 	//ais->type5.spare        = UBITS(423, 1);
 	break;
     case 6: /* Addressed Binary Message */
 	RANGE_CHECK(88, 1008);
-	ais->type6.seqno          = UBITS(38, 2);
-	ais->type6.dest_mmsi      = UBITS(40, 30);
-	ais->type6.retransmit     = UBITS(70, 1)!=0;
+	if (WANT(AIS_FIELDS_LINK)) {
+	    ais->type6.seqno      = UBITS(38, 2);
+	    ais->type6.dest_mmsi  = UBITS(40, 30);
+	    ais->type6.retransmit = UBITS(70, 1)!=0;
+	}
 	//ais->type6.spare        = UBITS(71, 1);
+	ais->type6.bitcount       = bitlen - 88;
+	if (!WANT(AIS_FIELDS_BINARY))
+	    break;
 	ais->type6.dac            = UBITS(72, 10);
 	ais->type6.fid            = UBITS(82, 6);
-	ais->type6.bitcount       = bitlen - 88;
 	/* not strictly required - helps stability in testing */ 
 	(void)memset(ais->type6.bitdata, '\0', sizeof(ais->type6.bitdata));
 	ais->type6.structured = false;
@@ -283,7 +398,8 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 		ais->type6.dac1fid32.day	= UBITS(92, 5);
 #define ARRAY_BASE 97
 #define ELEMENT_SIZE 93
-		for (u = 0; ARRAY_BASE + (ELEMENT_SIZE*u) <= bitlen; u++) {
+		for (u = 0; ARRAY_BASE + (ELEMENT_SIZE*u) <= bitlen
+			 && u < NITEMS(ais->type6.dac1fid32.tidals); u++) {
 		    int a = ARRAY_BASE + (ELEMENT_SIZE*u);
 		    struct tidal_t *tp = &ais->type6.dac1fid32.tidals[u];
 		    tp->lat	= SBITS(a + 0, 27);
@@ -370,7 +486,8 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 	    case 25:	/* IMO289 - Dangerous cargo indication */
 		ais->type6.dac1fid25.unit 	= UBITS(88, 2);
 		ais->type6.dac1fid25.amount	= UBITS(90, 10);
-		for (u = 0; 100 + u*17 < bitlen; u++) {
+		for (u = 0; 100 + u*17 < bitlen
+			 && u < NITEMS(ais->type6.dac1fid25.cargos); u++) {
 		    ais->type6.dac1fid25.cargos[u].code    = UBITS(100+u*17,4);
 		    ais->type6.dac1fid25.cargos[u].subtype = UBITS(104+u*17,13);
 		}
@@ -387,6 +504,8 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 		ais->type6.dac1fid28.minute		= UBITS(120, 6);
 		ais->type6.dac1fid28.duration	= UBITS(126, 18);
 		ais->type6.dac1fid28.waycount	= UBITS(144, 5);
+		if (ais->type6.dac1fid28.waycount > NITEMS(ais->type6.dac1fid28.waypoints))
+		    ais->type6.dac1fid28.waycount = NITEMS(ais->type6.dac1fid28.waypoints);
 #define ARRAY_BASE 149
 #define ELEMENT_SIZE 55
 		for (u = 0; u < (unsigned char)ais->type6.dac1fid28.waycount; u++) {
@@ -408,7 +527,8 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 		ais->type6.dac1fid32.day	= UBITS(92, 5);
 #define ARRAY_BASE 97
 #define ELEMENT_SIZE 88
-		for (u = 0; ARRAY_BASE + (ELEMENT_SIZE*u) <= bitlen; u++) {
+		for (u = 0; ARRAY_BASE + (ELEMENT_SIZE*u) <= bitlen
+			 && u < NITEMS(ais->type6.dac1fid32.tidals); u++) {
 		    int a = ARRAY_BASE + (ELEMENT_SIZE*u);
 		    struct tidal_t *tp = &ais->type6.dac1fid32.tidals[u];
 		    tp->lon	= SBITS(a + 0, 25);
@@ -436,6 +556,8 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
     {
 	unsigned int mmsi[4];
 	RANGE_CHECK(72, 158);
+	if (!WANT(AIS_FIELDS_LINK))
+	    break;
 	for (u = 0; u < sizeof(mmsi)/sizeof(mmsi[0]); u++)
 	    if (bitlen > 40 + 32*u)
 		mmsi[u] = UBITS(40 + 32*u, 30);
@@ -452,9 +574,11 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
     case 8: /* Binary Broadcast Message */
 	RANGE_CHECK(56, 1008);
 	//ais->type8.spare        = UBITS(38, 2);
+	ais->type8.bitcount       = bitlen - 56;
+	if (!WANT(AIS_FIELDS_BINARY))
+	    break;
 	ais->type8.dac            = UBITS(40, 10);
 	ais->type8.fid            = UBITS(50, 6);
-	ais->type8.bitcount       = bitlen - 56;
 	/* not strictly required - helps stability in testing */ 
 	(void)memset(ais->type8.bitdata, '\0', sizeof(ais->type8.bitdata));
 	ais->type8.structured = false;
@@ -532,7 +656,8 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 	    case 17:        /* IMO289 - VTS-generated/synthetic targets */
 #define ARRAY_BASE 56
 #define ELEMENT_SIZE 122
-		for (u = 0; ARRAY_BASE + (ELEMENT_SIZE*u) <= bitlen; u++) {
+		for (u = 0; ARRAY_BASE + (ELEMENT_SIZE*u) <= bitlen
+			 && u < NITEMS(ais->type8.dac1fid17.targets); u++) {
 		    struct target_t *tp = &ais->type8.dac1fid17.targets[u];
 		    int a = ARRAY_BASE + (ELEMENT_SIZE*u);
 		    tp->idtype = UBITS(a + 0, 2);
@@ -593,6 +718,8 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 		ais->type8.dac1fid27.minute	= UBITS(88, 6);
 		ais->type8.dac1fid27.duration	= UBITS(94, 18);
 		ais->type8.dac1fid27.waycount	= UBITS(112, 5);
+		if (ais->type8.dac1fid27.waycount > NITEMS(ais->type8.dac1fid27.waypoints))
+		    ais->type8.dac1fid27.waycount = NITEMS(ais->type8.dac1fid27.waypoints);
 #define ARRAY_BASE 117
 #define ELEMENT_SIZE 55
 		for (i = 0; i < ais->type8.dac1fid27.waycount; i++) {
@@ -741,42 +868,57 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 	break;
     case 9: /* Standard SAR Aircraft Position Report */
 	PERMISSIVE_LENGTH_CHECK(168);
-	ais->type9.alt		= UBITS(38, 12);
-	ais->type9.speed		= UBITS(50, 10);
-	ais->type9.accuracy		= (bool)UBITS(60, 1);
-	ais->type9.lon		= SBITS(61, 28);
-	ais->type9.lat		= SBITS(89, 27);
-	ais->type9.course		= UBITS(116, 12);
-	ais->type9.second		= UBITS(128, 6);
-	ais->type9.regional		= UBITS(134, 8);
-	ais->type9.dte		= UBITS(142, 1);
+	if (WANT(AIS_FIELDS_MOTION)) {
+	    ais->type9.alt		= UBITS(38, 12);
+	    ais->type9.speed		= UBITS(50, 10);
+	    ais->type9.course		= UBITS(116, 12);
+	}
+	if (WANT(AIS_FIELDS_POSITION)) {
+	    ais->type9.accuracy		= (bool)UBITS(60, 1);
+	    ais->type9.lon		= SBITS(61, 28);
+	    ais->type9.lat		= SBITS(89, 27);
+	    ais->type9.raim		= UBITS(147, 1)!=0;
+	}
+	if (WANT(AIS_FIELDS_TIME))
+	    ais->type9.second		= UBITS(128, 6);
+	if (WANT(AIS_FIELDS_STATUS)) {
+	    ais->type9.regional		= UBITS(134, 8);
+	    ais->type9.dte		= UBITS(142, 1);
+	    ais->type9.assigned		= UBITS(146, 1)!=0;
+	}
 	//ais->type9.spare		= UBITS(143, 3);
-	ais->type9.assigned		= UBITS(146, 1)!=0;
-	ais->type9.raim		= UBITS(147, 1)!=0;
-	ais->type9.radio		= UBITS(148, 19);
+	if (WANT(AIS_FIELDS_RADIO))
+	    ais->type9.radio		= UBITS(148, 19);
 	break;
     case 10: /* UTC/Date inquiry */
 	PERMISSIVE_LENGTH_CHECK(72);
 	//ais->type10.spare        = UBITS(38, 2);
-	ais->type10.dest_mmsi      = UBITS(40, 30);
+	if (WANT(AIS_FIELDS_LINK))
+	    ais->type10.dest_mmsi  = UBITS(40, 30);
 	//ais->type10.spare2       = UBITS(70, 2);
 	break;
     case 12: /* Safety Related Message */
 	RANGE_CHECK(72, 1008);
-	ais->type12.seqno          = UBITS(38, 2);
-	ais->type12.dest_mmsi      = UBITS(40, 30);
-	ais->type12.retransmit     = (bool)UBITS(70, 1);
+	if (WANT(AIS_FIELDS_LINK)) {
+	    ais->type12.seqno      = UBITS(38, 2);
+	    ais->type12.dest_mmsi  = UBITS(40, 30);
+	    ais->type12.retransmit = (bool)UBITS(70, 1);
+	}
 	//ais->type12.spare        = UBITS(71, 1);
-	ENDCHARS(72, ais->type12.text);
+	if (WANT(AIS_FIELDS_TEXT))
+	    ENDCHARS(72, ais->type12.text);
 	break;
     case 14:	/* Safety Related Broadcast Message */
 	RANGE_CHECK(40, 1008);
 	//ais->type14.spare          = UBITS(38, 2);
-	ENDCHARS(40, ais->type14.text);
+	if (WANT(AIS_FIELDS_TEXT))
+	    ENDCHARS(40, ais->type14.text);
 	break;
     case 15:	/* Interrogation */
 	RANGE_CHECK(88, 168);
 	(void)memset(&ais->type15, '\0', sizeof(ais->type15));
+	if (!WANT(AIS_FIELDS_LINK))
+	    break;
 	//ais->type14.spare         = UBITS(38, 2);
 	ais->type15.mmsi1		= UBITS(40, 30);
 	ais->type15.type1_1		= UBITS(70, 6);
@@ -797,6 +939,8 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 	break;
     case 16:	/* Assigned Mode Command */
 	RANGE_CHECK(96, 144);
+	if (!WANT(AIS_FIELDS_LINK))
+	    break;
 	ais->type16.mmsi1		= UBITS(40, 30);
 	ais->type16.offset1		= UBITS(70, 12);
 	ais->type16.increment1	= UBITS(82, 10);
@@ -811,59 +955,82 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
     case 17:	/* GNSS Broadcast Binary Message */
 	RANGE_CHECK(80, 816);
 	//ais->type17.spare         = UBITS(38, 2);
-	ais->type17.lon		= UBITS(40, 18);
-	ais->type17.lat		= UBITS(58, 17);
+	if (WANT(AIS_FIELDS_POSITION)) {
+	    ais->type17.lon	= UBITS(40, 18);
+	    ais->type17.lat	= UBITS(58, 17);
+	}
 	//ais->type17.spare	        = UBITS(75, 4);
 	ais->type17.bitcount        = bitlen - 80;
-	(void)memcpy(ais->type17.bitdata,
-		     (char *)bits + (80 / CHAR_BIT),
-		     BITS_TO_BYTES(ais->type17.bitcount));
+	if (WANT(AIS_FIELDS_BINARY))
+	    (void)memcpy(ais->type17.bitdata,
+			 (char *)bits + (80 / CHAR_BIT),
+			 BITS_TO_BYTES(ais->type17.bitcount));
 	break;
     case 18:	/* Standard Class B CS Position Report */
 	PERMISSIVE_LENGTH_CHECK(168)
-	ais->type18.reserved	= UBITS(38, 8);
-	ais->type18.speed		= UBITS(46, 10);
-	ais->type18.accuracy	= UBITS(56, 1)!=0;
-	ais->type18.lon		= SBITS(57, 28);
-	ais->type18.lat		= SBITS(85, 27);
-	ais->type18.course		= UBITS(112, 12);
-	ais->type18.heading		= UBITS(124, 9);
-	ais->type18.second		= UBITS(133, 6);
-	ais->type18.regional	= UBITS(139, 2);
-	ais->type18.cs		= UBITS(141, 1)!=0;
-	ais->type18.display 	= UBITS(142, 1)!=0;
-	ais->type18.dsc     	= UBITS(143, 1)!=0;
-	ais->type18.band    	= UBITS(144, 1)!=0;
-	ais->type18.msg22   	= UBITS(145, 1)!=0;
-	ais->type18.assigned	= UBITS(146, 1)!=0;
-	ais->type18.raim		= UBITS(147, 1)!=0;
-	ais->type18.radio		= UBITS(148, 20);
+	if (WANT(AIS_FIELDS_MOTION)) {
+	    ais->type18.speed		= UBITS(46, 10);
+	    ais->type18.course		= UBITS(112, 12);
+	    ais->type18.heading		= UBITS(124, 9);
+	}
+	if (WANT(AIS_FIELDS_POSITION)) {
+	    ais->type18.accuracy	= UBITS(56, 1)!=0;
+	    ais->type18.lon		= SBITS(57, 28);
+	    ais->type18.lat		= SBITS(85, 27);
+	    ais->type18.raim		= UBITS(147, 1)!=0;
+	}
+	if (WANT(AIS_FIELDS_TIME))
+	    ais->type18.second		= UBITS(133, 6);
+	if (WANT(AIS_FIELDS_STATUS)) {
+	    ais->type18.reserved	= UBITS(38, 8);
+	    ais->type18.regional	= UBITS(139, 2);
+	    ais->type18.cs		= UBITS(141, 1)!=0;
+	    ais->type18.display 	= UBITS(142, 1)!=0;
+	    ais->type18.dsc     	= UBITS(143, 1)!=0;
+	    ais->type18.band    	= UBITS(144, 1)!=0;
+	    ais->type18.msg22   	= UBITS(145, 1)!=0;
+	    ais->type18.assigned	= UBITS(146, 1)!=0;
+	}
+	if (WANT(AIS_FIELDS_RADIO))
+	    ais->type18.radio		= UBITS(148, 20);
 	break;
     case 19:	/* Extended Class B CS Position Report */
 	PERMISSIVE_LENGTH_CHECK(312)
-	ais->type19.reserved     = UBITS(38, 8);
-	ais->type19.speed        = UBITS(46, 10);
-	ais->type19.accuracy     = UBITS(56, 1)!=0;
-	ais->type19.lon          = SBITS(57, 28);
-	ais->type19.lat          = SBITS(85, 27);
-	ais->type19.course       = UBITS(112, 12);
-	ais->type19.heading      = UBITS(124, 9);
-	ais->type19.second       = UBITS(133, 6);
-	ais->type19.regional     = UBITS(139, 4);
-	UCHARS(143, ais->type19.shipname);
-	ais->type19.shiptype     = UBITS(263, 8);
-	ais->type19.to_bow       = UBITS(271, 9);
-	ais->type19.to_stern     = UBITS(280, 9);
-	ais->type19.to_port      = UBITS(289, 6);
-	ais->type19.to_starboard = UBITS(295, 6);
-	ais->type19.epfd         = UBITS(301, 4);
-	ais->type19.raim         = UBITS(305, 1)!=0;
-	ais->type19.dte          = UBITS(306, 1)!=0;
-	ais->type19.assigned     = UBITS(307, 1)!=0;
+	if (WANT(AIS_FIELDS_MOTION)) {
+	    ais->type19.speed        = UBITS(46, 10);
+	    ais->type19.course       = UBITS(112, 12);
+	    ais->type19.heading      = UBITS(124, 9);
+	}
+	if (WANT(AIS_FIELDS_POSITION)) {
+	    ais->type19.accuracy     = UBITS(56, 1)!=0;
+	    ais->type19.lon          = SBITS(57, 28);
+	    ais->type19.lat          = SBITS(85, 27);
+	    ais->type19.raim         = UBITS(305, 1)!=0;
+	}
+	if (WANT(AIS_FIELDS_TIME))
+	    ais->type19.second       = UBITS(133, 6);
+	if (WANT(AIS_FIELDS_TEXT))
+	    UCHARS(143, ais->type19.shipname);
+	if (WANT(AIS_FIELDS_STATIC)) {
+	    ais->type19.shiptype     = UBITS(263, 8);
+	    ais->type19.to_bow       = UBITS(271, 9);
+	    ais->type19.to_stern     = UBITS(280, 9);
+	    ais->type19.to_port      = UBITS(289, 6);
+	    ais->type19.to_starboard = UBITS(295, 6);
+	}
+	if (WANT(AIS_FIELDS_STATUS)) {
+	    ais->type19.reserved     = UBITS(38, 8);
+	    ais->type19.regional     = UBITS(139, 4);
+	    ais->type19.epfd         = UBITS(301, 4);
+	    ais->type19.dte          = UBITS(306, 1)!=0;
+	    ais->type19.assigned     = UBITS(307, 1)!=0;
+	}
 	//ais->type19.spare      = UBITS(308, 4);
 	break;
     case 20:	/* Data Link Management Message */
 	RANGE_CHECK(72, 160);
+	if (!WANT(AIS_FIELDS_LINK))
+	    break;
 	//ais->type20.spare		= UBITS(38, 2);
 	ais->type20.offset1		= UBITS(40, 12);
 	ais->type20.number1		= UBITS(52, 4);
@@ -884,29 +1051,40 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 	break;
     case 21:	/* Aid-to-Navigation Report */
 	RANGE_CHECK(272, 360);
-	ais->type21.aid_type = UBITS(38, 5);
-	from_sixbit((unsigned char *)bits,
-		    43, 20, ais->type21.name);
-	ais->type21.accuracy     = UBITS(163, 1);
-	ais->type21.lon          = SBITS(164, 28);
-	ais->type21.lat          = SBITS(192, 27);
-	ais->type21.to_bow       = UBITS(219, 9);
-	ais->type21.to_stern     = UBITS(228, 9);
-	ais->type21.to_port      = UBITS(237, 6);
-	ais->type21.to_starboard = UBITS(243, 6);
-	ais->type21.epfd         = UBITS(249, 4);
-	ais->type21.second       = UBITS(253, 6);
-	ais->type21.off_position = UBITS(259, 1)!=0;
-	ais->type21.regional     = UBITS(260, 8);
-	ais->type21.raim         = UBITS(268, 1)!=0;
-	ais->type21.virtual_aid  = UBITS(269, 1)!=0;
-	ais->type21.assigned     = UBITS(270, 1)!=0;
+	if (WANT(AIS_FIELDS_TEXT)) {
+	    from_sixbit(bits, buflen,
+			43, 20, ais->type21.name);
+	    if (strlen(ais->type21.name) == 20 && bitlen > 272)
+		ENDCHARS(272, ais->type21.name+20);
+	}
+	if (WANT(AIS_FIELDS_POSITION)) {
+	    ais->type21.accuracy     = UBITS(163, 1);
+	    ais->type21.lon          = SBITS(164, 28);
+	    ais->type21.lat          = SBITS(192, 27);
+	    ais->type21.raim         = UBITS(268, 1)!=0;
+	}
+	if (WANT(AIS_FIELDS_STATIC)) {
+	    ais->type21.aid_type     = UBITS(38, 5);
+	    ais->type21.to_bow       = UBITS(219, 9);
+	    ais->type21.to_stern     = UBITS(228, 9);
+	    ais->type21.to_port      = UBITS(237, 6);
+	    ais->type21.to_starboard = UBITS(243, 6);
+	}
+	if (WANT(AIS_FIELDS_TIME))
+	    ais->type21.second       = UBITS(253, 6);
+	if (WANT(AIS_FIELDS_STATUS)) {
+	    ais->type21.epfd         = UBITS(249, 4);
+	    ais->type21.off_position = UBITS(259, 1)!=0;
+	    ais->type21.regional     = UBITS(260, 8);
+	    ais->type21.virtual_aid  = UBITS(269, 1)!=0;
+	    ais->type21.assigned     = UBITS(270, 1)!=0;
+	}
 	//ais->type21.spare      = UBITS(271, 1);
-	if (strlen(ais->type21.name) == 20 && bitlen > 272)
-	    ENDCHARS(272, ais->type21.name+20);
 	break;
     case 22:	/* Channel Management */
 	PERMISSIVE_LENGTH_CHECK(168)
+	if (!WANT(AIS_FIELDS_LINK))
+	    break;
 	ais->type22.channel_a    = UBITS(40, 12);
 	ais->type22.channel_b    = UBITS(52, 12);
 	ais->type22.txrx         = UBITS(64, 4);
@@ -927,6 +1105,8 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 	break;
     case 23:	/* Group Assignment Command */
 	PERMISSIVE_LENGTH_CHECK(160)
+	if (!WANT(AIS_FIELDS_LINK))
+	    break;
 	ais->type23.ne_lon       = SBITS(40, 18);
 	ais->type23.ne_lat       = SBITS(58, 17);
 	ais->type23.sw_lon       = SBITS(75, 18);
@@ -941,6 +1121,10 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 	switch (UBITS(38, 2)) {
 	case 0:
 	    RANGE_CHECK(160, 168);
+	    ais->type24.part = part_a;
+	    /* the shipname is all there is to part A */
+	    if (!WANT(AIS_FIELDS_TEXT))
+		return true;
 	    /* save incoming 24A shipname/MMSI pairs in a circular queue */
 	    {
 		struct ais_type24a_t *saveptr = &type24_queue->ships[type24_queue->index];
@@ -956,11 +1140,26 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 	    //ais->type24.a.spare	= UBITS(160, 8);
 
 	    UCHARS(40, ais->type24.shipname);
-	    ais->type24.part = part_a;
 	    return true;
 	case 1:
 	    PERMISSIVE_LENGTH_CHECK(168)
-	    ais->type24.shiptype = UBITS(40, 8);
+	    ais->type24.part = part_b;
+	    if (WANT(AIS_FIELDS_STATIC)) {
+		ais->type24.shiptype = UBITS(40, 8);
+		ais->type24.model = UBITS(66, 4);
+		ais->type24.serial = UBITS(70, 20);
+		if (AIS_AUXILIARY_MMSI(ais->mmsi)) {
+		    ais->type24.mothership_mmsi   = UBITS(132, 30);
+		} else {
+		    ais->type24.dim.to_bow        = UBITS(132, 9);
+		    ais->type24.dim.to_stern      = UBITS(141, 9);
+		    ais->type24.dim.to_port       = UBITS(150, 6);
+		    ais->type24.dim.to_starboard  = UBITS(156, 6);
+		}
+	    }
+	    //ais->type24.b.spare	    = UBITS(162, 8);
+	    if (!WANT(AIS_FIELDS_TEXT))
+		return true;
 	    /*
 	     * In ITU-R 1371-4, there are new model and serial fields
 	     * carved out of the right-hand end of vendorid, which is
@@ -973,18 +1172,7 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 	     * model and serial fields.
 	     */
 	    UCHARS(48, ais->type24.vendorid);
-	    ais->type24.model = UBITS(66, 4);
-	    ais->type24.serial = UBITS(70, 20);
 	    UCHARS(90, ais->type24.callsign);
-	    if (AIS_AUXILIARY_MMSI(ais->mmsi)) {
-		ais->type24.mothership_mmsi   = UBITS(132, 30);
-	    } else {
-		ais->type24.dim.to_bow        = UBITS(132, 9);
-		ais->type24.dim.to_stern      = UBITS(141, 9);
-		ais->type24.dim.to_port       = UBITS(150, 6);
-		ais->type24.dim.to_starboard  = UBITS(156, 6);
-	    }
-	    //ais->type24.b.spare	    = UBITS(162, 8);
 
 	    /* search the 24A queue for a matching MMSI */
 	    for (i = 0; i < MAX_TYPE24_INTERLEAVE; i++) {
@@ -1003,7 +1191,6 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 	    }
 
 	    /* no match, return Part B */
-	    ais->type24.part = part_b;
 	    return true;
 	default:
 	    gpsd_report(errout, LOG_WARN,
@@ -1026,20 +1213,22 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 			"AIVDM message type 25 too short for mode.\n");
 	    return false;
 	}
-	if (ais->type25.addressed)
+	if (ais->type25.addressed && WANT(AIS_FIELDS_LINK))
 	    ais->type25.dest_mmsi   = UBITS(40, 30);
-	if (ais->type25.structured)
-	    ais->type25.app_id      = UBITS(40+ais->type25.addressed*30,16);
 	ais->type25.bitcount       = bitlen - 40 - 16*ais->type25.structured;
-	/* bit 40 is exactly 5 bytes in; 2 bytes is 16 bits */
-	(void)memcpy(ais->type25.bitdata,
-		     (char *)bits+5 + 2 * ais->type25.structured,
-		     BITS_TO_BYTES(ais->type25.bitcount));
-	/* discard MMSI if addressed */
-	if (ais->type25.addressed) {
-	    shiftleft((unsigned char *)ais->type25.bitdata, ais->type25.bitcount, 30);
-	    ais->type25.bitcount -= 30;
+	if (WANT(AIS_FIELDS_BINARY)) {
+	    if (ais->type25.structured)
+		ais->type25.app_id  = UBITS(40+ais->type25.addressed*30,16);
+	    /* bit 40 is exactly 5 bytes in; 2 bytes is 16 bits */
+	    (void)memcpy(ais->type25.bitdata,
+			 (char *)bits+5 + 2 * ais->type25.structured,
+			 BITS_TO_BYTES(ais->type25.bitcount));
+	    /* discard MMSI if addressed */
+	    if (ais->type25.addressed)
+		shiftleft((unsigned char *)ais->type25.bitdata, ais->type25.bitcount, 30);
 	}
+	if (ais->type25.addressed)
+	    ais->type25.bitcount -= 30;
 	break;
     case 26:	/* Binary Message, Multiple Slot */
 	RANGE_CHECK(60, 1004);
@@ -1050,19 +1239,21 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 			"AIVDM message type 26 too short for mode.\n");
 	    return false;
 	}
-	if (ais->type26.addressed)
+	if (ais->type26.addressed && WANT(AIS_FIELDS_LINK))
 	    ais->type26.dest_mmsi   = UBITS(40, 30);
-	if (ais->type26.structured)
-	    ais->type26.app_id      = UBITS(40+ais->type26.addressed*30,16);
 	ais->type26.bitcount        = bitlen - 60 - 16*ais->type26.structured;
-	(void)memcpy(ais->type26.bitdata,
-		     (unsigned char *)bits+5 + 2 * ais->type26.structured,
-		     BITS_TO_BYTES(ais->type26.bitcount));
-	/* discard MMSI if addressed */
-	if (ais->type26.addressed) {
-	    shiftleft((unsigned char *)ais->type26.bitdata, ais->type26.bitcount, 30);
-	    ais->type26.bitcount -= 30;
+	if (WANT(AIS_FIELDS_BINARY)) {
+	    if (ais->type26.structured)
+		ais->type26.app_id  = UBITS(40+ais->type26.addressed*30,16);
+	    (void)memcpy(ais->type26.bitdata,
+			 (unsigned char *)bits+5 + 2 * ais->type26.structured,
+			 BITS_TO_BYTES(ais->type26.bitcount));
+	    /* discard MMSI if addressed */
+	    if (ais->type26.addressed)
+		shiftleft((unsigned char *)ais->type26.bitdata, ais->type26.bitcount, 30);
 	}
+	if (ais->type26.addressed)
+	    ais->type26.bitcount -= 30;
 	break;
     case 27:	/* Long Range AIS Broadcast message */
 	if (bitlen != 96 && bitlen != 168) {
@@ -1078,14 +1269,20 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 	    gpsd_report(errout, LOG_WARN,
 			"oversized 169=8-bit AIVDM message type 27.\n");
 	}
-	ais->type27.accuracy        = (bool)UBITS(38, 1);
-	ais->type27.raim		= UBITS(39, 1)!=0;
-	ais->type27.status		= UBITS(40, 4);
-	ais->type27.lon		= SBITS(44, 18);
-	ais->type27.lat		= SBITS(62, 17);
-	ais->type27.speed		= UBITS(79, 6);
-	ais->type27.course		= UBITS(85, 9);
-	ais->type27.gnss            = (bool)UBITS(94, 1);
+	if (WANT(AIS_FIELDS_POSITION)) {
+	    ais->type27.accuracy	= (bool)UBITS(38, 1);
+	    ais->type27.raim		= UBITS(39, 1)!=0;
+	    ais->type27.lon		= SBITS(44, 18);
+	    ais->type27.lat		= SBITS(62, 17);
+	}
+	if (WANT(AIS_FIELDS_MOTION)) {
+	    ais->type27.speed		= UBITS(79, 6);
+	    ais->type27.course		= UBITS(85, 9);
+	}
+	if (WANT(AIS_FIELDS_STATUS)) {
+	    ais->type27.status		= UBITS(40, 4);
+	    ais->type27.gnss		= (bool)UBITS(94, 1);
+	}
 	break;
     default:
 	gpsd_report(errout, LOG_ERROR,
@@ -1093,6 +1290,7 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
 	return false;
     }
     /* *INDENT-ON* */
+#undef WANT
 #undef UCHARS
 #undef SBITS
 #undef UBITS
@@ -1100,6 +1298,16 @@ bool ais_binary_decode(const struct gpsd_errout_t *errout,
     /* data is fully decoded */
     return true;
 }
+
+bool ais_binary_decode(const struct gpsd_errout_t *errout,
+		       struct ais_t *ais,
+		       const unsigned char *bits, size_t bitlen,
+		       struct ais_type24_queue_t *type24_queue)
+/* decode an AIS binary packet */
+{
+    return ais_binary_decode_fields(errout, ais, bits, bitlen, type24_queue,
+				    AIS_FIELDS_ALL);
+}
 /*@ -charint @*/
 
 /* driver_ais.c ends here */
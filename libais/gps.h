@@ -1008,10 +1008,10 @@ struct ais_t
 
 /* Some libcs don't have strlcat/strlcpy. Local copies are provided */
 #ifndef HAVE_STRLCAT
-    //size_t strlcat(/*@out@*/char *dst, /*@in@*/const char *src, size_t size);
+    size_t strlcat(/*@out@*/char *dst, /*@in@*/const char *src, size_t size);
 #endif
 #ifndef HAVE_STRLCPY
-    //size_t strlcpy(/*@out@*/char *dst, /*@in@*/const char *src, size_t size);
+    size_t strlcpy(/*@out@*/char *dst, /*@in@*/const char *src, size_t size);
 #endif
 
 #ifdef __cplusplus
@@ -31,8 +31,19 @@ char *json_stringify(/*@out@*/char *, size_t, /*@in@*/const char *);
 //int json_device_read(const char *, /*@out@*/struct devconfig_t *,
 //		     /*@null@*/const char **);
 //void json_version_dump(/*@out@*/char *, size_t);
-  void json_aivdm_dump(const struct ais_t *, /*@null@*/const char *, bool,
-		     /*@out@*/char *, size_t);
+size_t json_aivdm_dump(const struct ais_t *, /*@null@*/const char *, bool,
+		       /*@out@*/char *, size_t);
+/* the legend texts of json_aivdm_dump() */
+enum json_ais_legend_t {
+    legend_nav,			/* navigation status, types 1-3 and 27 */
+    legend_epfd,
+    legend_shiptype,
+    legend_stationtype,
+    legend_navaid,		/* aid type, type 21 */
+};
+/*@observer@*/const char *json_ais_legend(enum json_ais_legend_t, unsigned int,
+					  /*@out@*/size_t *);
+unsigned int json_ais_legend_count(enum json_ais_legend_t);
 //int json_rtcm2_read(const char *, char *, size_t, struct rtcm2_t *,
 //		    /*@null@*/const char **);
 //int json_rtcm3_read(const char *, char *, size_t, struct rtcm3_t *,
@@ -63,21 +63,110 @@ struct ais_type24_queue_t {
 };
 
 /* state for resolving AIVDM decodes */
+#define AIVDM_MAX_BITS	2048	/* longest payload accepted, in bits */
 struct aivdm_context_t {
     /* hold context for decoding AIDVM packet sequences */
+    char channel;		/* 'A' or 'B'; '\0' while the slot is free */
+    int seqid;			/* sequential message ID, -1 if none */
+    int nfrags;			/* number of parts in the sequence */
     int decoded_frags;		/* for tracking AIDVM parts in a multipart sequence */
-    unsigned char bits[2048];
+    unsigned long stamp;	/* sentence clock when last extended */
+    bool checksum_bad;		/* some fragment failed its checksum */
+    bool filtered;		/* the first part failed the prefilter */
     size_t bitlen; /* how many valid bits */
-    struct ais_type24_queue_t type24_queue;
+    /* the slack lets de-armoring store whole vector registers */
+    unsigned char bits[AIVDM_MAX_BITS / 8 + 32];
 };
 
 #define AIVDM_CHANNELS	2
+#define AIVDM_PARTIALS	16	/* multipart messages reassembled at once */
+#define AIVDM_PARTIAL_TIMEOUT	1024	/* sentences before a partial expires */
+
+/* what aivdm_decode() does with a sentence failing its NMEA checksum */
+enum aivdm_checksum_t {
+    checksum_ignore,		/* don't check it (the default) */
+    checksum_flag,		/* decode it, but flag it: see ais_checksum_bad */
+    checksum_reject,		/* discard it */
+};
+
+/*
+ * Groups of fields ais_binary_decode_fields() can leave out.  A group
+ * that is not decoded costs no bit extraction, and its fields stay
+ * zeroed.  The header (type, repeat, mmsi) and whatever is needed to
+ * check a message's length are always decoded.
+ */
+#define AIS_FIELDS_POSITION	0x001	/* lon, lat, accuracy, raim */
+#define AIS_FIELDS_MOTION	0x002	/* speed, course, heading, turn, alt */
+#define AIS_FIELDS_TIME		0x004	/* UTC second, type 4/11 date and time */
+#define AIS_FIELDS_STATUS	0x008	/* status, maneuver, epfd, flags */
+#define AIS_FIELDS_RADIO	0x010	/* radio status */
+#define AIS_FIELDS_STATIC	0x020	/* ship type, dimensions, voyage data */
+#define AIS_FIELDS_TEXT		0x040	/* six-bit strings: names, callsigns */
+#define AIS_FIELDS_BINARY	0x080	/* dac/fid, application data, payloads */
+#define AIS_FIELDS_LINK		0x100	/* addressing, acks, link management */
+#define AIS_FIELDS_ALL		0x1ff
+/* what a track-only job wants */
+#define AIS_FIELDS_TRACK	(AIS_FIELDS_POSITION|AIS_FIELDS_MOTION|AIS_FIELDS_TIME)
+
+/* what became of one sentence handed to aivdm_decode_status() */
+enum aivdm_status_t {
+    aivdm_decoded,		/* completed a message, now in the ais_t */
+    aivdm_pending,		/* fragment stored, more parts to come */
+    aivdm_empty,		/* blank line */
+    aivdm_malformed,		/* overlong, too few fields, bad part numbers */
+    aivdm_bad_checksum,		/* failed the checksum under checksum_reject */
+    aivdm_bad_channel,		/* channel C, '12' or garbage */
+    aivdm_orphan,		/* later part with no sequence to extend */
+    aivdm_bad_payload,		/* invalid armoring or overlong payload */
+    aivdm_undecodable,		/* ais_binary_decode() refused the bits */
+    aivdm_filtered,		/* dropped by the header prefilter */
+};
+
+struct ais_mmsi_set_t;		/* see ais_mmsi.h */
+
+/*
+ * Header prefilter.  The message type and MMSI are read from the first
+ * seven armored characters of a message's first sentence, and a message
+ * failing either test is dropped before anything else is dearmored;
+ * later parts of a dropped multipart message are dropped unread.  A
+ * first sentence too short to judge is let through, and its message
+ * filtered once decoded, its sentences then being counted as skipped
+ * rather than matched.  A zeroed filter admits everything.
+ */
+struct aivdm_filter_t {
+    unsigned long types;	/* bit n admits type n; 0 admits all types */
+    /*@null@*/const struct ais_mmsi_set_t *mmsi;	/* watchlist, or NULL */
+};
+
+/* counters maintained by aivdm_decode() */
+#define AIVDM_TYPES	64	/* the message type is six bits */
+
+struct aivdm_stats_t {
+    unsigned long sentences;		/* sentences seen; the partials' clock */
+    unsigned long checksum_errors;	/* sentences failing the checksum */
+    unsigned long bad_channel;		/* sentences on a channel not A or B */
+    unsigned long partials_dropped;	/* evicted, restarted or broken */
+    unsigned long partials_expired;	/* not completed within the timeout */
+    unsigned long filter_matched;	/* sentences passed by the filter */
+    unsigned long filter_skipped;	/* sentences dropped by it */
+    unsigned long decoded;		/* messages completed */
+    unsigned long types[AIVDM_TYPES];	/* messages completed, by type */
+};
 
 struct gps_device_t {
     union {
         struct {
-            struct aivdm_context_t context[AIVDM_CHANNELS];
+            struct aivdm_context_t single;	/* one-sentence messages */
+            /* multipart messages, keyed by channel, sequence ID and length */
+            struct aivdm_context_t partial[AIVDM_PARTIALS];
+            struct ais_type24_queue_t type24_queue[AIVDM_CHANNELS];
         char    ais_channel;
+            enum aivdm_checksum_t checksum;	/* checksum policy */
+            unsigned int skip_fields;	/* AIS_FIELDS_* groups not decoded */
+            struct aivdm_filter_t filter;	/* header prefilter */
+            bool ais_checksum_bad;	/* last message had a bad checksum;
+					 * batches copy it to checksum_bad[] */
+            struct aivdm_stats_t stats;
         } aivdm;
     } driver;
 };
@@ -15,6 +15,7 @@ PERMISSIONS
 ***************************************************************************/
 
 #include <stdio.h>
+#include <stdarg.h>
 #include <math.h>
 #include <assert.h>
 #include <string.h>
@@ -27,6 +28,11 @@ PERMISSIONS
 
 #define JSON_BOOL(x)	((x)?"true":"false")
 
+/* characters that go into a JSON string unescaped */
+#define JSON_PLAIN(c)	(isascii((unsigned char)(c)) \
+			 && !iscntrl((unsigned char)(c)) \
+			 && (c) != '"' && (c) != '\\')
+
 char *json_stringify( /*@out@*/ char *to,
 		     size_t len,
 		     /*@in@*/ const char *from)
@@ -43,6 +49,16 @@ char *json_stringify( /*@out@*/ char *to,
      * escape
      */
     for (sp = from; *sp != '\0' && ((tp - to) < ((int)len - 6)); sp++) {
+	/* most strings need no escaping at all; copy runs in one go */
+	const char *run = sp;
+	size_t room = (size_t)((int)len - 6 - (tp - to));
+
+	while ((size_t)(sp - run) < room && JSON_PLAIN(*sp))
+	    sp++;
+	(void)memcpy(tp, run, (size_t)(sp - run));
+	tp += sp - run;
+	if (*sp == '\0' || (tp - to) >= ((int)len - 6))
+	    break;
 	if (!isascii((unsigned char) *sp) || iscntrl((unsigned char) *sp)) {
 	    *tp++ = '\\';
 	    switch (*sp) {
@@ -81,618 +97,798 @@ char *json_stringify( /*@out@*/ char *to,
     /*@+temptrans@*/
 }
 
-void json_aivdm_dump(const struct ais_t *ais,
-                     /*@null@*/const char *device, bool scaled,
-                     /*@out@*/char *buf, size_t buflen)
+/*
+ * Output cursor for the dump functions.  Keeping track of the end of
+ * the text saves rescanning the whole buffer with strlen() on every
+ * append.  Overflowing text is cut off just as snprintf(3) would.
+ */
+struct json_cursor_t {
+    char *buf;
+    size_t len;			/* characters so far, excluding the NUL */
+    size_t size;		/* size of buf */
+    bool truncated;
+};
+
+# if __GNUC__ >= 3 || (__GNUC__ == 2 && __GNUC_MINOR__ >= 7)
+__attribute__((__format__(__printf__, 2, 3)))
+#endif
+static void json_printf(struct json_cursor_t *out, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = vsnprintf(out->buf + out->len, out->size - out->len, fmt, ap);
+    va_end(ap);
+    if (n < 0)
+	return;
+    if ((size_t)n >= out->size - out->len) {
+	out->len = out->size - 1;
+	out->truncated = true;
+    } else
+	out->len += (size_t)n;
+}
+
+static void json_write(struct json_cursor_t *out, const char *str, size_t n)
+{
+    if (n >= out->size - out->len) {
+	n = out->size - out->len - 1;
+	out->truncated = true;
+    }
+    (void)memcpy(out->buf + out->len, str, n);
+    out->len += n;
+    out->buf[out->len] = '\0';
+}
+
+static void json_puts(struct json_cursor_t *out, const char *str)
+{
+    json_write(out, str, strlen(str));
+}
+
+/* for string literals, whose length is known at compile time */
+#define json_lit(out, str)	json_write(out, str, sizeof(str) - 1)
+
+/*
+ * Legend strings are kept quoted, and escaped where they need it, so
+ * they go into the report with a single copy.
+ */
+struct json_legend_t {
+    const char *text;
+    size_t len;
+};
+#define JSON_LEGEND(str)	{"\"" str "\"", sizeof(str) + 1}
+#define JSON_LEGEND_AT(table, n, invalid) \
+	(((n) < (unsigned int)NITEMS(table)) ? &(table)[n] \
+	 : &(const struct json_legend_t)JSON_LEGEND(invalid))
+
+static void json_legend(struct json_cursor_t *out,
+			const struct json_legend_t *legend)
+{
+    json_write(out, legend->text, legend->len);
+}
+
+/*
+ * Number formatting for the hot report types, without going through
+ * printf.  Each produces exactly what the corresponding %u, %0Nu, %d
+ * or %.Nf conversion would.
+ */
+static void json_uint0(struct json_cursor_t *out, unsigned int val, int width)
+/* %0*u */
+{
+    char tmp[16], *tp = tmp + sizeof(tmp);
+
+    do {
+	*--tp = (char)('0' + val % 10);
+	val /= 10;
+    } while (val != 0);
+    while (tmp + sizeof(tmp) - tp < width)
+	*--tp = '0';
+    json_write(out, tp, (size_t)(tmp + sizeof(tmp) - tp));
+}
+
+static void json_uint(struct json_cursor_t *out, unsigned int val)
+{
+    json_uint0(out, val, 1);
+}
+
+static void json_int(struct json_cursor_t *out, int val)
+{
+    if (val < 0) {
+	json_lit(out, "-");
+	json_uint(out, 0U - (unsigned int)val);
+    } else
+	json_uint(out, (unsigned int)val);
+}
+
+static void json_fixed(struct json_cursor_t *out,
+		       int val, unsigned int per, int places, double dval)
+/*
+ * %.*f of dval, which is val / (per * 10^places).  Rounding val / per
+ * to the nearest integer gives the digits; only an exact half is left
+ * to printf, since there the binary value of dval decides.
+ */
+{
+    char tmp[24], *tp = tmp + sizeof(tmp);
+    unsigned int mag = val < 0 ? 0U - (unsigned int)val : (unsigned int)val;
+    unsigned int q = mag / per, r = mag % per;
+    int i;
+
+    if (2 * r == per) {
+	json_printf(out, "%.*f", places, dval);
+	return;
+    }
+    if (2 * r > per)
+	q++;
+    for (i = 0; i < places; i++) {
+	*--tp = (char)('0' + q % 10);
+	q /= 10;
+    }
+    if (places > 0)
+	*--tp = '.';
+    do {
+	*--tp = (char)('0' + q % 10);
+	q /= 10;
+    } while (q != 0);
+    if (val < 0)
+	*--tp = '-';
+    json_write(out, tp, (size_t)(tmp + sizeof(tmp) - tp));
+}
+
+static void json_chomp(struct json_cursor_t *out)
+/* drop the comma after the last of a run of optional members */
+{
+    if (out->len > 0 && out->buf[out->len - 1] == ',')
+	out->buf[--out->len] = '\0';
+}
+
+static const struct json_legend_t nav_legends[] = {
+    JSON_LEGEND("Under way using engine"),
+    JSON_LEGEND("At anchor"),
+    JSON_LEGEND("Not under command"),
+    JSON_LEGEND("Restricted manoeuverability"),
+    JSON_LEGEND("Constrained by her draught"),
+    JSON_LEGEND("Moored"),
+    JSON_LEGEND("Aground"),
+    JSON_LEGEND("Engaged in fishing"),
+    JSON_LEGEND("Under way sailing"),
+    JSON_LEGEND("Reserved for HSC"),
+    JSON_LEGEND("Reserved for WIG"),
+    JSON_LEGEND("Reserved"),
+    JSON_LEGEND("Reserved"),
+    JSON_LEGEND("Reserved"),
+    JSON_LEGEND("Reserved"),
+    JSON_LEGEND("Not defined"),
+};
+
+static const struct json_legend_t epfd_legends[] = {
+    JSON_LEGEND("Undefined"),
+    JSON_LEGEND("GPS"),
+    JSON_LEGEND("GLONASS"),
+    JSON_LEGEND("Combined GPS/GLONASS"),
+    JSON_LEGEND("Loran-C"),
+    JSON_LEGEND("Chayka"),
+    JSON_LEGEND("Integrated navigation system"),
+    JSON_LEGEND("Surveyed"),
+    JSON_LEGEND("Galileo"),
+};
+
+#define EPFD_DISPLAY(n) JSON_LEGEND_AT(epfd_legends, n, "INVALID EPFD")
+
+static const struct json_legend_t ship_type_legends[100] = {
+    JSON_LEGEND("Not available"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Wing in ground (WIG) - all ships of this type"),
+    JSON_LEGEND("Wing in ground (WIG) - Hazardous category A"),
+    JSON_LEGEND("Wing in ground (WIG) - Hazardous category B"),
+    JSON_LEGEND("Wing in ground (WIG) - Hazardous category C"),
+    JSON_LEGEND("Wing in ground (WIG) - Hazardous category D"),
+    JSON_LEGEND("Wing in ground (WIG) - Reserved for future use"),
+    JSON_LEGEND("Wing in ground (WIG) - Reserved for future use"),
+    JSON_LEGEND("Wing in ground (WIG) - Reserved for future use"),
+    JSON_LEGEND("Wing in ground (WIG) - Reserved for future use"),
+    JSON_LEGEND("Wing in ground (WIG) - Reserved for future use"),
+    JSON_LEGEND("Fishing"),
+    JSON_LEGEND("Towing"),
+    JSON_LEGEND("Towing: length exceeds 200m or breadth exceeds 25m"),
+    JSON_LEGEND("Dredging or underwater ops"),
+    JSON_LEGEND("Diving ops"),
+    JSON_LEGEND("Military ops"),
+    JSON_LEGEND("Sailing"),
+    JSON_LEGEND("Pleasure Craft"),
+    JSON_LEGEND("Reserved"),
+    JSON_LEGEND("Reserved"),
+    JSON_LEGEND("High speed craft (HSC) - all ships of this type"),
+    JSON_LEGEND("High speed craft (HSC) - Hazardous category A"),
+    JSON_LEGEND("High speed craft (HSC) - Hazardous category B"),
+    JSON_LEGEND("High speed craft (HSC) - Hazardous category C"),
+    JSON_LEGEND("High speed craft (HSC) - Hazardous category D"),
+    JSON_LEGEND("High speed craft (HSC) - Reserved for future use"),
+    JSON_LEGEND("High speed craft (HSC) - Reserved for future use"),
+    JSON_LEGEND("High speed craft (HSC) - Reserved for future use"),
+    JSON_LEGEND("High speed craft (HSC) - Reserved for future use"),
+    JSON_LEGEND("High speed craft (HSC) - No additional information"),
+    JSON_LEGEND("Pilot Vessel"),
+    JSON_LEGEND("Search and Rescue vessel"),
+    JSON_LEGEND("Tug"),
+    JSON_LEGEND("Port Tender"),
+    JSON_LEGEND("Anti-pollution equipment"),
+    JSON_LEGEND("Law Enforcement"),
+    JSON_LEGEND("Spare - Local Vessel"),
+    JSON_LEGEND("Spare - Local Vessel"),
+    JSON_LEGEND("Medical Transport"),
+    JSON_LEGEND("Ship according to RR Resolution No. 18"),
+    JSON_LEGEND("Passenger - all ships of this type"),
+    JSON_LEGEND("Passenger - Hazardous category A"),
+    JSON_LEGEND("Passenger - Hazardous category B"),
+    JSON_LEGEND("Passenger - Hazardous category C"),
+    JSON_LEGEND("Passenger - Hazardous category D"),
+    JSON_LEGEND("Passenger - Reserved for future use"),
+    JSON_LEGEND("Passenger - Reserved for future use"),
+    JSON_LEGEND("Passenger - Reserved for future use"),
+    JSON_LEGEND("Passenger - Reserved for future use"),
+    JSON_LEGEND("Passenger - No additional information"),
+    JSON_LEGEND("Cargo - all ships of this type"),
+    JSON_LEGEND("Cargo - Hazardous category A"),
+    JSON_LEGEND("Cargo - Hazardous category B"),
+    JSON_LEGEND("Cargo - Hazardous category C"),
+    JSON_LEGEND("Cargo - Hazardous category D"),
+    JSON_LEGEND("Cargo - Reserved for future use"),
+    JSON_LEGEND("Cargo - Reserved for future use"),
+    JSON_LEGEND("Cargo - Reserved for future use"),
+    JSON_LEGEND("Cargo - Reserved for future use"),
+    JSON_LEGEND("Cargo - No additional information"),
+    JSON_LEGEND("Tanker - all ships of this type"),
+    JSON_LEGEND("Tanker - Hazardous category A"),
+    JSON_LEGEND("Tanker - Hazardous category B"),
+    JSON_LEGEND("Tanker - Hazardous category C"),
+    JSON_LEGEND("Tanker - Hazardous category D"),
+    JSON_LEGEND("Tanker - Reserved for future use"),
+    JSON_LEGEND("Tanker - Reserved for future use"),
+    JSON_LEGEND("Tanker - Reserved for future use"),
+    JSON_LEGEND("Tanker - Reserved for future use"),
+    JSON_LEGEND("Tanker - No additional information"),
+    JSON_LEGEND("Other Type - all ships of this type"),
+    JSON_LEGEND("Other Type - Hazardous category A"),
+    JSON_LEGEND("Other Type - Hazardous category B"),
+    JSON_LEGEND("Other Type - Hazardous category C"),
+    JSON_LEGEND("Other Type - Hazardous category D"),
+    JSON_LEGEND("Other Type - Reserved for future use"),
+    JSON_LEGEND("Other Type - Reserved for future use"),
+    JSON_LEGEND("Other Type - Reserved for future use"),
+    JSON_LEGEND("Other Type - Reserved for future use"),
+    JSON_LEGEND("Other Type - no additional information"),
+};
+
+#define SHIPTYPE_DISPLAY(n) JSON_LEGEND_AT(ship_type_legends, n, "INVALID SHIP TYPE")
+
+static const struct json_legend_t station_type_legends[] = {
+    JSON_LEGEND("All types of mobiles"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("All types of Class B mobile stations"),
+    JSON_LEGEND("SAR airborne mobile station"),
+    JSON_LEGEND("Aid to Navigation station"),
+    JSON_LEGEND("Class B shipborne mobile station"),
+    JSON_LEGEND("Regional use and inland waterways"),
+    JSON_LEGEND("Regional use and inland waterways"),
+    JSON_LEGEND("Regional use and inland waterways"),
+    JSON_LEGEND("Regional use and inland waterways"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+    JSON_LEGEND("Reserved for future use"),
+};
+
+#define STATIONTYPE_DISPLAY(n) JSON_LEGEND_AT(station_type_legends, n, "INVALID STATION TYPE")
+
+static const struct json_legend_t navaid_type_legends[] = {
+    JSON_LEGEND("Unspecified"),
+    JSON_LEGEND("Reference point"),
+    JSON_LEGEND("RACON"),
+    JSON_LEGEND("Fixed offshore structure"),
+    JSON_LEGEND("Spare, Reserved for future use."),
+    JSON_LEGEND("Light, without sectors"),
+    JSON_LEGEND("Light, with sectors"),
+    JSON_LEGEND("Leading Light Front"),
+    JSON_LEGEND("Leading Light Rear"),
+    JSON_LEGEND("Beacon, Cardinal N"),
+    JSON_LEGEND("Beacon, Cardinal E"),
+    JSON_LEGEND("Beacon, Cardinal S"),
+    JSON_LEGEND("Beacon, Cardinal W"),
+    JSON_LEGEND("Beacon, Port hand"),
+    JSON_LEGEND("Beacon, Starboard hand"),
+    JSON_LEGEND("Beacon, Preferred Channel port hand"),
+    JSON_LEGEND("Beacon, Preferred Channel starboard hand"),
+    JSON_LEGEND("Beacon, Isolated danger"),
+    JSON_LEGEND("Beacon, Safe water"),
+    JSON_LEGEND("Beacon, Special mark"),
+    JSON_LEGEND("Cardinal Mark N"),
+    JSON_LEGEND("Cardinal Mark E"),
+    JSON_LEGEND("Cardinal Mark S"),
+    JSON_LEGEND("Cardinal Mark W"),
+    JSON_LEGEND("Port hand Mark"),
+    JSON_LEGEND("Starboard hand Mark"),
+    JSON_LEGEND("Preferred Channel Port hand"),
+    JSON_LEGEND("Preferred Channel Starboard hand"),
+    JSON_LEGEND("Isolated danger"),
+    JSON_LEGEND("Safe Water"),
+    JSON_LEGEND("Special Mark"),
+    JSON_LEGEND("Light Vessel / LANBY / Rigs"),
+};
+
+#define NAVAIDTYPE_DISPLAY(n) JSON_LEGEND_AT(navaid_type_legends, n, "INVALID NAVAID TYPE")
+
+/*
+ * The legend tables above, for consumers that build reports of their
+ * own; the n-th text, quoted as in reports, or the table's INVALID text
+ * for an n past its end.
+ */
+const char *json_ais_legend(enum json_ais_legend_t table, unsigned int n,
+			    size_t *len)
+{
+    /* the INVALID texts are temporaries, gone when the block ends */
+#define LEGEND_RETURN(legend) \
+    do { \
+	const struct json_legend_t *lp = (legend); \
+	*len = lp->len; \
+	return lp->text; \
+    } while (0)
+    switch (table) {
+    case legend_nav:
+	LEGEND_RETURN(JSON_LEGEND_AT(nav_legends, n, "INVALID STATUS"));
+    case legend_epfd:
+	LEGEND_RETURN(EPFD_DISPLAY(n));
+    case legend_shiptype:
+	LEGEND_RETURN(SHIPTYPE_DISPLAY(n));
+    case legend_stationtype:
+	LEGEND_RETURN(STATIONTYPE_DISPLAY(n));
+    default:
+	LEGEND_RETURN(NAVAIDTYPE_DISPLAY(n));
+    }
+#undef LEGEND_RETURN
+}
+
+/* number of entries in a legend table, excluding its INVALID text */
+unsigned int json_ais_legend_count(enum json_ais_legend_t table)
+{
+    switch (table) {
+    case legend_nav:
+	return (unsigned int)NITEMS(nav_legends);
+    case legend_epfd:
+	return (unsigned int)NITEMS(epfd_legends);
+    case legend_shiptype:
+	return (unsigned int)NITEMS(ship_type_legends);
+    case legend_stationtype:
+	return (unsigned int)NITEMS(station_type_legends);
+    default:
+	return (unsigned int)NITEMS(navaid_type_legends);
+    }
+}
+
+size_t json_aivdm_dump(const struct ais_t *ais,
+                       /*@null@*/const char *device, bool scaled,
+                       /*@out@*/char *buf, size_t buflen)
+/* returns the length of the report, or buflen if it didn't fit */
 {
+    struct json_cursor_t out = {buf, 0, buflen, false};
     char buf1[JSON_VAL_MAX * 2 + 1];
     char buf2[JSON_VAL_MAX * 2 + 1];
     char buf3[JSON_VAL_MAX * 2 + 1];
     char scratchbuf[MAX_PACKET_LENGTH*2+1];
     int i;
     
-    static char *nav_legends[] = {
-        "Under way using engine",
-        "At anchor",
-        "Not under command",
-        "Restricted manoeuverability",
-        "Constrained by her draught",
-        "Moored",
-        "Aground",
-        "Engaged in fishing",
-        "Under way sailing",
-        "Reserved for HSC",
-        "Reserved for WIG",
-        "Reserved",
-        "Reserved",
-        "Reserved",
-        "Reserved",
-        "Not defined",
-    };
-    
-    static char *epfd_legends[] = {
-        "Undefined",
-        "GPS",
-        "GLONASS",
-        "Combined GPS/GLONASS",
-        "Loran-C",
-        "Chayka",
-        "Integrated navigation system",
-        "Surveyed",
-        "Galileo",
-    };
-    
-#define EPFD_DISPLAY(n) (((n) < (unsigned int)NITEMS(epfd_legends)) ? epfd_legends[n] : "INVALID EPFD")
-    
-    static char *ship_type_legends[100] = {
-        "Not available",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Wing in ground (WIG) - all ships of this type",
-        "Wing in ground (WIG) - Hazardous category A",
-        "Wing in ground (WIG) - Hazardous category B",
-        "Wing in ground (WIG) - Hazardous category C",
-        "Wing in ground (WIG) - Hazardous category D",
-        "Wing in ground (WIG) - Reserved for future use",
-        "Wing in ground (WIG) - Reserved for future use",
-        "Wing in ground (WIG) - Reserved for future use",
-        "Wing in ground (WIG) - Reserved for future use",
-        "Wing in ground (WIG) - Reserved for future use",
-        "Fishing",
-        "Towing",
-        "Towing: length exceeds 200m or breadth exceeds 25m",
-        "Dredging or underwater ops",
-        "Diving ops",
-        "Military ops",
-        "Sailing",
-        "Pleasure Craft",
-        "Reserved",
-        "Reserved",
-        "High speed craft (HSC) - all ships of this type",
-        "High speed craft (HSC) - Hazardous category A",
-        "High speed craft (HSC) - Hazardous category B",
-        "High speed craft (HSC) - Hazardous category C",
-        "High speed craft (HSC) - Hazardous category D",
-        "High speed craft (HSC) - Reserved for future use",
-        "High speed craft (HSC) - Reserved for future use",
-        "High speed craft (HSC) - Reserved for future use",
-        "High speed craft (HSC) - Reserved for future use",
-        "High speed craft (HSC) - No additional information",
-        "Pilot Vessel",
-        "Search and Rescue vessel",
-        "Tug",
-        "Port Tender",
-        "Anti-pollution equipment",
-        "Law Enforcement",
-        "Spare - Local Vessel",
-        "Spare - Local Vessel",
-        "Medical Transport",
-        "Ship according to RR Resolution No. 18",
-        "Passenger - all ships of this type",
-        "Passenger - Hazardous category A",
-        "Passenger - Hazardous category B",
-        "Passenger - Hazardous category C",
-        "Passenger - Hazardous category D",
-        "Passenger - Reserved for future use",
-        "Passenger - Reserved for future use",
-        "Passenger - Reserved for future use",
-        "Passenger - Reserved for future use",
-        "Passenger - No additional information",
-        "Cargo - all ships of this type",
-        "Cargo - Hazardous category A",
-        "Cargo - Hazardous category B",
-        "Cargo - Hazardous category C",
-        "Cargo - Hazardous category D",
-        "Cargo - Reserved for future use",
-        "Cargo - Reserved for future use",
-        "Cargo - Reserved for future use",
-        "Cargo - Reserved for future use",
-        "Cargo - No additional information",
-        "Tanker - all ships of this type",
-        "Tanker - Hazardous category A",
-        "Tanker - Hazardous category B",
-        "Tanker - Hazardous category C",
-        "Tanker - Hazardous category D",
-        "Tanker - Reserved for future use",
-        "Tanker - Reserved for future use",
-        "Tanker - Reserved for future use",
-        "Tanker - Reserved for future use",
-        "Tanker - No additional information",
-        "Other Type - all ships of this type",
-        "Other Type - Hazardous category A",
-        "Other Type - Hazardous category B",
-        "Other Type - Hazardous category C",
-        "Other Type - Hazardous category D",
-        "Other Type - Reserved for future use",
-        "Other Type - Reserved for future use",
-        "Other Type - Reserved for future use",
-        "Other Type - Reserved for future use",
-        "Other Type - no additional information",
-    };
-    
-#define SHIPTYPE_DISPLAY(n) (((n) < (unsigned int)NITEMS(ship_type_legends)) ? ship_type_legends[n] : "INVALID SHIP TYPE")
-    
-    static const char *station_type_legends[] = {
-        "All types of mobiles",
-        "Reserved for future use",
-        "All types of Class B mobile stations",
-        "SAR airborne mobile station",
-        "Aid to Navigation station",
-        "Class B shipborne mobile station",
-        "Regional use and inland waterways",
-        "Regional use and inland waterways",
-        "Regional use and inland waterways",
-        "Regional use and inland waterways",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-        "Reserved for future use",
-    };
-    
-#define STATIONTYPE_DISPLAY(n) (((n) < (unsigned int)NITEMS(station_type_legends)) ? station_type_legends[n] : "INVALID STATION TYPE")
-    
-    static const char *navaid_type_legends[] = {
-        "Unspecified",
-        "Reference point",
-        "RACON",
-        "Fixed offshore structure",
-        "Spare, Reserved for future use.",
-        "Light, without sectors",
-        "Light, with sectors",
-        "Leading Light Front",
-        "Leading Light Rear",
-        "Beacon, Cardinal N",
-        "Beacon, Cardinal E",
-        "Beacon, Cardinal S",
-        "Beacon, Cardinal W",
-        "Beacon, Port hand",
-        "Beacon, Starboard hand",
-        "Beacon, Preferred Channel port hand",
-        "Beacon, Preferred Channel starboard hand",
-        "Beacon, Isolated danger",
-        "Beacon, Safe water",
-        "Beacon, Special mark",
-        "Cardinal Mark N",
-        "Cardinal Mark E",
-        "Cardinal Mark S",
-        "Cardinal Mark W",
-        "Port hand Mark",
-        "Starboard hand Mark",
-        "Preferred Channel Port hand",
-        "Preferred Channel Starboard hand",
-        "Isolated danger",
-        "Safe Water",
-        "Special Mark",
-        "Light Vessel / LANBY / Rigs",
-    };
-    
-#define NAVAIDTYPE_DISPLAY(n) (((n) < (unsigned int)NITEMS(navaid_type_legends[0])) ? navaid_type_legends[n] : "INVALID NAVAID TYPE")
-    
     // cppcheck-suppress variableScope
-    static const char *signal_legends[] = {
-        "N/A",
-        "Serious emergency – stop or divert according to instructions.",
-        "Vessels shall not proceed.",
-        "Vessels may proceed. One way traffic.",
-        "Vessels may proceed. Two way traffic.",
-        "Vessels shall proceed on specific orders only.",
-        "Vessels in main channel shall not proceed."
-        "Vessels in main channel shall proceed on specific orders only.",
-        "Vessels in main channel shall proceed on specific orders only.",
-        "I = \"in-bound\" only acceptable.",
-        "O = \"out-bound\" only acceptable.",
-        "F = both \"in- and out-bound\" acceptable.",
-        "XI = Code will shift to \"I\" in due time.",
-        "XO = Code will shift to \"O\" in due time.",
-        "X = Vessels shall proceed only on direction.",
+    static const struct json_legend_t signal_legends[] = {
+        JSON_LEGEND("N/A"),
+        JSON_LEGEND("Serious emergency – stop or divert according to instructions."),
+        JSON_LEGEND("Vessels shall not proceed."),
+        JSON_LEGEND("Vessels may proceed. One way traffic."),
+        JSON_LEGEND("Vessels may proceed. Two way traffic."),
+        JSON_LEGEND("Vessels shall proceed on specific orders only."),
+        JSON_LEGEND("Vessels in main channel shall not proceed."
+                    "Vessels in main channel shall proceed on specific orders only."),
+        JSON_LEGEND("Vessels in main channel shall proceed on specific orders only."),
+        JSON_LEGEND("I = \\\"in-bound\\\" only acceptable."),
+        JSON_LEGEND("O = \\\"out-bound\\\" only acceptable."),
+        JSON_LEGEND("F = both \\\"in- and out-bound\\\" acceptable."),
+        JSON_LEGEND("XI = Code will shift to \\\"I\\\" in due time."),
+        JSON_LEGEND("XO = Code will shift to \\\"O\\\" in due time."),
+        JSON_LEGEND("X = Vessels shall proceed only on direction."),
     };
     
-#define SIGNAL_DISPLAY(n) (((n) < (unsigned int)NITEMS(signal_legends[0])) ? signal_legends[n] : "INVALID SIGNAL TYPE")
+#define SIGNAL_DISPLAY(n) JSON_LEGEND_AT(signal_legends, n, "INVALID SIGNAL TYPE")
     
-    static const char *route_type[32] = {
-        "Undefined (default)",
-        "Mandatory",
-        "Recommended",
-        "Alternative",
-        "Recommended route through ice",
-        "Ship route plan",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Reserved for future use.",
-        "Cancel route identified by message linkage",
+    static const struct json_legend_t route_type[32] = {
+        JSON_LEGEND("Undefined (default)"),
+        JSON_LEGEND("Mandatory"),
+        JSON_LEGEND("Recommended"),
+        JSON_LEGEND("Alternative"),
+        JSON_LEGEND("Recommended route through ice"),
+        JSON_LEGEND("Ship route plan"),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Reserved for future use."),
+        JSON_LEGEND("Cancel route identified by message linkage"),
     };
     
     // cppcheck-suppress variableScope
-    static const char *idtypes[] = {
-        "mmsi",
-        "imo",
-        "callsign",
-        "other",
+    static const struct json_legend_t idtypes[] = {
+        JSON_LEGEND("mmsi"),
+        JSON_LEGEND("imo"),
+        JSON_LEGEND("callsign"),
+        JSON_LEGEND("other"),
     };
     
     // cppcheck-suppress variableScope
-    static const char *racon_status[] = {
-        "No RACON installed",
-        "RACON not monitored",
-        "RACON operational",
-        "RACON ERROR"
+    static const struct json_legend_t racon_status[] = {
+        JSON_LEGEND("No RACON installed"),
+        JSON_LEGEND("RACON not monitored"),
+        JSON_LEGEND("RACON operational"),
+        JSON_LEGEND("RACON ERROR")
     };
     
     // cppcheck-suppress variableScope
-    static const char *light_status[] = {
-        "No light or no monitoring",
-        "Light ON",
-        "Light OFF",
-        "Light ERROR"
+    static const struct json_legend_t light_status[] = {
+        JSON_LEGEND("No light or no monitoring"),
+        JSON_LEGEND("Light ON"),
+        JSON_LEGEND("Light OFF"),
+        JSON_LEGEND("Light ERROR")
     };
     
     // cppcheck-suppress variableScope
-    static const char *rta_status[] = {
-        "Operational",
-        "Limited operation",
-        "Out of order",
-        "N/A",
+    static const struct json_legend_t rta_status[] = {
+        JSON_LEGEND("Operational"),
+        JSON_LEGEND("Limited operation"),
+        JSON_LEGEND("Out of order"),
+        JSON_LEGEND("N/A"),
     };
     
     // cppcheck-suppress variableScope
-    const char *position_types[8] = {
-        "Not available",
-        "Port-side to",
-        "Starboard-side to",
-        "Mediterranean (end-on) mooring",
-        "Mooring buoy",
-        "Anchorage",
-        "Reserved for future use",
-        "Reserved for future use",
+    static const struct json_legend_t position_types[8] = {
+        JSON_LEGEND("Not available"),
+        JSON_LEGEND("Port-side to"),
+        JSON_LEGEND("Starboard-side to"),
+        JSON_LEGEND("Mediterranean (end-on) mooring"),
+        JSON_LEGEND("Mooring buoy"),
+        JSON_LEGEND("Anchorage"),
+        JSON_LEGEND("Reserved for future use"),
+        JSON_LEGEND("Reserved for future use"),
     };
     
-    (void)snprintf(buf, buflen, "{\"class\":\"AIS\",");
+    if (buflen == 0)
+        return 0;
+    json_printf(&out, "{\"class\":\"AIS\",");
     if (device != NULL && device[0] != '\0')
-        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                       "\"device\":\"%s\",", device);
-    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                   "\"type\":%u,\"repeat\":%u,\"mmsi\":%u,\"scaled\":%s,",
-                   ais->type, ais->repeat, ais->mmsi, JSON_BOOL(scaled));
+        json_printf(&out,
+                    "\"device\":\"%s\",", device);
+    json_lit(&out, "\"type\":");
+    json_uint(&out, ais->type);
+    json_lit(&out, ",\"repeat\":");
+    json_uint(&out, ais->repeat);
+    json_lit(&out, ",\"mmsi\":");
+    json_uint(&out, ais->mmsi);
+    json_lit(&out, ",\"scaled\":");
+    json_puts(&out, JSON_BOOL(scaled));
+    json_lit(&out, ",");
     /*@ -formatcode -mustfreefresh @*/
     switch (ais->type) {
         case 1:			/* Position Report */
         case 2:
         case 3:
+            json_lit(&out, "\"status\":");
+            if (scaled)
+                json_lit(&out, "\"");
+            json_uint(&out, ais->type1.status);
+            if (scaled)
+                json_lit(&out, "\"");
+            json_lit(&out, ",\"status_text\":");
+            json_legend(&out, &nav_legends[ais->type1.status]);
+            json_lit(&out, ",\"turn\":");
             if (scaled) {
-                char turnlegend[20];
-                char speedlegend[20];
-                
                 /*
                  * Express turn as nan if not available,
                  * "fastleft"/"fastright" for fast turns.
                  */
                 if (ais->type1.turn == -128)
-                    (void)strlcpy(turnlegend, "\"nan\"", sizeof(turnlegend));
+                    json_lit(&out, "\"nan\"");
                 else if (ais->type1.turn == -127)
-                    (void)strlcpy(turnlegend, "\"fastleft\"", sizeof(turnlegend));
+                    json_lit(&out, "\"fastleft\"");
                 else if (ais->type1.turn == 127)
-                    (void)strlcpy(turnlegend, "\"fastright\"",
-                                  sizeof(turnlegend));
+                    json_lit(&out, "\"fastright\"");
                 else {
                     double rot1 = ais->type1.turn / 4.733;
-                    (void)snprintf(turnlegend, sizeof(turnlegend),
-                                   "%.0f", rot1 * rot1);
+                    /* rounds half to even, like %.0f */
+                    json_uint(&out, (unsigned int)nearbyint(rot1 * rot1));
                 }
                 
                 /*
                  * Express speed as nan if not available,
                  * "fast" for fast movers.
                  */
+                json_lit(&out, ",\"speed\":");
                 if (ais->type1.speed == AIS_SPEED_NOT_AVAILABLE)
-                    (void)strlcpy(speedlegend, "\"nan\"", sizeof(speedlegend));
+                    json_lit(&out, "\"nan\"");
                 else if (ais->type1.speed == AIS_SPEED_FAST_MOVER)
-                    (void)strlcpy(speedlegend, "\"fast\"", sizeof(speedlegend));
+                    json_lit(&out, "\"fast\"");
                 else
-                    (void)snprintf(speedlegend, sizeof(speedlegend),
-                                   "%.1f", ais->type1.speed / 10.0);
-                
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"status\":\"%u\",\"status_text\":\"%s\","
-                               "\"turn\":%s,\"speed\":%s,"
-                               "\"accuracy\":%s,\"lon\":%.4f,\"lat\":%.4f,"
-                               "\"course\":%.1f,\"heading\":%u,\"second\":%u,"
-                               "\"maneuver\":%u,\"raim\":%s,\"radio\":%u}\r\n",
-                               ais->type1.status,
-                               nav_legends[ais->type1.status],
-                               turnlegend,
-                               speedlegend,
-                               JSON_BOOL(ais->type1.accuracy),
-                               ais->type1.lon / AIS_LATLON_DIV,
-                               ais->type1.lat / AIS_LATLON_DIV,
-                               ais->type1.course / 10.0,
-                               ais->type1.heading,
-                               ais->type1.second,
-                               ais->type1.maneuver,
-                               JSON_BOOL(ais->type1.raim), ais->type1.radio);
+                    json_fixed(&out, (int)ais->type1.speed, 1, 1,
+                               ais->type1.speed / 10.0);
+                json_lit(&out, ",\"accuracy\":");
+                json_puts(&out, JSON_BOOL(ais->type1.accuracy));
+                json_lit(&out, ",\"lon\":");
+                json_fixed(&out, ais->type1.lon, 60, 4,
+                           ais->type1.lon / AIS_LATLON_DIV);
+                json_lit(&out, ",\"lat\":");
+                json_fixed(&out, ais->type1.lat, 60, 4,
+                           ais->type1.lat / AIS_LATLON_DIV);
+                json_lit(&out, ",\"course\":");
+                json_fixed(&out, (int)ais->type1.course, 1, 1,
+                           ais->type1.course / 10.0);
             } else {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"status\":%u,\"status_text\":\"%s\","
-                               "\"turn\":%d,\"speed\":%u,"
-                               "\"accuracy\":%s,\"lon\":%d,\"lat\":%d,"
-                               "\"course\":%u,\"heading\":%u,\"second\":%u,"
-                               "\"maneuver\":%u,\"raim\":%s,\"radio\":%u}\r\n",
-                               ais->type1.status,
-                               nav_legends[ais->type1.status],
-                               ais->type1.turn,
-                               ais->type1.speed,
-                               JSON_BOOL(ais->type1.accuracy),
-                               ais->type1.lon,
-                               ais->type1.lat,
-                               ais->type1.course,
-                               ais->type1.heading,
-                               ais->type1.second,
-                               ais->type1.maneuver,
-                               JSON_BOOL(ais->type1.raim), ais->type1.radio);
+                json_int(&out, ais->type1.turn);
+                json_lit(&out, ",\"speed\":");
+                json_uint(&out, ais->type1.speed);
+                json_lit(&out, ",\"accuracy\":");
+                json_puts(&out, JSON_BOOL(ais->type1.accuracy));
+                json_lit(&out, ",\"lon\":");
+                json_int(&out, ais->type1.lon);
+                json_lit(&out, ",\"lat\":");
+                json_int(&out, ais->type1.lat);
+                json_lit(&out, ",\"course\":");
+                json_uint(&out, ais->type1.course);
             }
+            json_lit(&out, ",\"heading\":");
+            json_uint(&out, ais->type1.heading);
+            json_lit(&out, ",\"second\":");
+            json_uint(&out, ais->type1.second);
+            json_lit(&out, ",\"maneuver\":");
+            json_uint(&out, ais->type1.maneuver);
+            json_lit(&out, ",\"raim\":");
+            json_puts(&out, JSON_BOOL(ais->type1.raim));
+            json_lit(&out, ",\"radio\":");
+            json_uint(&out, ais->type1.radio);
+            json_lit(&out, "}\r\n");
             break;
         case 4:			/* Base Station Report */
         case 11:			/* UTC/Date Response */
             /* some fields have beem merged to an ISO8601 date */
+            // The use of %u instead of %04u for the year is to allow
+            // out-of-band year values.
+            json_lit(&out, "\"timestamp\":\"");
+            json_uint0(&out, ais->type4.year, 4);
+            json_lit(&out, "-");
+            json_uint0(&out, ais->type4.month, 2);
+            json_lit(&out, "-");
+            json_uint0(&out, ais->type4.day, 2);
+            json_lit(&out, "T");
+            json_uint0(&out, ais->type4.hour, 2);
+            json_lit(&out, ":");
+            json_uint0(&out, ais->type4.minute, 2);
+            json_lit(&out, ":");
+            json_uint0(&out, ais->type4.second, 2);
+            json_lit(&out, "Z\",\"accuracy\":");
+            json_puts(&out, JSON_BOOL(ais->type4.accuracy));
+            json_lit(&out, ",\"lon\":");
             if (scaled) {
-                // The use of %u instead of %04u for the year is to allow
-                // out-of-band year values.
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"timestamp\":\"%04u-%02u-%02uT%02u:%02u:%02uZ\","
-                               "\"accuracy\":%s,\"lon\":%.4f,\"lat\":%.4f,"
-                               "\"epfd\":%u,\"epfd_text\":\"%s\","
-                               "\"raim\":%s,\"radio\":%u}\r\n",
-                               ais->type4.year,
-                               ais->type4.month,
-                               ais->type4.day,
-                               ais->type4.hour,
-                               ais->type4.minute,
-                               ais->type4.second,
-                               JSON_BOOL(ais->type4.accuracy),
-                               ais->type4.lon / AIS_LATLON_DIV,
-                               ais->type4.lat / AIS_LATLON_DIV,
-                               ais->type4.epfd,
-                               EPFD_DISPLAY(ais->type4.epfd),
-                               JSON_BOOL(ais->type4.raim), ais->type4.radio);
+                json_fixed(&out, ais->type4.lon, 60, 4,
+                           ais->type4.lon / AIS_LATLON_DIV);
+                json_lit(&out, ",\"lat\":");
+                json_fixed(&out, ais->type4.lat, 60, 4,
+                           ais->type4.lat / AIS_LATLON_DIV);
             } else {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"timestamp\":\"%04u-%02u-%02uT%02u:%02u:%02uZ\","
-                               "\"accuracy\":%s,\"lon\":%d,\"lat\":%d,"
-                               "\"epfd\":%u,\"epfd_text\":\"%s\","
-                               "\"raim\":%s,\"radio\":%u}\r\n",
-                               ais->type4.year,
-                               ais->type4.month,
-                               ais->type4.day,
-                               ais->type4.hour,
-                               ais->type4.minute,
-                               ais->type4.second,
-                               JSON_BOOL(ais->type4.accuracy),
-                               ais->type4.lon,
-                               ais->type4.lat,
-                               ais->type4.epfd,
-                               EPFD_DISPLAY(ais->type4.epfd),
-                               JSON_BOOL(ais->type4.raim), ais->type4.radio);
+                json_int(&out, ais->type4.lon);
+                json_lit(&out, ",\"lat\":");
+                json_int(&out, ais->type4.lat);
             }
+            json_lit(&out, ",\"epfd\":");
+            json_uint(&out, ais->type4.epfd);
+            json_lit(&out, ",\"epfd_text\":");
+            json_legend(&out, EPFD_DISPLAY(ais->type4.epfd));
+            json_lit(&out, ",\"raim\":");
+            json_puts(&out, JSON_BOOL(ais->type4.raim));
+            json_lit(&out, ",\"radio\":");
+            json_uint(&out, ais->type4.radio);
+            json_lit(&out, "}\r\n");
             break;
         case 5:			/* Ship static and voyage related data */
             /* some fields have beem merged to an ISO8601 partial date */
-            if (scaled) {
-                /* *INDENT-OFF* */
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"imo\":%u,\"ais_version\":%u,\"callsign\":\"%s\","
-                               "\"shipname\":\"%s\","
-                               "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-                               "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
-                               "\"to_starboard\":%u,"
-                               "\"epfd\":%u,\"epfd_text\":\"%s\","
-                               "\"eta\":\"%02u-%02uT%02u:%02uZ\","
-                               "\"draught\":%.1f,\"destination\":\"%s\","
-                               "\"dte\":%u}\r\n",
-                               ais->type5.imo,
-                               ais->type5.ais_version,
-                               json_stringify(buf1, sizeof(buf1),
-                                              ais->type5.callsign),
-                               json_stringify(buf2, sizeof(buf2),
-                                              ais->type5.shipname),
-                               ais->type5.shiptype,
-                               SHIPTYPE_DISPLAY(ais->type5.shiptype),
-                               ais->type5.to_bow, ais->type5.to_stern,
-                               ais->type5.to_port, ais->type5.to_starboard,
-                               ais->type5.epfd,
-                               EPFD_DISPLAY(ais->type5.epfd),
-                               ais->type5.month,
-                               ais->type5.day,
-                               ais->type5.hour, ais->type5.minute,
-                               ais->type5.draught / 10.0,
-                               json_stringify(buf3, sizeof(buf3),
-                                              ais->type5.destination),
-                               ais->type5.dte);
-                /* *INDENT-ON* */
-            } else {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"imo\":%u,\"ais_version\":%u,\"callsign\":\"%s\","
-                               "\"shipname\":\"%s\","
-                               "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-                               "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
-                               "\"to_starboard\":%u,"
-                               "\"epfd\":%u,\"epfd_text\":\"%s\","
-                               "\"eta\":\"%02u-%02uT%02u:%02uZ\","
-                               "\"draught\":%u,\"destination\":\"%s\","
-                               "\"dte\":%u}\r\n",
-                               ais->type5.imo,
-                               ais->type5.ais_version,
-                               json_stringify(buf1, sizeof(buf1),
-                                              ais->type5.callsign),
-                               json_stringify(buf2, sizeof(buf2),
-                                              ais->type5.shipname),
-                               ais->type5.shiptype,
-                               SHIPTYPE_DISPLAY(ais->type5.shiptype),
-                               ais->type5.to_bow,
-                               ais->type5.to_stern,
-                               ais->type5.to_port,
-                               ais->type5.to_starboard,
-                               ais->type5.epfd,
-                               EPFD_DISPLAY(ais->type5.epfd),
-                               ais->type5.month,
-                               ais->type5.day,
-                               ais->type5.hour,
-                               ais->type5.minute,
-                               ais->type5.draught,
-                               json_stringify(buf3, sizeof(buf3),
-                                              ais->type5.destination),
-                               ais->type5.dte);
-            }
+            json_lit(&out, "\"imo\":");
+            json_uint(&out, ais->type5.imo);
+            json_lit(&out, ",\"ais_version\":");
+            json_uint(&out, ais->type5.ais_version);
+            json_lit(&out, ",\"callsign\":\"");
+            json_puts(&out, json_stringify(buf1, sizeof(buf1),
+                                           ais->type5.callsign));
+            json_lit(&out, "\",\"shipname\":\"");
+            json_puts(&out, json_stringify(buf1, sizeof(buf1),
+                                           ais->type5.shipname));
+            json_lit(&out, "\",\"shiptype\":");
+            json_uint(&out, ais->type5.shiptype);
+            json_lit(&out, ",\"shiptype_text\":");
+            json_legend(&out, SHIPTYPE_DISPLAY(ais->type5.shiptype));
+            json_lit(&out, ",\"to_bow\":");
+            json_uint(&out, ais->type5.to_bow);
+            json_lit(&out, ",\"to_stern\":");
+            json_uint(&out, ais->type5.to_stern);
+            json_lit(&out, ",\"to_port\":");
+            json_uint(&out, ais->type5.to_port);
+            json_lit(&out, ",\"to_starboard\":");
+            json_uint(&out, ais->type5.to_starboard);
+            json_lit(&out, ",\"epfd\":");
+            json_uint(&out, ais->type5.epfd);
+            json_lit(&out, ",\"epfd_text\":");
+            json_legend(&out, EPFD_DISPLAY(ais->type5.epfd));
+            json_lit(&out, ",\"eta\":\"");
+            json_uint0(&out, ais->type5.month, 2);
+            json_lit(&out, "-");
+            json_uint0(&out, ais->type5.day, 2);
+            json_lit(&out, "T");
+            json_uint0(&out, ais->type5.hour, 2);
+            json_lit(&out, ":");
+            json_uint0(&out, ais->type5.minute, 2);
+            json_lit(&out, "Z\",\"draught\":");
+            if (scaled)
+                json_fixed(&out, (int)ais->type5.draught, 1, 1,
+                           ais->type5.draught / 10.0);
+            else
+                json_uint(&out, ais->type5.draught);
+            json_lit(&out, ",\"destination\":\"");
+            json_puts(&out, json_stringify(buf1, sizeof(buf1),
+                                           ais->type5.destination));
+            json_lit(&out, "\",\"dte\":");
+            json_uint(&out, ais->type5.dte);
+            json_lit(&out, "}\r\n");
             break;
         case 6:			/* Binary Message */
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "\"seqno\":%u,\"dest_mmsi\":%u,"
-                           "\"retransmit\":%s,\"dac\":%u,\"fid\":%u,",
-                           ais->type6.seqno,
-                           ais->type6.dest_mmsi,
-                           JSON_BOOL(ais->type6.retransmit),
-                           ais->type6.dac,
-                           ais->type6.fid);
+            json_printf(&out,
+                        "\"seqno\":%u,\"dest_mmsi\":%u,"
+                        "\"retransmit\":%s,\"dac\":%u,\"fid\":%u,",
+                        ais->type6.seqno,
+                        ais->type6.dest_mmsi,
+                        JSON_BOOL(ais->type6.retransmit),
+                        ais->type6.dac,
+                        ais->type6.fid);
             if (!ais->type6.structured) {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"data\":\"%zd:%s\"}\r\n",
-                               ais->type6.bitcount,
-                               json_stringify(buf1, sizeof(buf1),
-                                              gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
-                                                           (char *)ais->type6.bitdata,
-                                                           BITS_TO_BYTES(ais->type6.bitcount))));
+                json_printf(&out,
+                            "\"data\":\"%zd:%s\"}\r\n",
+                            ais->type6.bitcount,
+                            json_stringify(buf1, sizeof(buf1),
+                                           gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
+                                                        (char *)ais->type6.bitdata,
+                                                        BITS_TO_BYTES(ais->type6.bitcount))));
                 break;
             }
             if (ais->type6.dac == 200) {
                 switch (ais->type6.fid) {
                     case 21:
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"country\":\"%s\",\"locode\":\"%s\",\"section\":\"%s\",\"terminal\":\"%s\",\"hectometre\":\"%s\",\"eta\":\"%u-%uT%u:%u\",\"tugs\":%u,\"airdraught\":%u}",
-                                       ais->type6.dac200fid21.country,
-                                       ais->type6.dac200fid21.locode,
-                                       ais->type6.dac200fid21.section,
-                                       ais->type6.dac200fid21.terminal,
-                                       ais->type6.dac200fid21.hectometre,
-                                       ais->type6.dac200fid21.month,
-                                       ais->type6.dac200fid21.day,
-                                       ais->type6.dac200fid21.hour,
-                                       ais->type6.dac200fid21.minute,
-                                       ais->type6.dac200fid21.tugs,
-                                       ais->type6.dac200fid21.airdraught);
+                        json_printf(&out,
+                                    "\"country\":\"%s\",\"locode\":\"%s\",\"section\":\"%s\",\"terminal\":\"%s\",\"hectometre\":\"%s\",\"eta\":\"%u-%uT%u:%u\",\"tugs\":%u,\"airdraught\":%u}",
+                                    ais->type6.dac200fid21.country,
+                                    ais->type6.dac200fid21.locode,
+                                    ais->type6.dac200fid21.section,
+                                    ais->type6.dac200fid21.terminal,
+                                    ais->type6.dac200fid21.hectometre,
+                                    ais->type6.dac200fid21.month,
+                                    ais->type6.dac200fid21.day,
+                                    ais->type6.dac200fid21.hour,
+                                    ais->type6.dac200fid21.minute,
+                                    ais->type6.dac200fid21.tugs,
+                                    ais->type6.dac200fid21.airdraught);
                         break;
                     case 22:
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"country\":\"%s\",\"locode\":\"%s\","
-                                       "\"section\":\"%s\","
-                                       "\"terminal\":\"%s\",\"hectometre\":\"%s\","
-                                       "\"eta\":\"%u-%uT%u:%u\","
-                                       "\"status\":%u,\"status_text\":\"%s\"}",
-                                       ais->type6.dac200fid22.country,
-                                       ais->type6.dac200fid22.locode,
-                                       ais->type6.dac200fid22.section,
-                                       ais->type6.dac200fid22.terminal,
-                                       ais->type6.dac200fid22.hectometre,
-                                       ais->type6.dac200fid22.month,
-                                       ais->type6.dac200fid22.day,
-                                       ais->type6.dac200fid22.hour,
-                                       ais->type6.dac200fid22.minute,
-                                       ais->type6.dac200fid22.status,
-                                       rta_status[ais->type6.dac200fid22.status]);
+                        json_printf(&out,
+                                    "\"country\":\"%s\",\"locode\":\"%s\","
+                                    "\"section\":\"%s\","
+                                    "\"terminal\":\"%s\",\"hectometre\":\"%s\","
+                                    "\"eta\":\"%u-%uT%u:%u\","
+                                    "\"status\":%u,\"status_text\":%s}",
+                                    ais->type6.dac200fid22.country,
+                                    ais->type6.dac200fid22.locode,
+                                    ais->type6.dac200fid22.section,
+                                    ais->type6.dac200fid22.terminal,
+                                    ais->type6.dac200fid22.hectometre,
+                                    ais->type6.dac200fid22.month,
+                                    ais->type6.dac200fid22.day,
+                                    ais->type6.dac200fid22.hour,
+                                    ais->type6.dac200fid22.minute,
+                                    ais->type6.dac200fid22.status,
+                                    rta_status[ais->type6.dac200fid22.status].text);
                         break;
                     case 55:
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"crew\":%u,\"passengers\":%u,\"personnel\":%u}",
-                                       
-                                       ais->type6.dac200fid55.crew,
-                                       ais->type6.dac200fid55.passengers,
-                                       ais->type6.dac200fid55.personnel);
+                        json_printf(&out,
+                                    "\"crew\":%u,\"passengers\":%u,\"personnel\":%u}",
+                                    
+                                    ais->type6.dac200fid55.crew,
+                                    ais->type6.dac200fid55.passengers,
+                                    ais->type6.dac200fid55.personnel);
                         break;
                 }
             }
             else if (ais->type6.dac == 235 || ais->type6.dac == 250) {
                 switch (ais->type6.fid) {
                     case 10:	/* GLA - AtoN monitoring data */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"off_pos\":%s,\"alarm\":%s,"
-                                       "\"stat_ext\":%u,",
-                                       JSON_BOOL(ais->type6.dac235fid10.off_pos),
-                                       JSON_BOOL(ais->type6.dac235fid10.alarm),
-                                       ais->type6.dac235fid10.stat_ext);
+                        json_printf(&out,
+                                    "\"off_pos\":%s,\"alarm\":%s,"
+                                    "\"stat_ext\":%u,",
+                                    JSON_BOOL(ais->type6.dac235fid10.off_pos),
+                                    JSON_BOOL(ais->type6.dac235fid10.alarm),
+                                    ais->type6.dac235fid10.stat_ext);
                         if (scaled && ais->type6.dac235fid10.ana_int != 0)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"ana_int\":%.2f,",
-                                           ais->type6.dac235fid10.ana_int*0.05);
+                            json_printf(&out,
+                                        "\"ana_int\":%.2f,",
+                                        ais->type6.dac235fid10.ana_int*0.05);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"ana_int\":%u,",
-                                           ais->type6.dac235fid10.ana_int);
+                            json_printf(&out,
+                                        "\"ana_int\":%u,",
+                                        ais->type6.dac235fid10.ana_int);
                         if (scaled && ais->type6.dac235fid10.ana_ext1 != 0)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"ana_ext1\":%.2f,",
-                                           ais->type6.dac235fid10.ana_ext1*0.05);
+                            json_printf(&out,
+                                        "\"ana_ext1\":%.2f,",
+                                        ais->type6.dac235fid10.ana_ext1*0.05);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"ana_ext1\":%u,",
-                                           ais->type6.dac235fid10.ana_ext1);
+                            json_printf(&out,
+                                        "\"ana_ext1\":%u,",
+                                        ais->type6.dac235fid10.ana_ext1);
                         if (scaled && ais->type6.dac235fid10.ana_ext2 != 0)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"ana_ext2\":%.2f,",
-                                           ais->type6.dac235fid10.ana_ext2*0.05);
+                            json_printf(&out,
+                                        "\"ana_ext2\":%.2f,",
+                                        ais->type6.dac235fid10.ana_ext2*0.05);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"ana_ext2\":%u,",
-                                           ais->type6.dac235fid10.ana_ext2);
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"racon\":%u,"
-                                       "\"racon_text\":\"%s\","
-                                       "\"light\":%u,"
-                                       "\"light_text\":\"%s\"",
-                                       ais->type6.dac235fid10.racon,
-                                       racon_status[ais->type6.dac235fid10.racon],
-                                       ais->type6.dac235fid10.light,
-                                       light_status[ais->type6.dac235fid10.light]);
-                        if (buf[strlen(buf) - 1] == ',')
-                            buf[strlen(buf)-1] = '\0';
-                        (void)strlcat(buf, "}\r\n", buflen);
+                            json_printf(&out,
+                                        "\"ana_ext2\":%u,",
+                                        ais->type6.dac235fid10.ana_ext2);
+                        json_printf(&out,
+                                    "\"racon\":%u,"
+                                    "\"racon_text\":%s,"
+                                    "\"light\":%u,"
+                                    "\"light_text\":%s",
+                                    ais->type6.dac235fid10.racon,
+                                    racon_status[ais->type6.dac235fid10.racon].text,
+                                    ais->type6.dac235fid10.light,
+                                    light_status[ais->type6.dac235fid10.light].text);
+                        json_chomp(&out);
+                        json_puts(&out, "}\r\n");
                         break;
                 }
             }
@@ -701,512 +897,508 @@ void json_aivdm_dump(const struct ais_t *ais,
                 switch (ais->type6.fid) {
                     case 12:	/* IMO236 -Dangerous cargo indication */
                         /* some fields have beem merged to an ISO8601 partial date */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"lastport\":\"%s\",\"departure\":\"%02u-%02uT%02u:%02uZ\","
-                                       "\"nextport\":\"%s\",\"eta\":\"%02u-%02uT%02u:%02uZ\","
-                                       "\"dangerous\":\"%s\",\"imdcat\":\"%s\","
-                                       "\"unid\":%u,\"amount\":%u,\"unit\":%u}\r\n",
-                                       json_stringify(buf1, sizeof(buf1),
-                                                      ais->type6.dac1fid12.lastport),
-                                       ais->type6.dac1fid12.lmonth,
-                                       ais->type6.dac1fid12.lday,
-                                       ais->type6.dac1fid12.lhour,
-                                       ais->type6.dac1fid12.lminute,
-                                       json_stringify(buf2, sizeof(buf2),
-                                                      ais->type6.dac1fid12.nextport),
-                                       ais->type6.dac1fid12.nmonth,
-                                       ais->type6.dac1fid12.nday,
-                                       ais->type6.dac1fid12.nhour,
-                                       ais->type6.dac1fid12.nminute,
-                                       json_stringify(buf3, sizeof(buf3),
-                                                      ais->type6.dac1fid12.dangerous),
-                                       json_stringify(buf4, sizeof(buf4),
-                                                      ais->type6.dac1fid12.imdcat),
-                                       ais->type6.dac1fid12.unid,
-                                       ais->type6.dac1fid12.amount,
-                                       ais->type6.dac1fid12.unit);
+                        json_printf(&out,
+                                    "\"lastport\":\"%s\",\"departure\":\"%02u-%02uT%02u:%02uZ\","
+                                    "\"nextport\":\"%s\",\"eta\":\"%02u-%02uT%02u:%02uZ\","
+                                    "\"dangerous\":\"%s\",\"imdcat\":\"%s\","
+                                    "\"unid\":%u,\"amount\":%u,\"unit\":%u}\r\n",
+                                    json_stringify(buf1, sizeof(buf1),
+                                                   ais->type6.dac1fid12.lastport),
+                                    ais->type6.dac1fid12.lmonth,
+                                    ais->type6.dac1fid12.lday,
+                                    ais->type6.dac1fid12.lhour,
+                                    ais->type6.dac1fid12.lminute,
+                                    json_stringify(buf2, sizeof(buf2),
+                                                   ais->type6.dac1fid12.nextport),
+                                    ais->type6.dac1fid12.nmonth,
+                                    ais->type6.dac1fid12.nday,
+                                    ais->type6.dac1fid12.nhour,
+                                    ais->type6.dac1fid12.nminute,
+                                    json_stringify(buf3, sizeof(buf3),
+                                                   ais->type6.dac1fid12.dangerous),
+                                    json_stringify(buf4, sizeof(buf4),
+                                                   ais->type6.dac1fid12.imdcat),
+                                    ais->type6.dac1fid12.unid,
+                                    ais->type6.dac1fid12.amount,
+                                    ais->type6.dac1fid12.unit);
                         break;
                     case 15:	/* IMO236 - Extended Ship Static and Voyage Related Data */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"airdraught\":%u}\r\n",
-                                       ais->type6.dac1fid15.airdraught);
+                        json_printf(&out,
+                                    "\"airdraught\":%u}\r\n",
+                                    ais->type6.dac1fid15.airdraught);
                         break;
                     case 16:	/* IMO236 - Number of persons on board */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"persons\":%u}\t\n", ais->type6.dac1fid16.persons);
+                        json_printf(&out,
+                                    "\"persons\":%u}\t\n", ais->type6.dac1fid16.persons);
                         break;
                     case 18:	/* IMO289 - Clearance time to enter port */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"linkage\":%u,\"arrival\":\"%02u-%02uT%02u:%02uZ\",\"portname\":\"%s\",\"destination\":\"%s\",",
-                                       ais->type6.dac1fid18.linkage,
-                                       ais->type6.dac1fid18.month,
-                                       ais->type6.dac1fid18.day,
-                                       ais->type6.dac1fid18.hour,
-                                       ais->type6.dac1fid18.minute,
-                                       json_stringify(buf1, sizeof(buf1),
-                                                      ais->type6.dac1fid18.portname),
-                                       json_stringify(buf2, sizeof(buf2),
-                                                      ais->type6.dac1fid18.destination));
+                        json_printf(&out,
+                                    "\"linkage\":%u,\"arrival\":\"%02u-%02uT%02u:%02uZ\",\"portname\":\"%s\",\"destination\":\"%s\",",
+                                    ais->type6.dac1fid18.linkage,
+                                    ais->type6.dac1fid18.month,
+                                    ais->type6.dac1fid18.day,
+                                    ais->type6.dac1fid18.hour,
+                                    ais->type6.dac1fid18.minute,
+                                    json_stringify(buf1, sizeof(buf1),
+                                                   ais->type6.dac1fid18.portname),
+                                    json_stringify(buf2, sizeof(buf2),
+                                                   ais->type6.dac1fid18.destination));
                         if (scaled)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"lon\":%.3f,\"lat\":%.3f}\r\n",
-                                           ais->type6.dac1fid18.lon/AIS_LATLON3_DIV,
-                                           ais->type6.dac1fid18.lat/AIS_LATLON3_DIV);
+                            json_printf(&out,
+                                        "\"lon\":%.3f,\"lat\":%.3f}\r\n",
+                                        ais->type6.dac1fid18.lon/AIS_LATLON3_DIV,
+                                        ais->type6.dac1fid18.lat/AIS_LATLON3_DIV);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"lon\":%d,\"lat\":%d}\r\n",
-                                           ais->type6.dac1fid18.lon,
-                                           ais->type6.dac1fid18.lat);
+                            json_printf(&out,
+                                        "\"lon\":%d,\"lat\":%d}\r\n",
+                                        ais->type6.dac1fid18.lon,
+                                        ais->type6.dac1fid18.lat);
                         break;
                     case 20:        /* IMO289 - Berthing Data */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"linkage\":%u,\"berth_length\":%u,"
-                                       "\"position\":%u,\"position_text\":\"%s\","
-                                       "\"arrival\":\"%u-%uT%u:%u\","
-                                       "\"availability\":%u,"
-                                       "\"agent\":%u,\"fuel\":%u,\"chandler\":%u,"
-                                       "\"stevedore\":%u,\"electrical\":%u,"
-                                       "\"water\":%u,\"customs\":%u,\"cartage\":%u,"
-                                       "\"crane\":%u,\"lift\":%u,\"medical\":%u,"
-                                       "\"navrepair\":%u,\"provisions\":%u,"
-                                       "\"shiprepair\":%u,\"surveyor\":%u,"
-                                       "\"steam\":%u,\"tugs\":%u,\"solidwaste\":%u,"
-                                       "\"liquidwaste\":%u,\"hazardouswaste\":%u,"
-                                       "\"ballast\":%u,\"additional\":%u,"
-                                       "\"regional1\":%u,\"regional2\":%u,"
-                                       "\"future1\":%u,\"future2\":%u,"
-                                       "\"berth_name\":\"%s\",",
-                                       ais->type6.dac1fid20.linkage,
-                                       ais->type6.dac1fid20.berth_length,
-                                       ais->type6.dac1fid20.position,
-                                       position_types[ais->type6.dac1fid20.position],
-                                       ais->type6.dac1fid20.month,
-                                       ais->type6.dac1fid20.day,
-                                       ais->type6.dac1fid20.hour,
-                                       ais->type6.dac1fid20.minute,
-                                       ais->type6.dac1fid20.availability,
-                                       ais->type6.dac1fid20.agent,
-                                       ais->type6.dac1fid20.fuel,
-                                       ais->type6.dac1fid20.chandler,
-                                       ais->type6.dac1fid20.stevedore,
-                                       ais->type6.dac1fid20.electrical,
-                                       ais->type6.dac1fid20.water,
-                                       ais->type6.dac1fid20.customs,
-                                       ais->type6.dac1fid20.cartage,
-                                       ais->type6.dac1fid20.crane,
-                                       ais->type6.dac1fid20.lift,
-                                       ais->type6.dac1fid20.medical,
-                                       ais->type6.dac1fid20.navrepair,
-                                       ais->type6.dac1fid20.provisions,
-                                       ais->type6.dac1fid20.shiprepair,
-                                       ais->type6.dac1fid20.surveyor,
-                                       ais->type6.dac1fid20.steam,
-                                       ais->type6.dac1fid20.tugs,
-                                       ais->type6.dac1fid20.solidwaste,
-                                       ais->type6.dac1fid20.liquidwaste,
-                                       ais->type6.dac1fid20.hazardouswaste,
-                                       ais->type6.dac1fid20.ballast,
-                                       ais->type6.dac1fid20.additional,
-                                       ais->type6.dac1fid20.regional1,
-                                       ais->type6.dac1fid20.regional2,
-                                       ais->type6.dac1fid20.future1,
-                                       ais->type6.dac1fid20.future2,
-                                       json_stringify(buf1, sizeof(buf1),
-                                                      ais->type6.dac1fid20.berth_name));
+                        json_printf(&out,
+                                    "\"linkage\":%u,\"berth_length\":%u,"
+                                    "\"position\":%u,\"position_text\":%s,"
+                                    "\"arrival\":\"%u-%uT%u:%u\","
+                                    "\"availability\":%u,"
+                                    "\"agent\":%u,\"fuel\":%u,\"chandler\":%u,"
+                                    "\"stevedore\":%u,\"electrical\":%u,"
+                                    "\"water\":%u,\"customs\":%u,\"cartage\":%u,"
+                                    "\"crane\":%u,\"lift\":%u,\"medical\":%u,"
+                                    "\"navrepair\":%u,\"provisions\":%u,"
+                                    "\"shiprepair\":%u,\"surveyor\":%u,"
+                                    "\"steam\":%u,\"tugs\":%u,\"solidwaste\":%u,"
+                                    "\"liquidwaste\":%u,\"hazardouswaste\":%u,"
+                                    "\"ballast\":%u,\"additional\":%u,"
+                                    "\"regional1\":%u,\"regional2\":%u,"
+                                    "\"future1\":%u,\"future2\":%u,"
+                                    "\"berth_name\":\"%s\",",
+                                    ais->type6.dac1fid20.linkage,
+                                    ais->type6.dac1fid20.berth_length,
+                                    ais->type6.dac1fid20.position,
+                                    position_types[ais->type6.dac1fid20.position].text,
+                                    ais->type6.dac1fid20.month,
+                                    ais->type6.dac1fid20.day,
+                                    ais->type6.dac1fid20.hour,
+                                    ais->type6.dac1fid20.minute,
+                                    ais->type6.dac1fid20.availability,
+                                    ais->type6.dac1fid20.agent,
+                                    ais->type6.dac1fid20.fuel,
+                                    ais->type6.dac1fid20.chandler,
+                                    ais->type6.dac1fid20.stevedore,
+                                    ais->type6.dac1fid20.electrical,
+                                    ais->type6.dac1fid20.water,
+                                    ais->type6.dac1fid20.customs,
+                                    ais->type6.dac1fid20.cartage,
+                                    ais->type6.dac1fid20.crane,
+                                    ais->type6.dac1fid20.lift,
+                                    ais->type6.dac1fid20.medical,
+                                    ais->type6.dac1fid20.navrepair,
+                                    ais->type6.dac1fid20.provisions,
+                                    ais->type6.dac1fid20.shiprepair,
+                                    ais->type6.dac1fid20.surveyor,
+                                    ais->type6.dac1fid20.steam,
+                                    ais->type6.dac1fid20.tugs,
+                                    ais->type6.dac1fid20.solidwaste,
+                                    ais->type6.dac1fid20.liquidwaste,
+                                    ais->type6.dac1fid20.hazardouswaste,
+                                    ais->type6.dac1fid20.ballast,
+                                    ais->type6.dac1fid20.additional,
+                                    ais->type6.dac1fid20.regional1,
+                                    ais->type6.dac1fid20.regional2,
+                                    ais->type6.dac1fid20.future1,
+                                    ais->type6.dac1fid20.future2,
+                                    json_stringify(buf1, sizeof(buf1),
+                                                   ais->type6.dac1fid20.berth_name));
                         if (scaled)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"berth_lon\":%.3f,"
-                                           "\"berth_lat\":%.3f,"
-                                           "\"berth_depth\":%.1f}\r\n",
-                                           ais->type6.dac1fid20.berth_lon / AIS_LATLON3_DIV,
-                                           ais->type6.dac1fid20.berth_lat / AIS_LATLON3_DIV,
-                                           ais->type6.dac1fid20.berth_depth * 0.1);
+                            json_printf(&out,
+                                        "\"berth_lon\":%.3f,"
+                                        "\"berth_lat\":%.3f,"
+                                        "\"berth_depth\":%.1f}\r\n",
+                                        ais->type6.dac1fid20.berth_lon / AIS_LATLON3_DIV,
+                                        ais->type6.dac1fid20.berth_lat / AIS_LATLON3_DIV,
+                                        ais->type6.dac1fid20.berth_depth * 0.1);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"berth_lon\":%d,"
-                                           "\"berth_lat\":%d,"
-                                           "\"berth_depth\":%u}\r\n",
-                                           ais->type6.dac1fid20.berth_lon,
-                                           ais->type6.dac1fid20.berth_lat,
-                                           ais->type6.dac1fid20.berth_depth);
+                            json_printf(&out,
+                                        "\"berth_lon\":%d,"
+                                        "\"berth_lat\":%d,"
+                                        "\"berth_depth\":%u}\r\n",
+                                        ais->type6.dac1fid20.berth_lon,
+                                        ais->type6.dac1fid20.berth_lat,
+                                        ais->type6.dac1fid20.berth_depth);
                         break;
                     case 23:    /* IMO289 - Area notice - addressed */
                         break;
                     case 25:	/* IMO289 - Dangerous cargo indication */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"unit\":%u,\"amount\":%u,\"cargos\":[",
-                                       ais->type6.dac1fid25.unit,
-                                       ais->type6.dac1fid25.amount);
+                        json_printf(&out,
+                                    "\"unit\":%u,\"amount\":%u,\"cargos\":[",
+                                    ais->type6.dac1fid25.unit,
+                                    ais->type6.dac1fid25.amount);
                         for (i = 0; i < (int)ais->type6.dac1fid25.ncargos; i++)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "{\"code\":%u,\"subtype\":%u},",
-                                           
-                                           ais->type6.dac1fid25.cargos[i].code,
-                                           ais->type6.dac1fid25.cargos[i].subtype);
-                        if (buf[strlen(buf) - 1] == ',')
-                            buf[strlen(buf) - 1] = '\0';
-                        (void)strlcat(buf, "]}\r\n", buflen);
+                            json_printf(&out,
+                                        "{\"code\":%u,\"subtype\":%u},",
+                                        
+                                        ais->type6.dac1fid25.cargos[i].code,
+                                        ais->type6.dac1fid25.cargos[i].subtype);
+                        json_chomp(&out);
+                        json_puts(&out, "]}\r\n");
                         break;
                     case 28:	/* IMO289 - Route info - addressed */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"linkage\":%u,\"sender\":%u,"
-                                       "\"rtype\":%u,"
-                                       "\"rtype_text\":\"%s\","
-                                       "\"start\":\"%02u-%02uT%02u:%02uZ\","
-                                       "\"duration\":%u,\"waypoints\":[",
-                                       ais->type6.dac1fid28.linkage,
-                                       ais->type6.dac1fid28.sender,
-                                       ais->type6.dac1fid28.rtype,
-                                       route_type[ais->type6.dac1fid28.rtype],
-                                       ais->type6.dac1fid28.month,
-                                       ais->type6.dac1fid28.day,
-                                       ais->type6.dac1fid28.hour,
-                                       ais->type6.dac1fid28.minute,
-                                       ais->type6.dac1fid28.duration);
+                        json_printf(&out,
+                                    "\"linkage\":%u,\"sender\":%u,"
+                                    "\"rtype\":%u,"
+                                    "\"rtype_text\":%s,"
+                                    "\"start\":\"%02u-%02uT%02u:%02uZ\","
+                                    "\"duration\":%u,\"waypoints\":[",
+                                    ais->type6.dac1fid28.linkage,
+                                    ais->type6.dac1fid28.sender,
+                                    ais->type6.dac1fid28.rtype,
+                                    route_type[ais->type6.dac1fid28.rtype].text,
+                                    ais->type6.dac1fid28.month,
+                                    ais->type6.dac1fid28.day,
+                                    ais->type6.dac1fid28.hour,
+                                    ais->type6.dac1fid28.minute,
+                                    ais->type6.dac1fid28.duration);
                         for (i = 0; i < ais->type6.dac1fid28.waycount; i++) {
                             if (scaled)
-                                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                               "{\"lon\":%.4f,\"lat\":%.4f},",
-                                               ais->type6.dac1fid28.waypoints[i].lon / AIS_LATLON4_DIV,
-                                               ais->type6.dac1fid28.waypoints[i].lat / AIS_LATLON4_DIV);
+                                json_printf(&out,
+                                            "{\"lon\":%.4f,\"lat\":%.4f},",
+                                            ais->type6.dac1fid28.waypoints[i].lon / AIS_LATLON4_DIV,
+                                            ais->type6.dac1fid28.waypoints[i].lat / AIS_LATLON4_DIV);
                             else
-                                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                               "{\"lon\":%d,\"lat\":%d},",
-                                               ais->type6.dac1fid28.waypoints[i].lon,
-                                               ais->type6.dac1fid28.waypoints[i].lat);
+                                json_printf(&out,
+                                            "{\"lon\":%d,\"lat\":%d},",
+                                            ais->type6.dac1fid28.waypoints[i].lon,
+                                            ais->type6.dac1fid28.waypoints[i].lat);
                         }
-                        if (buf[strlen(buf) - 1] == ',')
-                            buf[strlen(buf)-1] = '\0';
-                        (void)strlcat(buf, "]}\r\n", buflen);
+                        json_chomp(&out);
+                        json_puts(&out, "]}\r\n");
                         break;
                     case 30:	/* IMO289 - Text description - addressed */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"linkage\":%u,\"text\":\"%s\"}\r\n",
-                                       ais->type6.dac1fid30.linkage,
-                                       json_stringify(buf1, sizeof(buf1),
-                                                      ais->type6.dac1fid30.text));
+                        json_printf(&out,
+                                    "\"linkage\":%u,\"text\":\"%s\"}\r\n",
+                                    ais->type6.dac1fid30.linkage,
+                                    json_stringify(buf1, sizeof(buf1),
+                                                   ais->type6.dac1fid30.text));
                         break;
                     case 14:	/* IMO236 - Tidal Window */
                     case 32:	/* IMO289 - Tidal Window */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"month\":%u,\"day\":%u,\"tidals\":[",
-                                       ais->type6.dac1fid32.month,
-                                       ais->type6.dac1fid32.day);
+                        json_printf(&out,
+                                    "\"month\":%u,\"day\":%u,\"tidals\":[",
+                                    ais->type6.dac1fid32.month,
+                                    ais->type6.dac1fid32.day);
                         for (i = 0; i < ais->type6.dac1fid32.ntidals; i++) {
                             const struct tidal_t *tp =  &ais->type6.dac1fid32.tidals[i];
                             if (scaled)
-                                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                               "{\"lon\":%.3f,\"lat\":%.3f,",
-                                               tp->lon / AIS_LATLON3_DIV,
-                                               tp->lat / AIS_LATLON3_DIV);
+                                json_printf(&out,
+                                            "{\"lon\":%.3f,\"lat\":%.3f,",
+                                            tp->lon / AIS_LATLON3_DIV,
+                                            tp->lat / AIS_LATLON3_DIV);
                             else
-                                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                               "{\"lon\":%d,\"lat\":%d,",
-                                               tp->lon,
-                                               tp->lat);
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"from_hour\":%u,\"from_min\":%u,\"to_hour\":%u,\"to_min\":%u,\"cdir\":%u,",
-                                           tp->from_hour,
-                                           tp->from_min,
-                                           tp->to_hour,
-                                           tp->to_min,
-                                           tp->cdir);
+                                json_printf(&out,
+                                            "{\"lon\":%d,\"lat\":%d,",
+                                            tp->lon,
+                                            tp->lat);
+                            json_printf(&out,
+                                        "\"from_hour\":%u,\"from_min\":%u,\"to_hour\":%u,\"to_min\":%u,\"cdir\":%u,",
+                                        tp->from_hour,
+                                        tp->from_min,
+                                        tp->to_hour,
+                                        tp->to_min,
+                                        tp->cdir);
                             if (scaled)
-                                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                               "\"cspeed\":%.1f},",
-                                               tp->cspeed / 10.0);
+                                json_printf(&out,
+                                            "\"cspeed\":%.1f},",
+                                            tp->cspeed / 10.0);
                             else
-                                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                               "\"cspeed\":%u},",
-                                               tp->cspeed);
+                                json_printf(&out,
+                                            "\"cspeed\":%u},",
+                                            tp->cspeed);
                         }
-                        if (buf[strlen(buf) - 1] == ',')
-                            buf[strlen(buf)-1] = '\0';
-                        (void)strlcat(buf, "]}\r\n", buflen);
+                        json_chomp(&out);
+                        json_puts(&out, "]}\r\n");
                         break;
                 }
             }
             break;
         case 7:			/* Binary Acknowledge */
         case 13:			/* Safety Related Acknowledge */
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "\"mmsi1\":%u,\"mmsi2\":%u,\"mmsi3\":%u,\"mmsi4\":%u}\r\n",
-                           ais->type7.mmsi1,
-                           ais->type7.mmsi2, ais->type7.mmsi3, ais->type7.mmsi4);
+            json_printf(&out,
+                        "\"mmsi1\":%u,\"mmsi2\":%u,\"mmsi3\":%u,\"mmsi4\":%u}\r\n",
+                        ais->type7.mmsi1,
+                        ais->type7.mmsi2, ais->type7.mmsi3, ais->type7.mmsi4);
             break;
         case 8:			/* Binary Broadcast Message */
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "\"dac\":%u,\"fid\":%u,",ais->type8.dac, ais->type8.fid);
+            json_printf(&out,
+                        "\"dac\":%u,\"fid\":%u,",ais->type8.dac, ais->type8.fid);
             if (!ais->type8.structured) {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"data\":\"%zd:%s\"}\r\n",
-                               ais->type8.bitcount,
-                               json_stringify(buf1, sizeof(buf1),
-                                              gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
-                                                           (char *)ais->type8.bitdata,
-                                                           BITS_TO_BYTES(ais->type8.bitcount))));
+                json_printf(&out,
+                            "\"data\":\"%zd:%s\"}\r\n",
+                            ais->type8.bitcount,
+                            json_stringify(buf1, sizeof(buf1),
+                                           gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
+                                                        (char *)ais->type8.bitdata,
+                                                        BITS_TO_BYTES(ais->type8.bitcount))));
                 break;
             }
             if (ais->type8.dac == 1) {
-                const char *trends[] = {
-                    "steady",
-                    "increasing",
-                    "decreasing",
-                    "N/A",
+                static const struct json_legend_t trends[] = {
+                    JSON_LEGEND("steady"),
+                    JSON_LEGEND("increasing"),
+                    JSON_LEGEND("decreasing"),
+                    JSON_LEGEND("N/A"),
                 };
                 // WMO 306, Code table 4.201
-                const char *preciptypes[] = {
-                    "reserved",
-                    "rain",
-                    "thunderstorm",
-                    "freezing rain",
-                    "mixed/ice",
-                    "snow",
-                    "reserved",
-                    "N/A",
+                static const struct json_legend_t preciptypes[] = {
+                    JSON_LEGEND("reserved"),
+                    JSON_LEGEND("rain"),
+                    JSON_LEGEND("thunderstorm"),
+                    JSON_LEGEND("freezing rain"),
+                    JSON_LEGEND("mixed/ice"),
+                    JSON_LEGEND("snow"),
+                    JSON_LEGEND("reserved"),
+                    JSON_LEGEND("N/A"),
                 };
-                const char *ice[] = {
-                    "no",
-                    "yes",
-                    "reserved",
-                    "N/A",
+                static const struct json_legend_t ice[] = {
+                    JSON_LEGEND("no"),
+                    JSON_LEGEND("yes"),
+                    JSON_LEGEND("reserved"),
+                    JSON_LEGEND("N/A"),
                 };
                 switch (ais->type8.fid) {
                     case 11:        /* IMO236 - Meteorological/Hydrological data */
                         /* some fields have been merged to an ISO8601 partial date */
                         /* layout is almost identical to FID=31 from IMO289 */
                         if (scaled)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"lat\":%.3f,\"lon\":%.3f,",
-                                           ais->type8.dac1fid11.lat / AIS_LATLON3_DIV,
-                                           ais->type8.dac1fid11.lon / AIS_LATLON3_DIV);
+                            json_printf(&out,
+                                        "\"lat\":%.3f,\"lon\":%.3f,",
+                                        ais->type8.dac1fid11.lat / AIS_LATLON3_DIV,
+                                        ais->type8.dac1fid11.lon / AIS_LATLON3_DIV);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"lat\":%d,\"lon\":%d,",
-                                           ais->type8.dac1fid11.lat,
-                                           ais->type8.dac1fid11.lon);
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"timestamp\":\"%02uT%02u:%02uZ\","
-                                       "\"wspeed\":%u,\"wgust\":%u,\"wdir\":%u,"
-                                       "\"wgustdir\":%u,\"humidity\":%u,",
-                                       ais->type8.dac1fid11.day,
-                                       ais->type8.dac1fid11.hour,
-                                       ais->type8.dac1fid11.minute,
-                                       ais->type8.dac1fid11.wspeed,
-                                       ais->type8.dac1fid11.wgust,
-                                       ais->type8.dac1fid11.wdir,
-                                       ais->type8.dac1fid11.wgustdir,
-                                       ais->type8.dac1fid11.humidity);
+                            json_printf(&out,
+                                        "\"lat\":%d,\"lon\":%d,",
+                                        ais->type8.dac1fid11.lat,
+                                        ais->type8.dac1fid11.lon);
+                        json_printf(&out,
+                                    "\"timestamp\":\"%02uT%02u:%02uZ\","
+                                    "\"wspeed\":%u,\"wgust\":%u,\"wdir\":%u,"
+                                    "\"wgustdir\":%u,\"humidity\":%u,",
+                                    ais->type8.dac1fid11.day,
+                                    ais->type8.dac1fid11.hour,
+                                    ais->type8.dac1fid11.minute,
+                                    ais->type8.dac1fid11.wspeed,
+                                    ais->type8.dac1fid11.wgust,
+                                    ais->type8.dac1fid11.wdir,
+                                    ais->type8.dac1fid11.wgustdir,
+                                    ais->type8.dac1fid11.humidity);
                         if (scaled)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"airtemp\":%.1f,\"dewpoint\":%.1f,"
-                                           "\"pressure\":%u,\"pressuretend\":\"%s\",",
-                                           (ais->type8.dac1fid11.airtemp - DAC1FID11_AIRTEMP_OFFSET) / DAC1FID11_AIRTEMP_DIV,
-                                           (ais->type8.dac1fid11.dewpoint - DAC1FID11_DEWPOINT_OFFSET) / DAC1FID11_DEWPOINT_DIV,
-                                           ais->type8.dac1fid11.pressure - DAC1FID11_PRESSURE_OFFSET,
-                                           trends[ais->type8.dac1fid11.pressuretend]);
+                            json_printf(&out,
+                                        "\"airtemp\":%.1f,\"dewpoint\":%.1f,"
+                                        "\"pressure\":%u,\"pressuretend\":%s,",
+                                        (ais->type8.dac1fid11.airtemp - DAC1FID11_AIRTEMP_OFFSET) / DAC1FID11_AIRTEMP_DIV,
+                                        (ais->type8.dac1fid11.dewpoint - DAC1FID11_DEWPOINT_OFFSET) / DAC1FID11_DEWPOINT_DIV,
+                                        ais->type8.dac1fid11.pressure - DAC1FID11_PRESSURE_OFFSET,
+                                        trends[ais->type8.dac1fid11.pressuretend].text);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"airtemp\":%u,\"dewpoint\":%u,"
-                                           "\"pressure\":%u,\"pressuretend\":%u,",
-                                           ais->type8.dac1fid11.airtemp,
-                                           ais->type8.dac1fid11.dewpoint,
-                                           ais->type8.dac1fid11.pressure,
-                                           ais->type8.dac1fid11.pressuretend);
+                            json_printf(&out,
+                                        "\"airtemp\":%u,\"dewpoint\":%u,"
+                                        "\"pressure\":%u,\"pressuretend\":%u,",
+                                        ais->type8.dac1fid11.airtemp,
+                                        ais->type8.dac1fid11.dewpoint,
+                                        ais->type8.dac1fid11.pressure,
+                                        ais->type8.dac1fid11.pressuretend);
                         
                         if (scaled)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"visibility\":%.1f,",
-                                           ais->type8.dac1fid11.visibility / DAC1FID11_VISIBILITY_DIV);
+                            json_printf(&out,
+                                        "\"visibility\":%.1f,",
+                                        ais->type8.dac1fid11.visibility / DAC1FID11_VISIBILITY_DIV);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"visibility\":%u,",
-                                           ais->type8.dac1fid11.visibility);
+                            json_printf(&out,
+                                        "\"visibility\":%u,",
+                                        ais->type8.dac1fid11.visibility);
                         if (!scaled)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"waterlevel\":%d,",
-                                           ais->type8.dac1fid11.waterlevel);
+                            json_printf(&out,
+                                        "\"waterlevel\":%d,",
+                                        ais->type8.dac1fid11.waterlevel);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"waterlevel\":%.1f,",
-                                           (ais->type8.dac1fid11.waterlevel - DAC1FID11_WATERLEVEL_OFFSET) / DAC1FID11_WATERLEVEL_DIV);
+                            json_printf(&out,
+                                        "\"waterlevel\":%.1f,",
+                                        (ais->type8.dac1fid11.waterlevel - DAC1FID11_WATERLEVEL_OFFSET) / DAC1FID11_WATERLEVEL_DIV);
                         
                         if (scaled) {
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"leveltrend\":\"%s\","
-                                           "\"cspeed\":%.1f,\"cdir\":%u,"
-                                           "\"cspeed2\":%.1f,\"cdir2\":%u,\"cdepth2\":%u,"
-                                           "\"cspeed3\":%.1f,\"cdir3\":%u,\"cdepth3\":%u,"
-                                           "\"waveheight\":%.1f,\"waveperiod\":%u,\"wavedir\":%u,"
-                                           "\"swellheight\":%.1f,\"swellperiod\":%u,\"swelldir\":%u,"
-                                           "\"seastate\":%u,\"watertemp\":%.1f,"
-                                           "\"preciptype\":%u,\"preciptype_text\":\"%s\","
-                                           "\"salinity\":%.1f,\"ice\":%u,\"ice_text\":\"%s\"",
-                                           trends[ais->type8.dac1fid11.leveltrend],
-                                           ais->type8.dac1fid11.cspeed / DAC1FID11_CSPEED_DIV,
-                                           ais->type8.dac1fid11.cdir,
-                                           ais->type8.dac1fid11.cspeed2 / DAC1FID11_CSPEED_DIV,
-                                           ais->type8.dac1fid11.cdir2,
-                                           ais->type8.dac1fid11.cdepth2,
-                                           ais->type8.dac1fid11.cspeed3 / DAC1FID11_CSPEED_DIV,
-                                           ais->type8.dac1fid11.cdir3,
-                                           ais->type8.dac1fid11.cdepth3,
-                                           ais->type8.dac1fid11.waveheight / DAC1FID11_WAVEHEIGHT_DIV,
-                                           ais->type8.dac1fid11.waveperiod,
-                                           ais->type8.dac1fid11.wavedir,
-                                           ais->type8.dac1fid11.swellheight / DAC1FID11_WAVEHEIGHT_DIV,
-                                           ais->type8.dac1fid11.swellperiod,
-                                           ais->type8.dac1fid11.swelldir,
-                                           ais->type8.dac1fid11.seastate,
-                                           (ais->type8.dac1fid11.watertemp - DAC1FID11_WATERTEMP_OFFSET) / DAC1FID11_WATERTEMP_DIV,
-                                           ais->type8.dac1fid11.preciptype,
-                                           preciptypes[ais->type8.dac1fid11.preciptype],
-                                           ais->type8.dac1fid11.salinity / DAC1FID11_SALINITY_DIV,
-                                           ais->type8.dac1fid11.ice,
-                                           ice[ais->type8.dac1fid11.ice]);
+                            json_printf(&out,
+                                        "\"leveltrend\":%s,"
+                                        "\"cspeed\":%.1f,\"cdir\":%u,"
+                                        "\"cspeed2\":%.1f,\"cdir2\":%u,\"cdepth2\":%u,"
+                                        "\"cspeed3\":%.1f,\"cdir3\":%u,\"cdepth3\":%u,"
+                                        "\"waveheight\":%.1f,\"waveperiod\":%u,\"wavedir\":%u,"
+                                        "\"swellheight\":%.1f,\"swellperiod\":%u,\"swelldir\":%u,"
+                                        "\"seastate\":%u,\"watertemp\":%.1f,"
+                                        "\"preciptype\":%u,\"preciptype_text\":%s,"
+                                        "\"salinity\":%.1f,\"ice\":%u,\"ice_text\":%s",
+                                        trends[ais->type8.dac1fid11.leveltrend].text,
+                                        ais->type8.dac1fid11.cspeed / DAC1FID11_CSPEED_DIV,
+                                        ais->type8.dac1fid11.cdir,
+                                        ais->type8.dac1fid11.cspeed2 / DAC1FID11_CSPEED_DIV,
+                                        ais->type8.dac1fid11.cdir2,
+                                        ais->type8.dac1fid11.cdepth2,
+                                        ais->type8.dac1fid11.cspeed3 / DAC1FID11_CSPEED_DIV,
+                                        ais->type8.dac1fid11.cdir3,
+                                        ais->type8.dac1fid11.cdepth3,
+                                        ais->type8.dac1fid11.waveheight / DAC1FID11_WAVEHEIGHT_DIV,
+                                        ais->type8.dac1fid11.waveperiod,
+                                        ais->type8.dac1fid11.wavedir,
+                                        ais->type8.dac1fid11.swellheight / DAC1FID11_WAVEHEIGHT_DIV,
+                                        ais->type8.dac1fid11.swellperiod,
+                                        ais->type8.dac1fid11.swelldir,
+                                        ais->type8.dac1fid11.seastate,
+                                        (ais->type8.dac1fid11.watertemp - DAC1FID11_WATERTEMP_OFFSET) / DAC1FID11_WATERTEMP_DIV,
+                                        ais->type8.dac1fid11.preciptype,
+                                        preciptypes[ais->type8.dac1fid11.preciptype].text,
+                                        ais->type8.dac1fid11.salinity / DAC1FID11_SALINITY_DIV,
+                                        ais->type8.dac1fid11.ice,
+                                        ice[ais->type8.dac1fid11.ice].text);
                         } else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"leveltrend\":%u,"
-                                           "\"cspeed\":%u,\"cdir\":%u,"
-                                           "\"cspeed2\":%u,\"cdir2\":%u,\"cdepth2\":%u,"
-                                           "\"cspeed3\":%u,\"cdir3\":%u,\"cdepth3\":%u,"
-                                           "\"waveheight\":%u,\"waveperiod\":%u,\"wavedir\":%u,"
-                                           "\"swellheight\":%u,\"swellperiod\":%u,\"swelldir\":%u,"
-                                           "\"seastate\":%u,\"watertemp\":%u,"
-                                           "\"preciptype\":%u,\"preciptype_text\":\"%s\","
-                                           "\"salinity\":%u,\"ice\":%u,\"ice_text\":\"%s\"",
-                                           ais->type8.dac1fid11.leveltrend,
-                                           ais->type8.dac1fid11.cspeed,
-                                           ais->type8.dac1fid11.cdir,
-                                           ais->type8.dac1fid11.cspeed2,
-                                           ais->type8.dac1fid11.cdir2,
-                                           ais->type8.dac1fid11.cdepth2,
-                                           ais->type8.dac1fid11.cspeed3,
-                                           ais->type8.dac1fid11.cdir3,
-                                           ais->type8.dac1fid11.cdepth3,
-                                           ais->type8.dac1fid11.waveheight,
-                                           ais->type8.dac1fid11.waveperiod,
-                                           ais->type8.dac1fid11.wavedir,
-                                           ais->type8.dac1fid11.swellheight,
-                                           ais->type8.dac1fid11.swellperiod,
-                                           ais->type8.dac1fid11.swelldir,
-                                           ais->type8.dac1fid11.seastate,
-                                           ais->type8.dac1fid11.watertemp,
-                                           ais->type8.dac1fid11.preciptype,
-                                           preciptypes[ais->type8.dac1fid11.preciptype],
-                                           ais->type8.dac1fid11.salinity,
-                                           ais->type8.dac1fid11.ice,
-                                           ice[ais->type8.dac1fid11.ice]);
-                        (void)strlcat(buf, "}\r\n", buflen);
+                            json_printf(&out,
+                                        "\"leveltrend\":%u,"
+                                        "\"cspeed\":%u,\"cdir\":%u,"
+                                        "\"cspeed2\":%u,\"cdir2\":%u,\"cdepth2\":%u,"
+                                        "\"cspeed3\":%u,\"cdir3\":%u,\"cdepth3\":%u,"
+                                        "\"waveheight\":%u,\"waveperiod\":%u,\"wavedir\":%u,"
+                                        "\"swellheight\":%u,\"swellperiod\":%u,\"swelldir\":%u,"
+                                        "\"seastate\":%u,\"watertemp\":%u,"
+                                        "\"preciptype\":%u,\"preciptype_text\":%s,"
+                                        "\"salinity\":%u,\"ice\":%u,\"ice_text\":%s",
+                                        ais->type8.dac1fid11.leveltrend,
+                                        ais->type8.dac1fid11.cspeed,
+                                        ais->type8.dac1fid11.cdir,
+                                        ais->type8.dac1fid11.cspeed2,
+                                        ais->type8.dac1fid11.cdir2,
+                                        ais->type8.dac1fid11.cdepth2,
+                                        ais->type8.dac1fid11.cspeed3,
+                                        ais->type8.dac1fid11.cdir3,
+                                        ais->type8.dac1fid11.cdepth3,
+                                        ais->type8.dac1fid11.waveheight,
+                                        ais->type8.dac1fid11.waveperiod,
+                                        ais->type8.dac1fid11.wavedir,
+                                        ais->type8.dac1fid11.swellheight,
+                                        ais->type8.dac1fid11.swellperiod,
+                                        ais->type8.dac1fid11.swelldir,
+                                        ais->type8.dac1fid11.seastate,
+                                        ais->type8.dac1fid11.watertemp,
+                                        ais->type8.dac1fid11.preciptype,
+                                        preciptypes[ais->type8.dac1fid11.preciptype].text,
+                                        ais->type8.dac1fid11.salinity,
+                                        ais->type8.dac1fid11.ice,
+                                        ice[ais->type8.dac1fid11.ice].text);
+                        json_puts(&out, "}\r\n");
                         break;
                     case 13:        /* IMO236 - Fairway closed */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"reason\":\"%s\",\"closefrom\":\"%s\","
-                                       "\"closeto\":\"%s\",\"radius\":%u,"
-                                       "\"extunit\":%u,"
-                                       "\"from\":\"%02u-%02uT%02u:%02u\","
-                                       "\"to\":\"%02u-%02uT%02u:%02u\"}\r\n",
-                                       json_stringify(buf1, sizeof(buf1),
-                                                      ais->type8.dac1fid13.reason),
-                                       json_stringify(buf2, sizeof(buf2),
-                                                      ais->type8.dac1fid13.closefrom),
-                                       json_stringify(buf3, sizeof(buf3),
-                                                      ais->type8.dac1fid13.closeto),
-                                       ais->type8.dac1fid13.radius,
-                                       ais->type8.dac1fid13.extunit,
-                                       ais->type8.dac1fid13.fmonth,
-                                       ais->type8.dac1fid13.fday,
-                                       ais->type8.dac1fid13.fhour,
-                                       ais->type8.dac1fid13.fminute,
-                                       ais->type8.dac1fid13.tmonth,
-                                       ais->type8.dac1fid13.tday,
-                                       ais->type8.dac1fid13.thour,
-                                       ais->type8.dac1fid13.tminute);
+                        json_printf(&out,
+                                    "\"reason\":\"%s\",\"closefrom\":\"%s\","
+                                    "\"closeto\":\"%s\",\"radius\":%u,"
+                                    "\"extunit\":%u,"
+                                    "\"from\":\"%02u-%02uT%02u:%02u\","
+                                    "\"to\":\"%02u-%02uT%02u:%02u\"}\r\n",
+                                    json_stringify(buf1, sizeof(buf1),
+                                                   ais->type8.dac1fid13.reason),
+                                    json_stringify(buf2, sizeof(buf2),
+                                                   ais->type8.dac1fid13.closefrom),
+                                    json_stringify(buf3, sizeof(buf3),
+                                                   ais->type8.dac1fid13.closeto),
+                                    ais->type8.dac1fid13.radius,
+                                    ais->type8.dac1fid13.extunit,
+                                    ais->type8.dac1fid13.fmonth,
+                                    ais->type8.dac1fid13.fday,
+                                    ais->type8.dac1fid13.fhour,
+                                    ais->type8.dac1fid13.fminute,
+                                    ais->type8.dac1fid13.tmonth,
+                                    ais->type8.dac1fid13.tday,
+                                    ais->type8.dac1fid13.thour,
+                                    ais->type8.dac1fid13.tminute);
                         break;
                     case 15:        /* IMO236 - Extended ship and voyage */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"airdraught\":%u}\r\n",
-                                       ais->type8.dac1fid15.airdraught);
+                        json_printf(&out,
+                                    "\"airdraught\":%u}\r\n",
+                                    ais->type8.dac1fid15.airdraught);
                         break;
                     case 16:	/* IMO289 - Number of persons on board */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"persons\":%u}\t\n", ais->type6.dac1fid16.persons);
+                        json_printf(&out,
+                                    "\"persons\":%u}\t\n", ais->type6.dac1fid16.persons);
                         break;
                     case 17:        /* IMO289 - VTS-generated/synthetic targets */
-                        (void)strlcat(buf, "\"targets\":[", buflen);
+                        json_puts(&out, "\"targets\":[");
                         for (i = 0; i < ais->type8.dac1fid17.ntargets; i++) {
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "{\"idtype\":%u,\"idtype_text\":\"%s\",",
-                                           ais->type8.dac1fid17.targets[i].idtype,
-                                           idtypes[ais->type8.dac1fid17.targets[i].idtype]);
+                            json_printf(&out,
+                                        "{\"idtype\":%u,\"idtype_text\":%s,",
+                                        ais->type8.dac1fid17.targets[i].idtype,
+                                        idtypes[ais->type8.dac1fid17.targets[i].idtype].text);
                             switch (ais->type8.dac1fid17.targets[i].idtype) {
                                 case DAC1FID17_IDTYPE_MMSI:
-                                    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                                   "\"%s\":\"%u\",",
-                                                   idtypes[ais->type8.dac1fid17.targets[i].idtype],
-                                                   ais->type8.dac1fid17.targets[i].id.mmsi);
+                                    json_printf(&out,
+                                                "%s:\"%u\",",
+                                                idtypes[ais->type8.dac1fid17.targets[i].idtype].text,
+                                                ais->type8.dac1fid17.targets[i].id.mmsi);
                                     break;
                                 case DAC1FID17_IDTYPE_IMO:
-                                    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                                   "\"%s\":\"%u\",",
-                                                   idtypes[ais->type8.dac1fid17.targets[i].idtype],
-                                                   ais->type8.dac1fid17.targets[i].id.imo);
+                                    json_printf(&out,
+                                                "%s:\"%u\",",
+                                                idtypes[ais->type8.dac1fid17.targets[i].idtype].text,
+                                                ais->type8.dac1fid17.targets[i].id.imo);
                                     break;
                                 case DAC1FID17_IDTYPE_CALLSIGN:
-                                    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                                   "\"%s\":\"%s\",",
-                                                   idtypes[ais->type8.dac1fid17.targets[i].idtype],
-                                                   json_stringify(buf1, sizeof(buf1),
-                                                                  ais->type8.dac1fid17.targets[i].id.callsign));
+                                    json_printf(&out,
+                                                "%s:\"%s\",",
+                                                idtypes[ais->type8.dac1fid17.targets[i].idtype].text,
+                                                json_stringify(buf1, sizeof(buf1),
+                                                               ais->type8.dac1fid17.targets[i].id.callsign));
                                     break;
                                 default:
-                                    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                                   "\"%s\":\"%s\",",
-                                                   idtypes[ais->type8.dac1fid17.targets[i].idtype],
-                                                   json_stringify(buf1, sizeof(buf1),
-                                                                  ais->type8.dac1fid17.targets[i].id.other));
+                                    json_printf(&out,
+                                                "%s:\"%s\",",
+                                                idtypes[ais->type8.dac1fid17.targets[i].idtype].text,
+                                                json_stringify(buf1, sizeof(buf1),
+                                                               ais->type8.dac1fid17.targets[i].id.other));
                             }
                             if (scaled)
-                                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                               "\"lat\":%.3f,\"lon\":%.3f,",
-                                               ais->type8.dac1fid17.targets[i].lat / AIS_LATLON3_DIV,
-                                               ais->type8.dac1fid17.targets[i].lon / AIS_LATLON3_DIV);
+                                json_printf(&out,
+                                            "\"lat\":%.3f,\"lon\":%.3f,",
+                                            ais->type8.dac1fid17.targets[i].lat / AIS_LATLON3_DIV,
+                                            ais->type8.dac1fid17.targets[i].lon / AIS_LATLON3_DIV);
                             else
-                                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                               "\"lat\":%d,\"lon\":%d,",
-                                               ais->type8.dac1fid17.targets[i].lat,
-                                               ais->type8.dac1fid17.targets[i].lon);
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"course\":%u,\"second\":%u,\"speed\":%u},",
-                                           ais->type8.dac1fid17.targets[i].course,
-                                           ais->type8.dac1fid17.targets[i].second,
-                                           ais->type8.dac1fid17.targets[i].speed);
+                                json_printf(&out,
+                                            "\"lat\":%d,\"lon\":%d,",
+                                            ais->type8.dac1fid17.targets[i].lat,
+                                            ais->type8.dac1fid17.targets[i].lon);
+                            json_printf(&out,
+                                        "\"course\":%u,\"second\":%u,\"speed\":%u},",
+                                        ais->type8.dac1fid17.targets[i].course,
+                                        ais->type8.dac1fid17.targets[i].second,
+                                        ais->type8.dac1fid17.targets[i].speed);
                         }
-                        if (buf[strlen(buf) - 1] == ',')
-                            buf[strlen(buf) - 1] = '\0';
-                        (void)strlcat(buf, "]}\r\n", buflen);
+                        json_chomp(&out);
+                        json_puts(&out, "]}\r\n");
                         break;
                     case 19:        /* IMO289 - Marine Traffic Signal */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"linkage\":%u,\"station\":\"%s\","
-                                       "\"lon\":%.3f,\"lat\":%.3f,\"status\":%u,"
-                                       "\"signal\":%u,\"signal_text\":\"%s\","
-                                       "\"hour\":%u,\"minute\":%u,"
-                                       "\"nextsignal\":%u"
-                                       "\"nextsignal_text\":\"%s\""
-                                       "}\r\n",
-                                       ais->type8.dac1fid19.linkage,
-                                       json_stringify(buf1, sizeof(buf1),
-                                                      ais->type8.dac1fid19.station),
-                                       ais->type8.dac1fid19.lon / AIS_LATLON3_DIV,
-                                       ais->type8.dac1fid19.lat / AIS_LATLON3_DIV,
-                                       ais->type8.dac1fid19.status,
-                                       ais->type8.dac1fid19.signal,
-                                       SIGNAL_DISPLAY(ais->type8.dac1fid19.signal),
-                                       ais->type8.dac1fid19.hour,
-                                       ais->type8.dac1fid19.minute,
-                                       ais->type8.dac1fid19.nextsignal,
-                                       SIGNAL_DISPLAY(ais->type8.dac1fid19.nextsignal));
+                        json_printf(&out,
+                                    "\"linkage\":%u,\"station\":\"%s\","
+                                    "\"lon\":%.3f,\"lat\":%.3f,\"status\":%u,"
+                                    "\"signal\":%u,\"signal_text\":%s,"
+                                    "\"hour\":%u,\"minute\":%u,"
+                                    "\"nextsignal\":%u,"
+                                    "\"nextsignal_text\":%s"
+                                    "}\r\n",
+                                    ais->type8.dac1fid19.linkage,
+                                    json_stringify(buf1, sizeof(buf1),
+                                                   ais->type8.dac1fid19.station),
+                                    ais->type8.dac1fid19.lon / AIS_LATLON3_DIV,
+                                    ais->type8.dac1fid19.lat / AIS_LATLON3_DIV,
+                                    ais->type8.dac1fid19.status,
+                                    ais->type8.dac1fid19.signal,
+                                    SIGNAL_DISPLAY(ais->type8.dac1fid19.signal)->text,
+                                    ais->type8.dac1fid19.hour,
+                                    ais->type8.dac1fid19.minute,
+                                    ais->type8.dac1fid19.nextsignal,
+                                    SIGNAL_DISPLAY(ais->type8.dac1fid19.nextsignal)->text);
                         break;
                     case 21:        /* IMO289 - Weather obs. report from ship */
                         break;
@@ -1217,171 +1409,170 @@ void json_aivdm_dump(const struct ais_t *ais,
                     case 25:        /* IMO289 - Dangerous Cargo Indication */
                         break;
                     case 27:        /* IMO289 - Route information - broadcast */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"linkage\":%u,\"sender\":%u,"
-                                       "\"rtype\":%u,"
-                                       "\"rtype_text\":\"%s\","
-                                       "\"start\":\"%02u-%02uT%02u:%02uZ\","
-                                       "\"duration\":%u,\"waypoints\":[",
-                                       ais->type8.dac1fid27.linkage,
-                                       ais->type8.dac1fid27.sender,
-                                       ais->type8.dac1fid27.rtype,
-                                       route_type[ais->type8.dac1fid27.rtype],
-                                       ais->type8.dac1fid27.month,
-                                       ais->type8.dac1fid27.day,
-                                       ais->type8.dac1fid27.hour,
-                                       ais->type8.dac1fid27.minute,
-                                       ais->type8.dac1fid27.duration);
+                        json_printf(&out,
+                                    "\"linkage\":%u,\"sender\":%u,"
+                                    "\"rtype\":%u,"
+                                    "\"rtype_text\":%s,"
+                                    "\"start\":\"%02u-%02uT%02u:%02uZ\","
+                                    "\"duration\":%u,\"waypoints\":[",
+                                    ais->type8.dac1fid27.linkage,
+                                    ais->type8.dac1fid27.sender,
+                                    ais->type8.dac1fid27.rtype,
+                                    route_type[ais->type8.dac1fid27.rtype].text,
+                                    ais->type8.dac1fid27.month,
+                                    ais->type8.dac1fid27.day,
+                                    ais->type8.dac1fid27.hour,
+                                    ais->type8.dac1fid27.minute,
+                                    ais->type8.dac1fid27.duration);
                         for (i = 0; i < ais->type8.dac1fid27.waycount; i++) {
                             if (scaled)
-                                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                               "{\"lon\":%.4f,\"lat\":%.4f},",
-                                               ais->type8.dac1fid27.waypoints[i].lon / AIS_LATLON4_DIV,
-                                               ais->type8.dac1fid27.waypoints[i].lat / AIS_LATLON4_DIV);
+                                json_printf(&out,
+                                            "{\"lon\":%.4f,\"lat\":%.4f},",
+                                            ais->type8.dac1fid27.waypoints[i].lon / AIS_LATLON4_DIV,
+                                            ais->type8.dac1fid27.waypoints[i].lat / AIS_LATLON4_DIV);
                             else
-                                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                               "{\"lon\":%d,\"lat\":%d},",
-                                               ais->type8.dac1fid27.waypoints[i].lon,
-                                               ais->type8.dac1fid27.waypoints[i].lat);
+                                json_printf(&out,
+                                            "{\"lon\":%d,\"lat\":%d},",
+                                            ais->type8.dac1fid27.waypoints[i].lon,
+                                            ais->type8.dac1fid27.waypoints[i].lat);
                         }
-                        if (buf[strlen(buf) - 1] == ',')
-                            buf[strlen(buf) - 1] = '\0';
-                        (void)strlcat(buf, "]}\r\n", buflen);
+                        json_chomp(&out);
+                        json_puts(&out, "]}\r\n");
                         break;
                     case 29:        /* IMO289 - Text Description - broadcast */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"linkage\":%u,\"text\":\"%s\"}\r\n",
-                                       ais->type8.dac1fid29.linkage,
-                                       json_stringify(buf1, sizeof(buf1),
-                                                      ais->type8.dac1fid29.text));
+                        json_printf(&out,
+                                    "\"linkage\":%u,\"text\":\"%s\"}\r\n",
+                                    ais->type8.dac1fid29.linkage,
+                                    json_stringify(buf1, sizeof(buf1),
+                                                   ais->type8.dac1fid29.text));
                         break;
                     case 31:        /* IMO289 - Meteorological/Hydrological data */
                         /* some fields have been merged to an ISO8601 partial date */
                         /* layout is almost identical to FID=11 from IMO236 */
                         if (scaled)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"lat\":%.3f,\"lon\":%.3f,",
-                                           ais->type8.dac1fid31.lat / AIS_LATLON3_DIV,
-                                           ais->type8.dac1fid31.lon / AIS_LATLON3_DIV);
+                            json_printf(&out,
+                                        "\"lat\":%.3f,\"lon\":%.3f,",
+                                        ais->type8.dac1fid31.lat / AIS_LATLON3_DIV,
+                                        ais->type8.dac1fid31.lon / AIS_LATLON3_DIV);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"lat\":%d,\"lon\":%d,",
-                                           ais->type8.dac1fid31.lat,
-                                           ais->type8.dac1fid31.lon);
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"accuracy\":%s,",
-                                       JSON_BOOL(ais->type8.dac1fid31.accuracy));
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"timestamp\":\"%02uT%02u:%02uZ\","
-                                       "\"wspeed\":%u,\"wgust\":%u,\"wdir\":%u,"
-                                       "\"wgustdir\":%u,\"humidity\":%u,",
-                                       ais->type8.dac1fid31.day,
-                                       ais->type8.dac1fid31.hour,
-                                       ais->type8.dac1fid31.minute,
-                                       ais->type8.dac1fid31.wspeed,
-                                       ais->type8.dac1fid31.wgust,
-                                       ais->type8.dac1fid31.wdir,
-                                       ais->type8.dac1fid31.wgustdir,
-                                       ais->type8.dac1fid31.humidity);
+                            json_printf(&out,
+                                        "\"lat\":%d,\"lon\":%d,",
+                                        ais->type8.dac1fid31.lat,
+                                        ais->type8.dac1fid31.lon);
+                        json_printf(&out,
+                                    "\"accuracy\":%s,",
+                                    JSON_BOOL(ais->type8.dac1fid31.accuracy));
+                        json_printf(&out,
+                                    "\"timestamp\":\"%02uT%02u:%02uZ\","
+                                    "\"wspeed\":%u,\"wgust\":%u,\"wdir\":%u,"
+                                    "\"wgustdir\":%u,\"humidity\":%u,",
+                                    ais->type8.dac1fid31.day,
+                                    ais->type8.dac1fid31.hour,
+                                    ais->type8.dac1fid31.minute,
+                                    ais->type8.dac1fid31.wspeed,
+                                    ais->type8.dac1fid31.wgust,
+                                    ais->type8.dac1fid31.wdir,
+                                    ais->type8.dac1fid31.wgustdir,
+                                    ais->type8.dac1fid31.humidity);
                         if (scaled)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"airtemp\":%.1f,\"dewpoint\":%.1f,"
-                                           "\"pressure\":%u,\"pressuretend\":\"%s\","
-                                           "\"visgreater\":%s,",
-                                           ais->type8.dac1fid31.airtemp / DAC1FID31_AIRTEMP_DIV,
-                                           ais->type8.dac1fid31.dewpoint / DAC1FID31_DEWPOINT_DIV,
-                                           ais->type8.dac1fid31.pressure - DAC1FID31_PRESSURE_OFFSET,
-                                           trends[ais->type8.dac1fid31.pressuretend],
-                                           JSON_BOOL(ais->type8.dac1fid31.visgreater));
+                            json_printf(&out,
+                                        "\"airtemp\":%.1f,\"dewpoint\":%.1f,"
+                                        "\"pressure\":%u,\"pressuretend\":%s,"
+                                        "\"visgreater\":%s,",
+                                        ais->type8.dac1fid31.airtemp / DAC1FID31_AIRTEMP_DIV,
+                                        ais->type8.dac1fid31.dewpoint / DAC1FID31_DEWPOINT_DIV,
+                                        ais->type8.dac1fid31.pressure - DAC1FID31_PRESSURE_OFFSET,
+                                        trends[ais->type8.dac1fid31.pressuretend].text,
+                                        JSON_BOOL(ais->type8.dac1fid31.visgreater));
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"airtemp\":%d,\"dewpoint\":%d,"
-                                           "\"pressure\":%u,\"pressuretend\":%u,"
-                                           "\"visgreater\":%s,",
-                                           ais->type8.dac1fid31.airtemp,
-                                           ais->type8.dac1fid31.dewpoint,
-                                           ais->type8.dac1fid31.pressure,
-                                           ais->type8.dac1fid31.pressuretend,
-                                           JSON_BOOL(ais->type8.dac1fid31.visgreater));
+                            json_printf(&out,
+                                        "\"airtemp\":%d,\"dewpoint\":%d,"
+                                        "\"pressure\":%u,\"pressuretend\":%u,"
+                                        "\"visgreater\":%s,",
+                                        ais->type8.dac1fid31.airtemp,
+                                        ais->type8.dac1fid31.dewpoint,
+                                        ais->type8.dac1fid31.pressure,
+                                        ais->type8.dac1fid31.pressuretend,
+                                        JSON_BOOL(ais->type8.dac1fid31.visgreater));
                         
                         if (scaled)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"visibility\":%.1f,",
-                                           ais->type8.dac1fid31.visibility / DAC1FID31_VISIBILITY_DIV);
+                            json_printf(&out,
+                                        "\"visibility\":%.1f,",
+                                        ais->type8.dac1fid31.visibility / DAC1FID31_VISIBILITY_DIV);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"visibility\":%u,",
-                                           ais->type8.dac1fid31.visibility);
+                            json_printf(&out,
+                                        "\"visibility\":%u,",
+                                        ais->type8.dac1fid31.visibility);
                         if (!scaled)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"waterlevel\":%d,",
-                                           ais->type8.dac1fid31.waterlevel);
+                            json_printf(&out,
+                                        "\"waterlevel\":%d,",
+                                        ais->type8.dac1fid31.waterlevel);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"waterlevel\":%.1f,",
-                                           (ais->type8.dac1fid31.waterlevel - DAC1FID31_WATERLEVEL_OFFSET) / DAC1FID31_WATERLEVEL_DIV);
+                            json_printf(&out,
+                                        "\"waterlevel\":%.1f,",
+                                        (ais->type8.dac1fid31.waterlevel - DAC1FID31_WATERLEVEL_OFFSET) / DAC1FID31_WATERLEVEL_DIV);
                         
                         if (scaled) {
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"leveltrend\":\"%s\","
-                                           "\"cspeed\":%.1f,\"cdir\":%u,"
-                                           "\"cspeed2\":%.1f,\"cdir2\":%u,\"cdepth2\":%u,"
-                                           "\"cspeed3\":%.1f,\"cdir3\":%u,\"cdepth3\":%u,"
-                                           "\"waveheight\":%.1f,\"waveperiod\":%u,\"wavedir\":%u,"
-                                           "\"swellheight\":%.1f,\"swellperiod\":%u,\"swelldir\":%u,"
-                                           "\"seastate\":%u,\"watertemp\":%.1f,"
-                                           "\"preciptype\":\"%s\",\"salinity\":%.1f,\"ice\":\"%s\"",
-                                           trends[ais->type8.dac1fid31.leveltrend],
-                                           ais->type8.dac1fid31.cspeed / DAC1FID31_CSPEED_DIV,
-                                           ais->type8.dac1fid31.cdir,
-                                           ais->type8.dac1fid31.cspeed2 / DAC1FID31_CSPEED_DIV,
-                                           ais->type8.dac1fid31.cdir2,
-                                           ais->type8.dac1fid31.cdepth2,
-                                           ais->type8.dac1fid31.cspeed3 / DAC1FID31_CSPEED_DIV,
-                                           ais->type8.dac1fid31.cdir3,
-                                           ais->type8.dac1fid31.cdepth3,
-                                           ais->type8.dac1fid31.waveheight / DAC1FID31_HEIGHT_DIV,
-                                           ais->type8.dac1fid31.waveperiod,
-                                           ais->type8.dac1fid31.wavedir,
-                                           ais->type8.dac1fid31.swellheight / DAC1FID31_HEIGHT_DIV,
-                                           ais->type8.dac1fid31.swellperiod,
-                                           ais->type8.dac1fid31.swelldir,
-                                           ais->type8.dac1fid31.seastate,
-                                           ais->type8.dac1fid31.watertemp / DAC1FID31_WATERTEMP_DIV,
-                                           preciptypes[ais->type8.dac1fid31.preciptype],
-                                           ais->type8.dac1fid31.salinity / DAC1FID31_SALINITY_DIV,
-                                           ice[ais->type8.dac1fid31.ice]);
+                            json_printf(&out,
+                                        "\"leveltrend\":%s,"
+                                        "\"cspeed\":%.1f,\"cdir\":%u,"
+                                        "\"cspeed2\":%.1f,\"cdir2\":%u,\"cdepth2\":%u,"
+                                        "\"cspeed3\":%.1f,\"cdir3\":%u,\"cdepth3\":%u,"
+                                        "\"waveheight\":%.1f,\"waveperiod\":%u,\"wavedir\":%u,"
+                                        "\"swellheight\":%.1f,\"swellperiod\":%u,\"swelldir\":%u,"
+                                        "\"seastate\":%u,\"watertemp\":%.1f,"
+                                        "\"preciptype\":%s,\"salinity\":%.1f,\"ice\":%s",
+                                        trends[ais->type8.dac1fid31.leveltrend].text,
+                                        ais->type8.dac1fid31.cspeed / DAC1FID31_CSPEED_DIV,
+                                        ais->type8.dac1fid31.cdir,
+                                        ais->type8.dac1fid31.cspeed2 / DAC1FID31_CSPEED_DIV,
+                                        ais->type8.dac1fid31.cdir2,
+                                        ais->type8.dac1fid31.cdepth2,
+                                        ais->type8.dac1fid31.cspeed3 / DAC1FID31_CSPEED_DIV,
+                                        ais->type8.dac1fid31.cdir3,
+                                        ais->type8.dac1fid31.cdepth3,
+                                        ais->type8.dac1fid31.waveheight / DAC1FID31_HEIGHT_DIV,
+                                        ais->type8.dac1fid31.waveperiod,
+                                        ais->type8.dac1fid31.wavedir,
+                                        ais->type8.dac1fid31.swellheight / DAC1FID31_HEIGHT_DIV,
+                                        ais->type8.dac1fid31.swellperiod,
+                                        ais->type8.dac1fid31.swelldir,
+                                        ais->type8.dac1fid31.seastate,
+                                        ais->type8.dac1fid31.watertemp / DAC1FID31_WATERTEMP_DIV,
+                                        preciptypes[ais->type8.dac1fid31.preciptype].text,
+                                        ais->type8.dac1fid31.salinity / DAC1FID31_SALINITY_DIV,
+                                        ice[ais->type8.dac1fid31.ice].text);
                         } else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"leveltrend\":%u,"
-                                           "\"cspeed\":%u,\"cdir\":%u,"
-                                           "\"cspeed2\":%u,\"cdir2\":%u,\"cdepth2\":%u,"
-                                           "\"cspeed3\":%u,\"cdir3\":%u,\"cdepth3\":%u,"
-                                           "\"waveheight\":%u,\"waveperiod\":%u,\"wavedir\":%u,"
-                                           "\"swellheight\":%u,\"swellperiod\":%u,\"swelldir\":%u,"
-                                           "\"seastate\":%u,\"watertemp\":%d,"
-                                           "\"preciptype\":%u,\"salinity\":%u,\"ice\":%u",
-                                           ais->type8.dac1fid31.leveltrend,
-                                           ais->type8.dac1fid31.cspeed,
-                                           ais->type8.dac1fid31.cdir,
-                                           ais->type8.dac1fid31.cspeed2,
-                                           ais->type8.dac1fid31.cdir2,
-                                           ais->type8.dac1fid31.cdepth2,
-                                           ais->type8.dac1fid31.cspeed3,
-                                           ais->type8.dac1fid31.cdir3,
-                                           ais->type8.dac1fid31.cdepth3,
-                                           ais->type8.dac1fid31.waveheight,
-                                           ais->type8.dac1fid31.waveperiod,
-                                           ais->type8.dac1fid31.wavedir,
-                                           ais->type8.dac1fid31.swellheight,
-                                           ais->type8.dac1fid31.swellperiod,
-                                           ais->type8.dac1fid31.swelldir,
-                                           ais->type8.dac1fid31.seastate,
-                                           ais->type8.dac1fid31.watertemp,
-                                           ais->type8.dac1fid31.preciptype,
-                                           ais->type8.dac1fid31.salinity,
-                                           ais->type8.dac1fid31.ice);
-                        (void)strlcat(buf, "}\r\n", buflen);
+                            json_printf(&out,
+                                        "\"leveltrend\":%u,"
+                                        "\"cspeed\":%u,\"cdir\":%u,"
+                                        "\"cspeed2\":%u,\"cdir2\":%u,\"cdepth2\":%u,"
+                                        "\"cspeed3\":%u,\"cdir3\":%u,\"cdepth3\":%u,"
+                                        "\"waveheight\":%u,\"waveperiod\":%u,\"wavedir\":%u,"
+                                        "\"swellheight\":%u,\"swellperiod\":%u,\"swelldir\":%u,"
+                                        "\"seastate\":%u,\"watertemp\":%d,"
+                                        "\"preciptype\":%u,\"salinity\":%u,\"ice\":%u",
+                                        ais->type8.dac1fid31.leveltrend,
+                                        ais->type8.dac1fid31.cspeed,
+                                        ais->type8.dac1fid31.cdir,
+                                        ais->type8.dac1fid31.cspeed2,
+                                        ais->type8.dac1fid31.cdir2,
+                                        ais->type8.dac1fid31.cdepth2,
+                                        ais->type8.dac1fid31.cspeed3,
+                                        ais->type8.dac1fid31.cdir3,
+                                        ais->type8.dac1fid31.cdepth3,
+                                        ais->type8.dac1fid31.waveheight,
+                                        ais->type8.dac1fid31.waveperiod,
+                                        ais->type8.dac1fid31.wavedir,
+                                        ais->type8.dac1fid31.swellheight,
+                                        ais->type8.dac1fid31.swellperiod,
+                                        ais->type8.dac1fid31.swelldir,
+                                        ais->type8.dac1fid31.seastate,
+                                        ais->type8.dac1fid31.watertemp,
+                                        ais->type8.dac1fid31.preciptype,
+                                        ais->type8.dac1fid31.salinity,
+                                        ais->type8.dac1fid31.ice);
+                        json_puts(&out, "}\r\n");
                         break;
                 }
             }
@@ -1439,71 +1630,71 @@ void json_aivdm_dump(const struct ais_t *ais,
                     {8370, 80, "Pushtow, seven barges at least one tanker or gas barg"},
                     {0, 0, "Illegal ship type value."},
                 };
-                const char *hazard_types[] = {
-                    "0 blue cones/lights",
-                    "1 blue cone/light",
-                    "2 blue cones/lights",
-                    "3 blue cones/lights",
-                    "4 B-Flag",
-                    "Unknown",
+                static const struct json_legend_t hazard_types[] = {
+                    JSON_LEGEND("0 blue cones/lights"),
+                    JSON_LEGEND("1 blue cone/light"),
+                    JSON_LEGEND("2 blue cones/lights"),
+                    JSON_LEGEND("3 blue cones/lights"),
+                    JSON_LEGEND("4 B-Flag"),
+                    JSON_LEGEND("Unknown"),
                 };
-#define HTYPE_DISPLAY(n) (((n) < (unsigned int)NITEMS(hazard_types)) ? hazard_types[n] : "INVALID HAZARD TYPE")
-                const char *lstatus_types[] = {
-                    "N/A (default)",
-                    "Unloaded",
-                    "Loaded",
+#define HTYPE_DISPLAY(n) JSON_LEGEND_AT(hazard_types, n, "INVALID HAZARD TYPE")
+                static const struct json_legend_t lstatus_types[] = {
+                    JSON_LEGEND("N/A (default)"),
+                    JSON_LEGEND("Unloaded"),
+                    JSON_LEGEND("Loaded"),
                 };
-#define LSTATUS_DISPLAY(n) (((n) < (unsigned int)NITEMS(lstatus_types)) ? lstatus_types[n] : "INVALID LOAD STATUS")
-                const char *emma_types[] = {
-                    "Not Available",
-                    "Wind",
-                    "Rain",
-                    "Snow and ice",
-                    "Thunderstorm",
-                    "Fog",
-                    "Low temperature",
-                    "High temperature",
-                    "Flood",
-                    "Forest Fire",
+#define LSTATUS_DISPLAY(n) JSON_LEGEND_AT(lstatus_types, n, "INVALID LOAD STATUS")
+                static const struct json_legend_t emma_types[] = {
+                    JSON_LEGEND("Not Available"),
+                    JSON_LEGEND("Wind"),
+                    JSON_LEGEND("Rain"),
+                    JSON_LEGEND("Snow and ice"),
+                    JSON_LEGEND("Thunderstorm"),
+                    JSON_LEGEND("Fog"),
+                    JSON_LEGEND("Low temperature"),
+                    JSON_LEGEND("High temperature"),
+                    JSON_LEGEND("Flood"),
+                    JSON_LEGEND("Forest Fire"),
                 };
-#define EMMA_TYPE_DISPLAY(n) (((n) < (unsigned int)NITEMS(emma_types)) ? emma_types[n] : "INVALID EMMA TYPE")
-                const char *emma_classes[] = {
-                    "Slight",
-                    "Medium",
-                    "Strong",
+#define EMMA_TYPE_DISPLAY(n) JSON_LEGEND_AT(emma_types, n, "INVALID EMMA TYPE")
+                static const struct json_legend_t emma_classes[] = {
+                    JSON_LEGEND("Slight"),
+                    JSON_LEGEND("Medium"),
+                    JSON_LEGEND("Strong"),
                 };
-#define EMMA_CLASS_DISPLAY(n) (((n) < (unsigned int)NITEMS(emma_classes)) ? emma_classes[n] : "INVALID EMMA TYPE")
-                const char *emma_winds[] = {
-                    "N/A",
-                    "North",
-                    "North East",
-                    "East",
-                    "South East",
-                    "South",
-                    "South West",
-                    "West",
-                    "North West",
+#define EMMA_CLASS_DISPLAY(n) JSON_LEGEND_AT(emma_classes, n, "INVALID EMMA TYPE")
+                static const struct json_legend_t emma_winds[] = {
+                    JSON_LEGEND("N/A"),
+                    JSON_LEGEND("North"),
+                    JSON_LEGEND("North East"),
+                    JSON_LEGEND("East"),
+                    JSON_LEGEND("South East"),
+                    JSON_LEGEND("South"),
+                    JSON_LEGEND("South West"),
+                    JSON_LEGEND("West"),
+                    JSON_LEGEND("North West"),
                 };
-#define EMMA_WIND_DISPLAY(n) (((n) < (unsigned int)NITEMS(emma_winds)) ? emma_winds[n] : "INVALID EMMA WIND DIRECTION")
-                const char *direction_vocabulary[] = {
-                    "Unknown",
-                    "Upstream",
-                    "Downstream",
-                    "To left bank",
-                    "To right bank",
+#define EMMA_WIND_DISPLAY(n) JSON_LEGEND_AT(emma_winds, n, "INVALID EMMA WIND DIRECTION")
+                static const struct json_legend_t direction_vocabulary[] = {
+                    JSON_LEGEND("Unknown"),
+                    JSON_LEGEND("Upstream"),
+                    JSON_LEGEND("Downstream"),
+                    JSON_LEGEND("To left bank"),
+                    JSON_LEGEND("To right bank"),
                 };
-#define DIRECTION_DISPLAY(n) (((n) < (unsigned int)NITEMS(direction_vocabulary)) ? direction_vocabulary[n] : "INVALID DIRECTION")
-                const char *status_vocabulary[] = {
-                    "Unknown",
-                    "No light",
-                    "White",
-                    "Yellow",
-                    "Green",
-                    "Red",
-                    "White flashing",
-                    "Yellow flashing.",
+#define DIRECTION_DISPLAY(n) JSON_LEGEND_AT(direction_vocabulary, n, "INVALID DIRECTION")
+                static const struct json_legend_t status_vocabulary[] = {
+                    JSON_LEGEND("Unknown"),
+                    JSON_LEGEND("No light"),
+                    JSON_LEGEND("White"),
+                    JSON_LEGEND("Yellow"),
+                    JSON_LEGEND("Green"),
+                    JSON_LEGEND("Red"),
+                    JSON_LEGEND("White flashing"),
+                    JSON_LEGEND("Yellow flashing."),
                 };
-#define STATUS_DISPLAY(n) (((n) < (unsigned int)NITEMS(status_vocabulary)) ? status_vocabulary[n] : "INVALID STATUS")
+#define STATUS_DISPLAY(n) JSON_LEGEND_AT(status_vocabulary, n, "INVALID STATUS")
                 
                 switch (ais->type8.fid) {
                     case 10:        /* Inland ship static and voyage-related data */
@@ -1512,104 +1703,103 @@ void json_aivdm_dump(const struct ais_t *ais,
                                 || cp->ais == ais->type8.dac200fid10.shiptype
                                 || cp->code == 0)
                                 break;
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"vin\":\"%s\",\"length\":%u,\"beam\":%u,"
-                                       "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-                                       "\"hazard\":%u,\"hazard_text\":\"%s\","
-                                       "\"draught\":%u,"
-                                       "\"loaded\":%u,\"loaded_text\":\"%s\","
-                                       "\"speed_q\":%s,"
-                                       "\"course_q\":%s,"
-                                       "\"heading_q\":%s}\r\n",
-                                       ais->type8.dac200fid10.vin,
-                                       ais->type8.dac200fid10.length,
-                                       ais->type8.dac200fid10.beam,
-                                       ais->type8.dac200fid10.shiptype,
-                                       cp->legend,
-                                       ais->type8.dac200fid10.hazard,
-                                       HTYPE_DISPLAY(ais->type8.dac200fid10.hazard),
-                                       ais->type8.dac200fid10.draught,
-                                       ais->type8.dac200fid10.loaded,
-                                       LSTATUS_DISPLAY(ais->type8.dac200fid10.loaded),
-                                       JSON_BOOL(ais->type8.dac200fid10.speed_q),
-                                       JSON_BOOL(ais->type8.dac200fid10.course_q),
-                                       JSON_BOOL(ais->type8.dac200fid10.heading_q));
+                        json_printf(&out,
+                                    "\"vin\":\"%s\",\"length\":%u,\"beam\":%u,"
+                                    "\"shiptype\":%u,\"shiptype_text\":\"%s\","
+                                    "\"hazard\":%u,\"hazard_text\":%s,"
+                                    "\"draught\":%u,"
+                                    "\"loaded\":%u,\"loaded_text\":%s,"
+                                    "\"speed_q\":%s,"
+                                    "\"course_q\":%s,"
+                                    "\"heading_q\":%s}\r\n",
+                                    ais->type8.dac200fid10.vin,
+                                    ais->type8.dac200fid10.length,
+                                    ais->type8.dac200fid10.beam,
+                                    ais->type8.dac200fid10.shiptype,
+                                    cp->legend,
+                                    ais->type8.dac200fid10.hazard,
+                                    HTYPE_DISPLAY(ais->type8.dac200fid10.hazard)->text,
+                                    ais->type8.dac200fid10.draught,
+                                    ais->type8.dac200fid10.loaded,
+                                    LSTATUS_DISPLAY(ais->type8.dac200fid10.loaded)->text,
+                                    JSON_BOOL(ais->type8.dac200fid10.speed_q),
+                                    JSON_BOOL(ais->type8.dac200fid10.course_q),
+                                    JSON_BOOL(ais->type8.dac200fid10.heading_q));
                         break;
                     case 23:	/* EMMA warning */
                         if (!ais->type8.structured)
                             break;
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"start\":\"%4u-%02u-%02uT%02u:%02u\","
-                                       "\"end\":\"%4u-%02u-%02uT%02u:%02u\",",
-                                       ais->type8.dac200fid23.start_year + 2000,
-                                       ais->type8.dac200fid23.start_month,
-                                       ais->type8.dac200fid23.start_hour,
-                                       ais->type8.dac200fid23.start_minute,
-                                       ais->type8.dac200fid23.start_day,
-                                       ais->type8.dac200fid23.end_year + 2000,
-                                       ais->type8.dac200fid23.end_month,
-                                       ais->type8.dac200fid23.end_day,
-                                       ais->type8.dac200fid23.end_hour,
-                                       ais->type8.dac200fid23.end_minute);
+                        json_printf(&out,
+                                    "\"start\":\"%4u-%02u-%02uT%02u:%02u\","
+                                    "\"end\":\"%4u-%02u-%02uT%02u:%02u\",",
+                                    ais->type8.dac200fid23.start_year + 2000,
+                                    ais->type8.dac200fid23.start_month,
+                                    ais->type8.dac200fid23.start_hour,
+                                    ais->type8.dac200fid23.start_minute,
+                                    ais->type8.dac200fid23.start_day,
+                                    ais->type8.dac200fid23.end_year + 2000,
+                                    ais->type8.dac200fid23.end_month,
+                                    ais->type8.dac200fid23.end_day,
+                                    ais->type8.dac200fid23.end_hour,
+                                    ais->type8.dac200fid23.end_minute);
                         if (scaled)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"start_lon\":%.4f,\"start_lat\":%.4f,\"end_lon\":%.4f,\"end_lat\":%.4f,",
-                                           ais->type8.dac200fid23.start_lon / AIS_LATLON_DIV,
-                                           ais->type8.dac200fid23.start_lat / AIS_LATLON_DIV,
-                                           ais->type8.dac200fid23.end_lon / AIS_LATLON_DIV,
-                                           ais->type8.dac200fid23.end_lat / AIS_LATLON_DIV);
+                            json_printf(&out,
+                                        "\"start_lon\":%.4f,\"start_lat\":%.4f,\"end_lon\":%.4f,\"end_lat\":%.4f,",
+                                        ais->type8.dac200fid23.start_lon / AIS_LATLON_DIV,
+                                        ais->type8.dac200fid23.start_lat / AIS_LATLON_DIV,
+                                        ais->type8.dac200fid23.end_lon / AIS_LATLON_DIV,
+                                        ais->type8.dac200fid23.end_lat / AIS_LATLON_DIV);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"start_lon\":%d,\"start_lat\":%d,\"end_lon\":%d,\"end_lat\":%d,",
-                                           ais->type8.dac200fid23.start_lon,
-                                           ais->type8.dac200fid23.start_lat,
-                                           ais->type8.dac200fid23.end_lon,
-                                           ais->type8.dac200fid23.end_lat);
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"type\":%u,\"type_text\":\"%s\",\"min\":%d,\"max\":%d,\"class\":%u,\"class_text\":\"%s\",\"wind\":%u,\"wind_text\":\"%s\"}\r\n",
-                                       
-                                       ais->type8.dac200fid23.type,
-                                       EMMA_TYPE_DISPLAY(ais->type8.dac200fid23.type),
-                                       ais->type8.dac200fid23.min,
-                                       ais->type8.dac200fid23.max,
-                                       ais->type8.dac200fid23.intensity,
-                                       EMMA_CLASS_DISPLAY(ais->type8.dac200fid23.intensity),
-                                       ais->type8.dac200fid23.wind,
-                                       EMMA_WIND_DISPLAY(ais->type8.dac200fid23.wind));
+                            json_printf(&out,
+                                        "\"start_lon\":%d,\"start_lat\":%d,\"end_lon\":%d,\"end_lat\":%d,",
+                                        ais->type8.dac200fid23.start_lon,
+                                        ais->type8.dac200fid23.start_lat,
+                                        ais->type8.dac200fid23.end_lon,
+                                        ais->type8.dac200fid23.end_lat);
+                        json_printf(&out,
+                                    "\"type\":%u,\"type_text\":%s,\"min\":%d,\"max\":%d,\"class\":%u,\"class_text\":%s,\"wind\":%u,\"wind_text\":%s}\r\n",
+                                    
+                                    ais->type8.dac200fid23.type,
+                                    EMMA_TYPE_DISPLAY(ais->type8.dac200fid23.type)->text,
+                                    ais->type8.dac200fid23.min,
+                                    ais->type8.dac200fid23.max,
+                                    ais->type8.dac200fid23.intensity,
+                                    EMMA_CLASS_DISPLAY(ais->type8.dac200fid23.intensity)->text,
+                                    ais->type8.dac200fid23.wind,
+                                    EMMA_WIND_DISPLAY(ais->type8.dac200fid23.wind)->text);
                         break;
                     case 24:	/* Inland AIS Water Levels */
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"country\":\"%s\",\"gauges\":[",
-                                       ais->type8.dac200fid24.country);
+                        json_printf(&out,
+                                    "\"country\":\"%s\",\"gauges\":[",
+                                    ais->type8.dac200fid24.country);
                         for (i = 0; i < ais->type8.dac200fid24.ngauges; i++) {
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "{\"id\":%u,\"level\":%d}",
-                                           ais->type8.dac200fid24.gauges[i].id,
-                                           ais->type8.dac200fid24.gauges[i].level);
+                            json_printf(&out,
+                                        "{\"id\":%u,\"level\":%d}",
+                                        ais->type8.dac200fid24.gauges[i].id,
+                                        ais->type8.dac200fid24.gauges[i].level);
                         }
-                        if (buf[strlen(buf)-1] == ',')
-                            buf[strlen(buf)-1] = '\0';
-                        (void)strlcat(buf, "]}\r\n", buflen - strlen(buf));
+                        json_chomp(&out);
+                        json_puts(&out, "]}\r\n");
                         break;
                     case 40:	/* Inland AIS Signal Strength */
                         if (scaled)
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"lon\":%.4f,\"lat\":%.4f,",
-                                           ais->type8.dac200fid40.lon / AIS_LATLON_DIV,
-                                           ais->type8.dac200fid40.lat / AIS_LATLON_DIV);
+                            json_printf(&out,
+                                        "\"lon\":%.4f,\"lat\":%.4f,",
+                                        ais->type8.dac200fid40.lon / AIS_LATLON_DIV,
+                                        ais->type8.dac200fid40.lat / AIS_LATLON_DIV);
                         else
-                            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                           "\"lon\":%d,\"lat\":%d,",
-                                           ais->type8.dac200fid40.lon,
-                                           ais->type8.dac200fid40.lat);
-                        (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                       "\"form\":%u,\"facing\":%u,\"direction\":%u,\"direction_text\":\"%s\",\"status\":%u,\"status_text\":\"%s\"}\r\n",
-                                       ais->type8.dac200fid40.form,
-                                       ais->type8.dac200fid40.facing,
-                                       ais->type8.dac200fid40.direction,
-                                       DIRECTION_DISPLAY(ais->type8.dac200fid40.direction),
-                                       ais->type8.dac200fid40.status,
-                                       STATUS_DISPLAY(ais->type8.dac200fid40.status));
+                            json_printf(&out,
+                                        "\"lon\":%d,\"lat\":%d,",
+                                        ais->type8.dac200fid40.lon,
+                                        ais->type8.dac200fid40.lat);
+                        json_printf(&out,
+                                    "\"form\":%u,\"facing\":%u,\"direction\":%u,\"direction_text\":%s,\"status\":%u,\"status_text\":%s}\r\n",
+                                    ais->type8.dac200fid40.form,
+                                    ais->type8.dac200fid40.facing,
+                                    ais->type8.dac200fid40.direction,
+                                    DIRECTION_DISPLAY(ais->type8.dac200fid40.direction)->text,
+                                    ais->type8.dac200fid40.status,
+                                    STATUS_DISPLAY(ais->type8.dac200fid40.status)->text);
                         break;
                 }
             }
@@ -1633,7 +1823,7 @@ void json_aivdm_dump(const struct ais_t *ais,
                 
                 /*
                  * Express speed as nan if not available,
-                 * "high" for above the reporting ceiling.
+                 * "fast" for above the reporting ceiling.
                  */
                 if (ais->type9.speed == AIS_SAR_SPEED_NOT_AVAILABLE)
                     (void)strlcpy(speedlegend, "\"nan\"", sizeof(speedlegend));
@@ -1641,477 +1831,485 @@ void json_aivdm_dump(const struct ais_t *ais,
                     (void)strlcpy(speedlegend, "\"fast\"", sizeof(speedlegend));
                 else
                     (void)snprintf(speedlegend, sizeof(speedlegend),
-                                   "%u", ais->type1.speed);
+                                   "%u", ais->type9.speed);
                 
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"alt\":%s,\"speed\":%s,\"accuracy\":%s,"
-                               "\"lon\":%.4f,\"lat\":%.4f,\"course\":%.1f,"
-                               "\"second\":%u,\"regional\":%u,\"dte\":%u,"
-                               "\"raim\":%s,\"radio\":%u}\r\n",
-                               altlegend,
-                               speedlegend,
-                               JSON_BOOL(ais->type9.accuracy),
-                               ais->type9.lon / AIS_LATLON_DIV,
-                               ais->type9.lat / AIS_LATLON_DIV,
-                               ais->type9.course / 10.0,
-                               ais->type9.second,
-                               ais->type9.regional,
-                               ais->type9.dte,
-                               JSON_BOOL(ais->type9.raim), ais->type9.radio);
+                json_printf(&out,
+                            "\"alt\":%s,\"speed\":%s,\"accuracy\":%s,"
+                            "\"lon\":%.4f,\"lat\":%.4f,\"course\":%.1f,"
+                            "\"second\":%u,\"regional\":%u,\"dte\":%u,"
+                            "\"raim\":%s,\"radio\":%u}\r\n",
+                            altlegend,
+                            speedlegend,
+                            JSON_BOOL(ais->type9.accuracy),
+                            ais->type9.lon / AIS_LATLON_DIV,
+                            ais->type9.lat / AIS_LATLON_DIV,
+                            ais->type9.course / 10.0,
+                            ais->type9.second,
+                            ais->type9.regional,
+                            ais->type9.dte,
+                            JSON_BOOL(ais->type9.raim), ais->type9.radio);
             } else {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"alt\":%u,\"speed\":%u,\"accuracy\":%s,"
-                               "\"lon\":%d,\"lat\":%d,\"course\":%u,"
-                               "\"second\":%u,\"regional\":%u,\"dte\":%u,"
-                               "\"raim\":%s,\"radio\":%u}\r\n",
-                               ais->type9.alt,
-                               ais->type9.speed,
-                               JSON_BOOL(ais->type9.accuracy),
-                               ais->type9.lon,
-                               ais->type9.lat,
-                               ais->type9.course,
-                               ais->type9.second,
-                               ais->type9.regional,
-                               ais->type9.dte,
-                               JSON_BOOL(ais->type9.raim), ais->type9.radio);
+                json_printf(&out,
+                            "\"alt\":%u,\"speed\":%u,\"accuracy\":%s,"
+                            "\"lon\":%d,\"lat\":%d,\"course\":%u,"
+                            "\"second\":%u,\"regional\":%u,\"dte\":%u,"
+                            "\"raim\":%s,\"radio\":%u}\r\n",
+                            ais->type9.alt,
+                            ais->type9.speed,
+                            JSON_BOOL(ais->type9.accuracy),
+                            ais->type9.lon,
+                            ais->type9.lat,
+                            ais->type9.course,
+                            ais->type9.second,
+                            ais->type9.regional,
+                            ais->type9.dte,
+                            JSON_BOOL(ais->type9.raim), ais->type9.radio);
             }
             break;
         case 10:			/* UTC/Date Inquiry */
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "\"dest_mmsi\":%u}\r\n", ais->type10.dest_mmsi);
+            json_printf(&out,
+                        "\"dest_mmsi\":%u}\r\n", ais->type10.dest_mmsi);
             break;
         case 12:			/* Safety Related Message */
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "\"seqno\":%u,\"dest_mmsi\":%u,\"retransmit\":%s,\"text\":\"%s\"}\r\n",
-                           ais->type12.seqno,
-                           ais->type12.dest_mmsi,
-                           JSON_BOOL(ais->type12.retransmit),
-                           json_stringify(buf1, sizeof(buf1), ais->type12.text));
+            json_printf(&out,
+                        "\"seqno\":%u,\"dest_mmsi\":%u,\"retransmit\":%s,\"text\":\"%s\"}\r\n",
+                        ais->type12.seqno,
+                        ais->type12.dest_mmsi,
+                        JSON_BOOL(ais->type12.retransmit),
+                        json_stringify(buf1, sizeof(buf1), ais->type12.text));
             break;
         case 14:			/* Safety Related Broadcast Message */
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "\"text\":\"%s\"}\r\n",
-                           json_stringify(buf1, sizeof(buf1), ais->type14.text));
+            json_printf(&out,
+                        "\"text\":\"%s\"}\r\n",
+                        json_stringify(buf1, sizeof(buf1), ais->type14.text));
             break;
         case 15:			/* Interrogation */
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "\"mmsi1\":%u,\"type1_1\":%u,\"offset1_1\":%u,"
-                           "\"type1_2\":%u,\"offset1_2\":%u,\"mmsi2\":%u,"
-                           "\"type2_1\":%u,\"offset2_1\":%u}\r\n",
-                           ais->type15.mmsi1,
-                           ais->type15.type1_1,
-                           ais->type15.offset1_1,
-                           ais->type15.type1_2,
-                           ais->type15.offset1_2,
-                           ais->type15.mmsi2,
-                           ais->type15.type2_1, ais->type15.offset2_1);
+            json_printf(&out,
+                        "\"mmsi1\":%u,\"type1_1\":%u,\"offset1_1\":%u,"
+                        "\"type1_2\":%u,\"offset1_2\":%u,\"mmsi2\":%u,"
+                        "\"type2_1\":%u,\"offset2_1\":%u}\r\n",
+                        ais->type15.mmsi1,
+                        ais->type15.type1_1,
+                        ais->type15.offset1_1,
+                        ais->type15.type1_2,
+                        ais->type15.offset1_2,
+                        ais->type15.mmsi2,
+                        ais->type15.type2_1, ais->type15.offset2_1);
             break;
         case 16:
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "\"mmsi1\":%u,\"offset1\":%u,\"increment1\":%u,"
-                           "\"mmsi2\":%u,\"offset2\":%u,\"increment2\":%u}\r\n",
-                           ais->type16.mmsi1,
-                           ais->type16.offset1,
-                           ais->type16.increment1,
-                           ais->type16.mmsi2,
-                           ais->type16.offset2, ais->type16.increment2);
+            json_printf(&out,
+                        "\"mmsi1\":%u,\"offset1\":%u,\"increment1\":%u,"
+                        "\"mmsi2\":%u,\"offset2\":%u,\"increment2\":%u}\r\n",
+                        ais->type16.mmsi1,
+                        ais->type16.offset1,
+                        ais->type16.increment1,
+                        ais->type16.mmsi2,
+                        ais->type16.offset2, ais->type16.increment2);
             break;
         case 17:
             if (scaled) {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"lon\":%.1f,\"lat\":%.1f,\"data\":\"%zd:%s\"}\r\n",
-                               ais->type17.lon / AIS_GNSS_LATLON_DIV,
-                               ais->type17.lat / AIS_GNSS_LATLON_DIV,
-                               ais->type17.bitcount,
-                               gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
-                                            (char *)ais->type17.bitdata,
-                                            BITS_TO_BYTES(ais->type17.bitcount)));
+                json_printf(&out,
+                            "\"lon\":%.1f,\"lat\":%.1f,\"data\":\"%zd:%s\"}\r\n",
+                            ais->type17.lon / AIS_GNSS_LATLON_DIV,
+                            ais->type17.lat / AIS_GNSS_LATLON_DIV,
+                            ais->type17.bitcount,
+                            gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
+                                         (char *)ais->type17.bitdata,
+                                         BITS_TO_BYTES(ais->type17.bitcount)));
             } else {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"lon\":%d,\"lat\":%d,\"data\":\"%zd:%s\"}\r\n",
-                               ais->type17.lon,
-                               ais->type17.lat,
-                               ais->type17.bitcount,
-                               gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
-                                            (char *)ais->type17.bitdata,
-                                            BITS_TO_BYTES(ais->type17.bitcount)));
+                json_printf(&out,
+                            "\"lon\":%d,\"lat\":%d,\"data\":\"%zd:%s\"}\r\n",
+                            ais->type17.lon,
+                            ais->type17.lat,
+                            ais->type17.bitcount,
+                            gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
+                                         (char *)ais->type17.bitdata,
+                                         BITS_TO_BYTES(ais->type17.bitcount)));
             }
             break;
         case 18:
+            json_lit(&out, "\"reserved\":");
+            json_uint(&out, ais->type18.reserved);
+            json_lit(&out, ",\"speed\":");
             if (scaled) {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"reserved\":%u,\"speed\":%.1f,\"accuracy\":%s,"
-                               "\"lon\":%.4f,\"lat\":%.4f,\"course\":%.1f,"
-                               "\"heading\":%u,\"second\":%u,\"regional\":%u,"
-                               "\"cs\":%s,\"display\":%s,\"dsc\":%s,\"band\":%s,"
-                               "\"msg22\":%s,\"raim\":%s,\"radio\":%u}\r\n",
-                               ais->type18.reserved,
-                               ais->type18.speed / 10.0,
-                               JSON_BOOL(ais->type18.accuracy),
-                               ais->type18.lon / AIS_LATLON_DIV,
-                               ais->type18.lat / AIS_LATLON_DIV,
-                               ais->type18.course / 10.0,
-                               ais->type18.heading,
-                               ais->type18.second,
-                               ais->type18.regional,
-                               JSON_BOOL(ais->type18.cs),
-                               JSON_BOOL(ais->type18.display),
-                               JSON_BOOL(ais->type18.dsc),
-                               JSON_BOOL(ais->type18.band),
-                               JSON_BOOL(ais->type18.msg22),
-                               JSON_BOOL(ais->type18.raim), ais->type18.radio);
+                json_fixed(&out, (int)ais->type18.speed, 1, 1,
+                           ais->type18.speed / 10.0);
+                json_lit(&out, ",\"accuracy\":");
+                json_puts(&out, JSON_BOOL(ais->type18.accuracy));
+                json_lit(&out, ",\"lon\":");
+                json_fixed(&out, ais->type18.lon, 60, 4,
+                           ais->type18.lon / AIS_LATLON_DIV);
+                json_lit(&out, ",\"lat\":");
+                json_fixed(&out, ais->type18.lat, 60, 4,
+                           ais->type18.lat / AIS_LATLON_DIV);
+                json_lit(&out, ",\"course\":");
+                json_fixed(&out, (int)ais->type18.course, 1, 1,
+                           ais->type18.course / 10.0);
             } else {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"reserved\":%u,\"speed\":%u,\"accuracy\":%s,"
-                               "\"lon\":%d,\"lat\":%d,\"course\":%u,"
-                               "\"heading\":%u,\"second\":%u,\"regional\":%u,"
-                               "\"cs\":%s,\"display\":%s,\"dsc\":%s,\"band\":%s,"
-                               "\"msg22\":%s,\"raim\":%s,\"radio\":%u}\r\n",
-                               ais->type18.reserved,
-                               ais->type18.speed,
-                               JSON_BOOL(ais->type18.accuracy),
-                               ais->type18.lon,
-                               ais->type18.lat,
-                               ais->type18.course,
-                               ais->type18.heading,
-                               ais->type18.second,
-                               ais->type18.regional,
-                               JSON_BOOL(ais->type18.cs),
-                               JSON_BOOL(ais->type18.display),
-                               JSON_BOOL(ais->type18.dsc),
-                               JSON_BOOL(ais->type18.band),
-                               JSON_BOOL(ais->type18.msg22),
-                               JSON_BOOL(ais->type18.raim), ais->type18.radio);
+                json_uint(&out, ais->type18.speed);
+                json_lit(&out, ",\"accuracy\":");
+                json_puts(&out, JSON_BOOL(ais->type18.accuracy));
+                json_lit(&out, ",\"lon\":");
+                json_int(&out, ais->type18.lon);
+                json_lit(&out, ",\"lat\":");
+                json_int(&out, ais->type18.lat);
+                json_lit(&out, ",\"course\":");
+                json_uint(&out, ais->type18.course);
             }
+            json_lit(&out, ",\"heading\":");
+            json_uint(&out, ais->type18.heading);
+            json_lit(&out, ",\"second\":");
+            json_uint(&out, ais->type18.second);
+            json_lit(&out, ",\"regional\":");
+            json_uint(&out, ais->type18.regional);
+            json_lit(&out, ",\"cs\":");
+            json_puts(&out, JSON_BOOL(ais->type18.cs));
+            json_lit(&out, ",\"display\":");
+            json_puts(&out, JSON_BOOL(ais->type18.display));
+            json_lit(&out, ",\"dsc\":");
+            json_puts(&out, JSON_BOOL(ais->type18.dsc));
+            json_lit(&out, ",\"band\":");
+            json_puts(&out, JSON_BOOL(ais->type18.band));
+            json_lit(&out, ",\"msg22\":");
+            json_puts(&out, JSON_BOOL(ais->type18.msg22));
+            json_lit(&out, ",\"raim\":");
+            json_puts(&out, JSON_BOOL(ais->type18.raim));
+            json_lit(&out, ",\"radio\":");
+            json_uint(&out, ais->type18.radio);
+            json_lit(&out, "}\r\n");
             break;
         case 19:
             if (scaled) {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"reserved\":%u,\"speed\":%.1f,\"accuracy\":%s,"
-                               "\"lon\":%.4f,\"lat\":%.4f,\"course\":%.1f,"
-                               "\"heading\":%u,\"second\":%u,\"regional\":%u,"
-                               "\"shipname\":\"%s\","
-                               "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-                               "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
-                               "\"to_starboard\":%u,"
-                               "\"epfd\":%u,\"epfd_text\":\"%s\","
-                               "\"raim\":%s,\"dte\":%u,\"assigned\":%s}\r\n",
-                               ais->type19.reserved,
-                               ais->type19.speed / 10.0,
-                               JSON_BOOL(ais->type19.accuracy),
-                               ais->type19.lon / AIS_LATLON_DIV,
-                               ais->type19.lat / AIS_LATLON_DIV,
-                               ais->type19.course / 10.0,
-                               ais->type19.heading,
-                               ais->type19.second,
-                               ais->type19.regional,
-                               json_stringify(buf1, sizeof(buf1),
-                                              ais->type19.shipname),
-                               ais->type19.shiptype,
-                               SHIPTYPE_DISPLAY(ais->type19.shiptype),
-                               ais->type19.to_bow,
-                               ais->type19.to_stern,
-                               ais->type19.to_port,
-                               ais->type19.to_starboard,
-                               ais->type19.epfd,
-                               EPFD_DISPLAY(ais->type19.epfd),
-                               JSON_BOOL(ais->type19.raim),
-                               ais->type19.dte,
-                               JSON_BOOL(ais->type19.assigned));
+                json_printf(&out,
+                            "\"reserved\":%u,\"speed\":%.1f,\"accuracy\":%s,"
+                            "\"lon\":%.4f,\"lat\":%.4f,\"course\":%.1f,"
+                            "\"heading\":%u,\"second\":%u,\"regional\":%u,"
+                            "\"shipname\":\"%s\","
+                            "\"shiptype\":%u,\"shiptype_text\":%s,"
+                            "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
+                            "\"to_starboard\":%u,"
+                            "\"epfd\":%u,\"epfd_text\":%s,"
+                            "\"raim\":%s,\"dte\":%u,\"assigned\":%s}\r\n",
+                            ais->type19.reserved,
+                            ais->type19.speed / 10.0,
+                            JSON_BOOL(ais->type19.accuracy),
+                            ais->type19.lon / AIS_LATLON_DIV,
+                            ais->type19.lat / AIS_LATLON_DIV,
+                            ais->type19.course / 10.0,
+                            ais->type19.heading,
+                            ais->type19.second,
+                            ais->type19.regional,
+                            json_stringify(buf1, sizeof(buf1),
+                                           ais->type19.shipname),
+                            ais->type19.shiptype,
+                            SHIPTYPE_DISPLAY(ais->type19.shiptype)->text,
+                            ais->type19.to_bow,
+                            ais->type19.to_stern,
+                            ais->type19.to_port,
+                            ais->type19.to_starboard,
+                            ais->type19.epfd,
+                            EPFD_DISPLAY(ais->type19.epfd)->text,
+                            JSON_BOOL(ais->type19.raim),
+                            ais->type19.dte,
+                            JSON_BOOL(ais->type19.assigned));
             } else {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"reserved\":%u,\"speed\":%u,\"accuracy\":%s,"
-                               "\"lon\":%d,\"lat\":%d,\"course\":%u,"
-                               "\"heading\":%u,\"second\":%u,\"regional\":%u,"
-                               "\"shipname\":\"%s\","
-                               "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-                               "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
-                               "\"to_starboard\":%u,"
-                               "\"epfd\":%u,\"epfd_text\":\"%s\","
-                               "\"raim\":%s,\"dte\":%u,\"assigned\":%s}\r\n",
-                               ais->type19.reserved,
-                               ais->type19.speed,
-                               JSON_BOOL(ais->type19.accuracy),
-                               ais->type19.lon,
-                               ais->type19.lat,
-                               ais->type19.course,
-                               ais->type19.heading,
-                               ais->type19.second,
-                               ais->type19.regional,
-                               json_stringify(buf1, sizeof(buf1),
-                                              ais->type19.shipname),
-                               ais->type19.shiptype,
-                               SHIPTYPE_DISPLAY(ais->type19.shiptype),
-                               ais->type19.to_bow,
-                               ais->type19.to_stern,
-                               ais->type19.to_port,
-                               ais->type19.to_starboard,
-                               ais->type19.epfd,
-                               EPFD_DISPLAY(ais->type19.epfd),
-                               JSON_BOOL(ais->type19.raim),
-                               ais->type19.dte,
-                               JSON_BOOL(ais->type19.assigned));
+                json_printf(&out,
+                            "\"reserved\":%u,\"speed\":%u,\"accuracy\":%s,"
+                            "\"lon\":%d,\"lat\":%d,\"course\":%u,"
+                            "\"heading\":%u,\"second\":%u,\"regional\":%u,"
+                            "\"shipname\":\"%s\","
+                            "\"shiptype\":%u,\"shiptype_text\":%s,"
+                            "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
+                            "\"to_starboard\":%u,"
+                            "\"epfd\":%u,\"epfd_text\":%s,"
+                            "\"raim\":%s,\"dte\":%u,\"assigned\":%s}\r\n",
+                            ais->type19.reserved,
+                            ais->type19.speed,
+                            JSON_BOOL(ais->type19.accuracy),
+                            ais->type19.lon,
+                            ais->type19.lat,
+                            ais->type19.course,
+                            ais->type19.heading,
+                            ais->type19.second,
+                            ais->type19.regional,
+                            json_stringify(buf1, sizeof(buf1),
+                                           ais->type19.shipname),
+                            ais->type19.shiptype,
+                            SHIPTYPE_DISPLAY(ais->type19.shiptype)->text,
+                            ais->type19.to_bow,
+                            ais->type19.to_stern,
+                            ais->type19.to_port,
+                            ais->type19.to_starboard,
+                            ais->type19.epfd,
+                            EPFD_DISPLAY(ais->type19.epfd)->text,
+                            JSON_BOOL(ais->type19.raim),
+                            ais->type19.dte,
+                            JSON_BOOL(ais->type19.assigned));
             }
             break;
         case 20:			/* Data Link Management Message */
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "\"offset1\":%u,\"number1\":%u,"
-                           "\"timeout1\":%u,\"increment1\":%u,"
-                           "\"offset2\":%u,\"number2\":%u,"
-                           "\"timeout2\":%u,\"increment2\":%u,"
-                           "\"offset3\":%u,\"number3\":%u,"
-                           "\"timeout3\":%u,\"increment3\":%u,"
-                           "\"offset4\":%u,\"number4\":%u,"
-                           "\"timeout4\":%u,\"increment4\":%u}\r\n",
-                           ais->type20.offset1,
-                           ais->type20.number1,
-                           ais->type20.timeout1,
-                           ais->type20.increment1,
-                           ais->type20.offset2,
-                           ais->type20.number2,
-                           ais->type20.timeout2,
-                           ais->type20.increment2,
-                           ais->type20.offset3,
-                           ais->type20.number3,
-                           ais->type20.timeout3,
-                           ais->type20.increment3,
-                           ais->type20.offset4,
-                           ais->type20.number4,
-                           ais->type20.timeout4, ais->type20.increment4);
+            json_printf(&out,
+                        "\"offset1\":%u,\"number1\":%u,"
+                        "\"timeout1\":%u,\"increment1\":%u,"
+                        "\"offset2\":%u,\"number2\":%u,"
+                        "\"timeout2\":%u,\"increment2\":%u,"
+                        "\"offset3\":%u,\"number3\":%u,"
+                        "\"timeout3\":%u,\"increment3\":%u,"
+                        "\"offset4\":%u,\"number4\":%u,"
+                        "\"timeout4\":%u,\"increment4\":%u}\r\n",
+                        ais->type20.offset1,
+                        ais->type20.number1,
+                        ais->type20.timeout1,
+                        ais->type20.increment1,
+                        ais->type20.offset2,
+                        ais->type20.number2,
+                        ais->type20.timeout2,
+                        ais->type20.increment2,
+                        ais->type20.offset3,
+                        ais->type20.number3,
+                        ais->type20.timeout3,
+                        ais->type20.increment3,
+                        ais->type20.offset4,
+                        ais->type20.number4,
+                        ais->type20.timeout4, ais->type20.increment4);
             break;
         case 21:			/* Aid to Navigation */
             if (scaled) {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"aid_type\":%u,\"aid_type_text\":\"%s\","
-                               "\"name\":\"%s\",\"lon\":%.4f,"
-                               "\"lat\":%.4f,\"accuracy\":%s,\"to_bow\":%u,"
-                               "\"to_stern\":%u,\"to_port\":%u,\"to_starboard\":%u,"
-                               "\"epfd\":%u,\"epfd_text\":\"%s\","
-                               "\"second\":%u,\"regional\":%u,"
-                               "\"off_position\":%s,\"raim\":%s,"
-                               "\"virtual_aid\":%s}\r\n",
-                               ais->type21.aid_type,
-                               NAVAIDTYPE_DISPLAY(ais->type21.aid_type),
-                               json_stringify(buf1, sizeof(buf1),
-                                              ais->type21.name),
-                               ais->type21.lon / AIS_LATLON_DIV,
-                               ais->type21.lat / AIS_LATLON_DIV,
-                               JSON_BOOL(ais->type21.accuracy),
-                               ais->type21.to_bow, ais->type21.to_stern,
-                               ais->type21.to_port, ais->type21.to_starboard,
-                               ais->type21.epfd,
-                               EPFD_DISPLAY(ais->type21.epfd),
-                               ais->type21.second,
-                               ais->type21.regional,
-                               JSON_BOOL(ais->type21.off_position),
-                               JSON_BOOL(ais->type21.raim),
-                               JSON_BOOL(ais->type21.virtual_aid));
+                json_printf(&out,
+                            "\"aid_type\":%u,\"aid_type_text\":%s,"
+                            "\"name\":\"%s\",\"lon\":%.4f,"
+                            "\"lat\":%.4f,\"accuracy\":%s,\"to_bow\":%u,"
+                            "\"to_stern\":%u,\"to_port\":%u,\"to_starboard\":%u,"
+                            "\"epfd\":%u,\"epfd_text\":%s,"
+                            "\"second\":%u,\"regional\":%u,"
+                            "\"off_position\":%s,\"raim\":%s,"
+                            "\"virtual_aid\":%s}\r\n",
+                            ais->type21.aid_type,
+                            NAVAIDTYPE_DISPLAY(ais->type21.aid_type)->text,
+                            json_stringify(buf1, sizeof(buf1),
+                                           ais->type21.name),
+                            ais->type21.lon / AIS_LATLON_DIV,
+                            ais->type21.lat / AIS_LATLON_DIV,
+                            JSON_BOOL(ais->type21.accuracy),
+                            ais->type21.to_bow, ais->type21.to_stern,
+                            ais->type21.to_port, ais->type21.to_starboard,
+                            ais->type21.epfd,
+                            EPFD_DISPLAY(ais->type21.epfd)->text,
+                            ais->type21.second,
+                            ais->type21.regional,
+                            JSON_BOOL(ais->type21.off_position),
+                            JSON_BOOL(ais->type21.raim),
+                            JSON_BOOL(ais->type21.virtual_aid));
             } else {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"aid_type\":%u,\"aid_type_text\":\"%s\","
-                               "\"name\":\"%s\",\"accuracy\":%s,"
-                               "\"lon\":%d,\"lat\":%d,\"to_bow\":%u,"
-                               "\"to_stern\":%u,\"to_port\":%u,\"to_starboard\":%u,"
-                               "\"epfd\":%u,\"epfd_text\":\"%s\","
-                               "\"second\":%u,\"regional\":%u,"
-                               "\"off_position\":%s,\"raim\":%s,"
-                               "\"virtual_aid\":%s}\r\n",
-                               ais->type21.aid_type,
-                               NAVAIDTYPE_DISPLAY(ais->type21.aid_type),
-                               json_stringify(buf1, sizeof(buf1),
-                                              ais->type21.name),
-                               JSON_BOOL(ais->type21.accuracy),
-                               ais->type21.lon,
-                               ais->type21.lat,
-                               ais->type21.to_bow,
-                               ais->type21.to_stern,
-                               ais->type21.to_port,
-                               ais->type21.to_starboard,
-                               ais->type21.epfd,
-                               EPFD_DISPLAY(ais->type21.epfd),
-                               ais->type21.second,
-                               ais->type21.regional,
-                               JSON_BOOL(ais->type21.off_position),
-                               JSON_BOOL(ais->type21.raim),
-                               JSON_BOOL(ais->type21.virtual_aid));
+                json_printf(&out,
+                            "\"aid_type\":%u,\"aid_type_text\":%s,"
+                            "\"name\":\"%s\",\"accuracy\":%s,"
+                            "\"lon\":%d,\"lat\":%d,\"to_bow\":%u,"
+                            "\"to_stern\":%u,\"to_port\":%u,\"to_starboard\":%u,"
+                            "\"epfd\":%u,\"epfd_text\":%s,"
+                            "\"second\":%u,\"regional\":%u,"
+                            "\"off_position\":%s,\"raim\":%s,"
+                            "\"virtual_aid\":%s}\r\n",
+                            ais->type21.aid_type,
+                            NAVAIDTYPE_DISPLAY(ais->type21.aid_type)->text,
+                            json_stringify(buf1, sizeof(buf1),
+                                           ais->type21.name),
+                            JSON_BOOL(ais->type21.accuracy),
+                            ais->type21.lon,
+                            ais->type21.lat,
+                            ais->type21.to_bow,
+                            ais->type21.to_stern,
+                            ais->type21.to_port,
+                            ais->type21.to_starboard,
+                            ais->type21.epfd,
+                            EPFD_DISPLAY(ais->type21.epfd)->text,
+                            ais->type21.second,
+                            ais->type21.regional,
+                            JSON_BOOL(ais->type21.off_position),
+                            JSON_BOOL(ais->type21.raim),
+                            JSON_BOOL(ais->type21.virtual_aid));
             }
             break;
         case 22:			/* Channel Management */
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "\"channel_a\":%u,\"channel_b\":%u,"
-                           "\"txrx\":%u,\"power\":%s,",
-                           ais->type22.channel_a,
-                           ais->type22.channel_b,
-                           ais->type22.txrx, JSON_BOOL(ais->type22.power));
+            json_printf(&out,
+                        "\"channel_a\":%u,\"channel_b\":%u,"
+                        "\"txrx\":%u,\"power\":%s,",
+                        ais->type22.channel_a,
+                        ais->type22.channel_b,
+                        ais->type22.txrx, JSON_BOOL(ais->type22.power));
             if (ais->type22.addressed) {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"dest1\":%u,\"dest2\":%u,",
-                               ais->type22.mmsi.dest1, ais->type22.mmsi.dest2);
+                json_printf(&out,
+                            "\"dest1\":%u,\"dest2\":%u,",
+                            ais->type22.mmsi.dest1, ais->type22.mmsi.dest2);
             } else if (scaled) {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"ne_lon\":\"%f\",\"ne_lat\":\"%f\","
-                               "\"sw_lon\":\"%f\",\"sw_lat\":\"%f\",",
-                               ais->type22.area.ne_lon / AIS_CHANNEL_LATLON_DIV,
-                               ais->type22.area.ne_lat / AIS_CHANNEL_LATLON_DIV,
-                               ais->type22.area.sw_lon / AIS_CHANNEL_LATLON_DIV,
-                               ais->type22.area.sw_lat /
-                               AIS_CHANNEL_LATLON_DIV);
+                json_printf(&out,
+                            "\"ne_lon\":\"%f\",\"ne_lat\":\"%f\","
+                            "\"sw_lon\":\"%f\",\"sw_lat\":\"%f\",",
+                            ais->type22.area.ne_lon / AIS_CHANNEL_LATLON_DIV,
+                            ais->type22.area.ne_lat / AIS_CHANNEL_LATLON_DIV,
+                            ais->type22.area.sw_lon / AIS_CHANNEL_LATLON_DIV,
+                            ais->type22.area.sw_lat /
+                            AIS_CHANNEL_LATLON_DIV);
             } else {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"ne_lon\":%d,\"ne_lat\":%d,"
-                               "\"sw_lon\":%d,\"sw_lat\":%d,",
-                               ais->type22.area.ne_lon,
-                               ais->type22.area.ne_lat,
-                               ais->type22.area.sw_lon, ais->type22.area.sw_lat);
+                json_printf(&out,
+                            "\"ne_lon\":%d,\"ne_lat\":%d,"
+                            "\"sw_lon\":%d,\"sw_lat\":%d,",
+                            ais->type22.area.ne_lon,
+                            ais->type22.area.ne_lat,
+                            ais->type22.area.sw_lon, ais->type22.area.sw_lat);
             }
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "\"addressed\":%s,\"band_a\":%s,"
-                           "\"band_b\":%s,\"zonesize\":%u}\r\n",
-                           JSON_BOOL(ais->type22.addressed),
-                           JSON_BOOL(ais->type22.band_a),
-                           JSON_BOOL(ais->type22.band_b), ais->type22.zonesize);
+            json_printf(&out,
+                        "\"addressed\":%s,\"band_a\":%s,"
+                        "\"band_b\":%s,\"zonesize\":%u}\r\n",
+                        JSON_BOOL(ais->type22.addressed),
+                        JSON_BOOL(ais->type22.band_a),
+                        JSON_BOOL(ais->type22.band_b), ais->type22.zonesize);
             break;
         case 23:			/* Group Assignment Command */
             if (scaled) {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"ne_lon\":\"%f\",\"ne_lat\":\"%f\","
-                               "\"sw_lon\":\"%f\",\"sw_lat\":\"%f\","
-                               "\"stationtype\":%u,\"stationtype_text\":\"%s\","
-                               "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-                               "\"interval\":%u,\"quiet\":%u}\r\n",
-                               ais->type23.ne_lon / AIS_CHANNEL_LATLON_DIV,
-                               ais->type23.ne_lat / AIS_CHANNEL_LATLON_DIV,
-                               ais->type23.sw_lon / AIS_CHANNEL_LATLON_DIV,
-                               ais->type23.sw_lat / AIS_CHANNEL_LATLON_DIV,
-                               ais->type23.stationtype,
-                               STATIONTYPE_DISPLAY(ais->type23.stationtype),
-                               ais->type23.shiptype,
-                               SHIPTYPE_DISPLAY(ais->type23.shiptype),
-                               ais->type23.interval, ais->type23.quiet);
+                json_printf(&out,
+                            "\"ne_lon\":\"%f\",\"ne_lat\":\"%f\","
+                            "\"sw_lon\":\"%f\",\"sw_lat\":\"%f\","
+                            "\"stationtype\":%u,\"stationtype_text\":%s,"
+                            "\"shiptype\":%u,\"shiptype_text\":%s,"
+                            "\"interval\":%u,\"quiet\":%u}\r\n",
+                            ais->type23.ne_lon / AIS_CHANNEL_LATLON_DIV,
+                            ais->type23.ne_lat / AIS_CHANNEL_LATLON_DIV,
+                            ais->type23.sw_lon / AIS_CHANNEL_LATLON_DIV,
+                            ais->type23.sw_lat / AIS_CHANNEL_LATLON_DIV,
+                            ais->type23.stationtype,
+                            STATIONTYPE_DISPLAY(ais->type23.stationtype)->text,
+                            ais->type23.shiptype,
+                            SHIPTYPE_DISPLAY(ais->type23.shiptype)->text,
+                            ais->type23.interval, ais->type23.quiet);
             } else {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"ne_lon\":%d,\"ne_lat\":%d,"
-                               "\"sw_lon\":%d,\"sw_lat\":%d,"
-                               "\"stationtype\":%u,\"stationtype_text\":\"%s\","
-                               "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-                               "\"interval\":%u,\"quiet\":%u}\r\n",
-                               ais->type23.ne_lon,
-                               ais->type23.ne_lat,
-                               ais->type23.sw_lon,
-                               ais->type23.sw_lat,
-                               ais->type23.stationtype,
-                               STATIONTYPE_DISPLAY(ais->type23.stationtype),
-                               ais->type23.shiptype,
-                               SHIPTYPE_DISPLAY(ais->type23.shiptype),
-                               ais->type23.interval, ais->type23.quiet);
+                json_printf(&out,
+                            "\"ne_lon\":%d,\"ne_lat\":%d,"
+                            "\"sw_lon\":%d,\"sw_lat\":%d,"
+                            "\"stationtype\":%u,\"stationtype_text\":%s,"
+                            "\"shiptype\":%u,\"shiptype_text\":%s,"
+                            "\"interval\":%u,\"quiet\":%u}\r\n",
+                            ais->type23.ne_lon,
+                            ais->type23.ne_lat,
+                            ais->type23.sw_lon,
+                            ais->type23.sw_lat,
+                            ais->type23.stationtype,
+                            STATIONTYPE_DISPLAY(ais->type23.stationtype)->text,
+                            ais->type23.shiptype,
+                            SHIPTYPE_DISPLAY(ais->type23.shiptype)->text,
+                            ais->type23.interval, ais->type23.quiet);
             }
             break;
         case 24:			/* Class B CS Static Data Report */
             if (ais->type24.part != both) {
-                static char *partnames[] = {"AB", "A", "B"};
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"part\":\"%s\",",
-                               json_stringify(buf1, sizeof(buf1),
-                                              partnames[ais->type24.part]));
+                static const struct json_legend_t partnames[] = {
+                    JSON_LEGEND("AB"), JSON_LEGEND("A"), JSON_LEGEND("B"),
+                };
+                json_lit(&out, "\"part\":");
+                json_legend(&out, &partnames[ais->type24.part]);
+                json_lit(&out, ",");
+            }
+            if (ais->type24.part != part_b) {
+                json_lit(&out, "\"shipname\":\"");
+                json_puts(&out, json_stringify(buf1, sizeof(buf1),
+                                               ais->type24.shipname));
+                json_lit(&out, "\",");
             }
-            if (ais->type24.part != part_b)
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"shipname\":\"%s\",",
-                               json_stringify(buf1, sizeof(buf1),
-                                              ais->type24.shipname));
             if (ais->type24.part != part_a) {
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-                               "\"vendorid\":\"%s\",\"model\":%u,\"serial\":%u,"
-                               "\"callsign\":\"%s\",",
-                               ais->type24.shiptype,
-                               SHIPTYPE_DISPLAY(ais->type24.shiptype),
-                               json_stringify(buf1, sizeof(buf1),
-                                              ais->type24.vendorid),
-                               ais->type24.model,
-                               ais->type24.serial,
-                               json_stringify(buf2, sizeof(buf2),
-                                              ais->type24.callsign));
+                json_lit(&out, "\"shiptype\":");
+                json_uint(&out, ais->type24.shiptype);
+                json_lit(&out, ",\"shiptype_text\":");
+                json_legend(&out, SHIPTYPE_DISPLAY(ais->type24.shiptype));
+                json_lit(&out, ",\"vendorid\":\"");
+                json_puts(&out, json_stringify(buf1, sizeof(buf1),
+                                               ais->type24.vendorid));
+                json_lit(&out, "\",\"model\":");
+                json_uint(&out, ais->type24.model);
+                json_lit(&out, ",\"serial\":");
+                json_uint(&out, ais->type24.serial);
+                json_lit(&out, ",\"callsign\":\"");
+                json_puts(&out, json_stringify(buf1, sizeof(buf1),
+                                               ais->type24.callsign));
+                json_lit(&out, "\",");
                 if (AIS_AUXILIARY_MMSI(ais->mmsi)) {
-                    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                   "\"mothership_mmsi\":%u}\r\n",
-                                   ais->type24.mothership_mmsi);
+                    json_lit(&out, "\"mothership_mmsi\":");
+                    json_uint(&out, ais->type24.mothership_mmsi);
                 } else {
-                    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                                   "\"to_bow\":%u,\"to_stern\":%u,"
-                                   "\"to_port\":%u,\"to_starboard\":%u",
-                                   ais->type24.dim.to_bow,
-                                   ais->type24.dim.to_stern,
-                                   ais->type24.dim.to_port,
-                                   ais->type24.dim.to_starboard);
+                    json_lit(&out, "\"to_bow\":");
+                    json_uint(&out, ais->type24.dim.to_bow);
+                    json_lit(&out, ",\"to_stern\":");
+                    json_uint(&out, ais->type24.dim.to_stern);
+                    json_lit(&out, ",\"to_port\":");
+                    json_uint(&out, ais->type24.dim.to_port);
+                    json_lit(&out, ",\"to_starboard\":");
+                    json_uint(&out, ais->type24.dim.to_starboard);
                 }
             }
-            if (buf[strlen(buf)-1] == ',')
-                buf[strlen(buf)-1] = '\0';
-            strncat(buf, "}\r\n", buflen);
+            json_chomp(&out);
+            json_puts(&out, "}\r\n");
             break;
         case 25:			/* Binary Message, Single Slot */
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "\"addressed\":%s,\"structured\":%s,\"dest_mmsi\":%u,"
-                           "\"app_id\":%u,\"data\":\"%zd:%s\"}\r\n",
-                           JSON_BOOL(ais->type25.addressed),
-                           JSON_BOOL(ais->type25.structured),
-                           ais->type25.dest_mmsi,
-                           ais->type25.app_id,
-                           ais->type25.bitcount,
-                           gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
-                                        (char *)ais->type25.bitdata,
-                                        BITS_TO_BYTES(ais->type25.bitcount)));
+            json_printf(&out,
+                        "\"addressed\":%s,\"structured\":%s,\"dest_mmsi\":%u,"
+                        "\"app_id\":%u,\"data\":\"%zd:%s\"}\r\n",
+                        JSON_BOOL(ais->type25.addressed),
+                        JSON_BOOL(ais->type25.structured),
+                        ais->type25.dest_mmsi,
+                        ais->type25.app_id,
+                        ais->type25.bitcount,
+                        gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
+                                     (char *)ais->type25.bitdata,
+                                     BITS_TO_BYTES(ais->type25.bitcount)));
             break;
         case 26:			/* Binary Message, Multiple Slot */
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "\"addressed\":%s,\"structured\":%s,\"dest_mmsi\":%u,"
-                           "\"app_id\":%u,\"data\":\"%zd:%s\",\"radio\":%u}\r\n",
-                           JSON_BOOL(ais->type26.addressed),
-                           JSON_BOOL(ais->type26.structured),
-                           ais->type26.dest_mmsi,
-                           ais->type26.app_id,
-                           ais->type26.bitcount,
-                           gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
-                                        (char *)ais->type26.bitdata,
-                                        BITS_TO_BYTES(ais->type26.bitcount)),
-                           ais->type26.radio);
+            json_printf(&out,
+                        "\"addressed\":%s,\"structured\":%s,\"dest_mmsi\":%u,"
+                        "\"app_id\":%u,\"data\":\"%zd:%s\",\"radio\":%u}\r\n",
+                        JSON_BOOL(ais->type26.addressed),
+                        JSON_BOOL(ais->type26.structured),
+                        ais->type26.dest_mmsi,
+                        ais->type26.app_id,
+                        ais->type26.bitcount,
+                        gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
+                                     (char *)ais->type26.bitdata,
+                                     BITS_TO_BYTES(ais->type26.bitcount)),
+                        ais->type26.radio);
             break;
         case 27:			/* Long Range AIS Broadcast message */
             if (scaled)
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"status\":\"%s\","
-                               "\"accuracy\":%s,\"lon\":%.1f,\"lat\":%.1f,"
-                               "\"speed\":%u,\"course\":%u,\"raim\":%s,\"gnss\":%s}\r\n",
-                               nav_legends[ais->type27.status],
-                               JSON_BOOL(ais->type27.accuracy),
-                               ais->type27.lon / AIS_LONGRANGE_LATLON_DIV,
-                               ais->type27.lat / AIS_LONGRANGE_LATLON_DIV,
-                               ais->type27.speed,
-                               ais->type27.course,
-                               JSON_BOOL(ais->type27.raim),
-                               JSON_BOOL(ais->type27.gnss));
+                json_printf(&out,
+                            "\"status\":%s,"
+                            "\"accuracy\":%s,\"lon\":%.1f,\"lat\":%.1f,"
+                            "\"speed\":%u,\"course\":%u,\"raim\":%s,\"gnss\":%s}\r\n",
+                            nav_legends[ais->type27.status].text,
+                            JSON_BOOL(ais->type27.accuracy),
+                            ais->type27.lon / AIS_LONGRANGE_LATLON_DIV,
+                            ais->type27.lat / AIS_LONGRANGE_LATLON_DIV,
+                            ais->type27.speed,
+                            ais->type27.course,
+                            JSON_BOOL(ais->type27.raim),
+                            JSON_BOOL(ais->type27.gnss));
             else
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                               "\"status\":%u,"
-                               "\"accuracy\":%s,\"lon\":%d,\"lat\":%d,"
-                               "\"speed\":%u,\"course\":%u,\"raim\":%s,\"gnss\":%s}\r\n",
-                               ais->type27.status,
-                               JSON_BOOL(ais->type27.accuracy),
-                               ais->type27.lon,
-                               ais->type27.lat,
-                               ais->type27.speed,
-                               ais->type27.course,
-                               JSON_BOOL(ais->type27.raim),
-                               JSON_BOOL(ais->type27.gnss));
+                json_printf(&out,
+                            "\"status\":%u,"
+                            "\"accuracy\":%s,\"lon\":%d,\"lat\":%d,"
+                            "\"speed\":%u,\"course\":%u,\"raim\":%s,\"gnss\":%s}\r\n",
+                            ais->type27.status,
+                            JSON_BOOL(ais->type27.accuracy),
+                            ais->type27.lon,
+                            ais->type27.lat,
+                            ais->type27.speed,
+                            ais->type27.course,
+                            JSON_BOOL(ais->type27.raim),
+                            JSON_BOOL(ais->type27.gnss));
             break;
         default:
-            if (buf[strlen(buf) - 1] == ',')
-                buf[strlen(buf) - 1] = '\0';
-            (void)strlcat(buf, "}\r\n", buflen);
+            json_chomp(&out);
+            json_puts(&out, "}\r\n");
             break;
     }
     /*@ +formatcode +mustfreefresh @*/
+    return out.truncated ? buflen : out.len;
 }
 
 /* gpsd_json.c ends here */
@@ -7,69 +7,1524 @@
 //
 
 #include <Python.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
 
 #include "libais-python.h"
 #include "libais.h"
 //#include "gps.h"
 
 #define MAXDEVICES	1024
+#define REPORT_MAX	(JSON_VAL_MAX * 2 + 1)	/* room for one JSON report */
+#define MANY_BATCH	1024	/* messages per batch in decode_many() */
 
-static struct gps_device_t session[MAXDEVICES];
+/*
+ * A decoder owns its reassembly state, allocated with it.  Calls that
+ * run without the GIL mark it busy, so that one decoder per thread is
+ * safe and a decoder shared between threads is refused, not corrupted.
+ */
+typedef struct {
+    PyObject_HEAD
+    struct gps_device_t *session;
+    PyObject *watchlist;	/* the MMSISet its filter points into */
+    bool busy;
+} DecoderObject;
 
-static bool assigned[MAXDEVICES];
+static PyTypeObject DecoderType;
+
+/*
+ * Module state: the decoders handed out by getDecoderId(), by id.  Only
+ * ever touched with the GIL held.
+ */
+typedef struct {
+    DecoderObject *legacy[MAXDEVICES];
+} LibaisState;
+
+#define LEGACY(module)	(((LibaisState *)PyModule_GetState(module))->legacy)
+
+typedef struct {
+    PyObject_HEAD
+    struct ais_mmsi_set_t *set;
+} MMSISetObject;
+
+static PyTypeObject MMSISetType;
 
 static PyObject*
-libais_decode(PyObject* self, PyObject* args, PyObject *kwargs)
+mmsiset_wrap(struct ais_mmsi_set_t *set)
 {
-    const char* msg;
-    int decoderId=-1;
-    
-    static char *kwlist[] = {"message","decoderId", NULL};
-    
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|i", kwlist, &msg, &decoderId))
+    MMSISetObject *self;
+
+    if (set == NULL)
+        return PyErr_NoMemory();
+    if ((self = PyObject_New(MMSISetObject, &MMSISetType)) == NULL) {
+        ais_mmsi_set_free(set);
         return NULL;
+    }
+    self->set = set;
+    return (PyObject *)self;
+}
 
-    if ( decoderId == -1 ) {
-        printf("Warning: No decoder selected. Using default decoder '0'.\n");
-        decoderId=0;
-        if (!assigned[0]) {
-            assigned[0]=true;
-        } else {
-            printf("Error: Default decoder already assigned. Get your own!.\n");
+static PyObject*
+mmsiset_from_iterable(PyObject *iterable)
+{
+    PyObject *iter, *item;
+    unsigned int *mmsi = NULL;
+    size_t n = 0, size = 0;
+    struct ais_mmsi_set_t *set;
+
+    if ((iter = PyObject_GetIter(iterable)) == NULL)
+        return NULL;
+    while ((item = PyIter_Next(iter)) != NULL) {
+        unsigned long v = PyLong_AsUnsignedLong(item);
+
+        Py_DECREF(item);
+        if (PyErr_Occurred() && !PyErr_ExceptionMatches(PyExc_OverflowError))
+            break;
+        if (PyErr_Occurred() || v > AIS_MMSI_MAX) {
+            PyErr_Clear();
+            PyErr_SetString(PyExc_ValueError, "MMSI out of range");
+            break;
+        }
+        if (n == size) {
+            unsigned int *grown;
+
+            size = size ? 2 * size : 1024;
+            if ((grown = realloc(mmsi, size * sizeof(*mmsi))) == NULL) {
+                PyErr_NoMemory();
+                break;
+            }
+            mmsi = grown;
+        }
+        mmsi[n++] = (unsigned int)v;
+    }
+    Py_DECREF(iter);
+    if (PyErr_Occurred()) {
+        free(mmsi);
+        return NULL;
+    }
+    set = ais_mmsi_set_new(mmsi, n);
+    free(mmsi);
+    return mmsiset_wrap(set);
+}
+
+static PyObject*
+mmsiset_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    PyObject *iterable = NULL;
+    static char *kwlist[] = {"mmsis", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwlist, &iterable))
+        return NULL;
+    if (iterable == NULL)
+        return mmsiset_wrap(ais_mmsi_set_new(NULL, 0));
+    return mmsiset_from_iterable(iterable);
+}
+
+static void
+mmsiset_dealloc(MMSISetObject *self)
+{
+    ais_mmsi_set_free(self->set);
+    PyObject_Del(self);
+}
+
+static Py_ssize_t
+mmsiset_length(MMSISetObject *self)
+{
+    return (Py_ssize_t)ais_mmsi_set_size(self->set);
+}
+
+static int
+mmsiset_contains(MMSISetObject *self, PyObject *key)
+{
+    unsigned long v = PyLong_AsUnsignedLong(key);
+
+    if (PyErr_Occurred()) {
+        /* like a set of ints: anything else is simply not a member */
+        PyErr_Clear();
+        return 0;
+    }
+    return v <= AIS_MMSI_MAX && ais_mmsi_set_contains(self->set, (unsigned int)v);
+}
+
+static PySequenceMethods mmsiset_as_sequence = {
+    .sq_length = (lenfunc)mmsiset_length,
+    .sq_contains = (objobjproc)mmsiset_contains,
+};
+
+static PyTypeObject MMSISetType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "libais.MMSISet",
+    .tp_basicsize = sizeof(MMSISetObject),
+    .tp_dealloc = (destructor)mmsiset_dealloc,
+    .tp_as_sequence = &mmsiset_as_sequence,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "MMSISet([mmsis]): set of MMSIs to filter messages on.",
+    .tp_new = mmsiset_new,
+};
+
+static PyObject*
+libais_loadMMSISet(PyObject* self, PyObject* args)
+{
+    const char *path;
+    FILE *fp;
+    struct ais_mmsi_set_t *set;
+    size_t badline;
+    int err;
+
+    if (!PyArg_ParseTuple(args, "s", &path))
+        return NULL;
+    if ((fp = fopen(path, "r")) == NULL)
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, path);
+    Py_BEGIN_ALLOW_THREADS
+    set = ais_mmsi_set_read(fp, &badline);
+    err = errno;
+    (void)fclose(fp);
+    Py_END_ALLOW_THREADS
+    if (set == NULL) {
+        if (badline != 0)
+            return PyErr_Format(PyExc_ValueError, "%s:%lu: bad MMSI",
+                                path, (unsigned long)badline);
+        errno = err;
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, path);
+    }
+    return mmsiset_wrap(set);
+}
+
+static bool
+decoder_ready(DecoderObject *decoder)
+/* may this thread use the decoder?  raises if not */
+{
+    if (decoder->busy) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "decoder in use in another thread");
+        return false;
+    }
+    return true;
+}
+
+static DecoderObject*
+decoder_by_id(PyObject *module, int decoderId)
+/* borrowed; raises unless the id was handed out */
+{
+    DecoderObject **legacy = LEGACY(module);
+
+    if (decoderId < 0 || decoderId >= MAXDEVICES
+        || legacy[decoderId] == NULL) {
+        PyErr_SetString(PyExc_ValueError, "no such decoder");
+        return NULL;
+    }
+    return legacy[decoderId];
+}
+
+static PyObject*
+decoder_set_filter(DecoderObject *decoder, PyObject *types, PyObject *mmsi)
+{
+    unsigned long mask = 0;
+    struct aivdm_filter_t *filter;
+
+    if (!decoder_ready(decoder))
+        return NULL;
+
+    if (types != Py_None) {
+        PyObject *iter, *item;
+
+        if ((iter = PyObject_GetIter(types)) == NULL)
+            return NULL;
+        while ((item = PyIter_Next(iter)) != NULL) {
+            long type = PyLong_AsLong(item);
+
+            Py_DECREF(item);
+            if (PyErr_Occurred())
+                break;
+            if (type < 0 || type >= (long)(CHAR_BIT * sizeof(mask))) {
+                PyErr_Format(PyExc_ValueError, "bad message type: %ld", type);
+                break;
+            }
+            mask |= 1UL << type;
+        }
+        Py_DECREF(iter);
+        if (PyErr_Occurred())
+            return NULL;
+        if (mask == 0) {
+            PyErr_SetString(PyExc_ValueError, "no message types to admit");
             return NULL;
         }
     }
-    
-    if (!assigned[decoderId]) {
-        printf("Warning: Selected decoder '%d' was not assigned. Now it is.\n", decoderId);
-        assigned[decoderId]=true;
+
+    if (mmsi == Py_None)
+        Py_INCREF(mmsi);
+    else if (PyObject_TypeCheck(mmsi, &MMSISetType))
+        Py_INCREF(mmsi);
+    else if ((mmsi = mmsiset_from_iterable(mmsi)) == NULL)
+        return NULL;
+
+    filter = &decoder->session->driver.aivdm.filter;
+    filter->types = mask;
+    filter->mmsi = (mmsi == Py_None) ? NULL : ((MMSISetObject *)mmsi)->set;
+    Py_XSETREF(decoder->watchlist, mmsi);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject*
+libais_setFilter(PyObject* self, PyObject* args, PyObject *kwargs)
+{
+    int decoderId;
+    PyObject *types = Py_None, *mmsi = Py_None;
+    DecoderObject *decoder;
+
+    static char *kwlist[] = {"decoderId", "types", "mmsi", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "i|OO", kwlist,
+                                     &decoderId, &types, &mmsi))
+        return NULL;
+    if ((decoder = decoder_by_id(self, decoderId)) == NULL)
+        return NULL;
+    return decoder_set_filter(decoder, types, mmsi);
+}
+
+/*
+ * Native reports: for each message a dict with the keys and values
+ * json.loads() would give for its JSON report, built straight from
+ * struct ais_t.  Keys and the fixed strings among the values are made
+ * once, at module exec.
+ */
+#define REPORT_KEYS \
+    X(class) X(type) X(repeat) X(mmsi) X(scaled) X(status) X(status_text) \
+    X(turn) X(speed) X(accuracy) X(lon) X(lat) X(course) X(heading) \
+    X(second) X(maneuver) X(raim) X(radio) X(timestamp) X(epfd) \
+    X(epfd_text) X(imo) X(ais_version) X(callsign) X(shipname) \
+    X(shiptype) X(shiptype_text) X(to_bow) X(to_stern) X(to_port) \
+    X(to_starboard) X(eta) X(draught) X(destination) X(dte) X(seqno) \
+    X(dest_mmsi) X(retransmit) X(dac) X(fid) X(data) X(mmsi1) X(mmsi2) \
+    X(mmsi3) X(mmsi4) X(alt) X(regional) X(text) X(type1_1) \
+    X(offset1_1) X(type1_2) X(offset1_2) X(type2_1) X(offset2_1) \
+    X(offset1) X(increment1) X(offset2) X(increment2) X(reserved) X(cs) \
+    X(display) X(dsc) X(band) X(msg22) X(assigned) X(number1) \
+    X(timeout1) X(number2) X(timeout2) X(offset3) X(number3) \
+    X(timeout3) X(increment3) X(offset4) X(number4) X(timeout4) \
+    X(increment4) X(aid_type) X(aid_type_text) X(name) X(off_position) \
+    X(virtual_aid) X(channel_a) X(channel_b) X(txrx) X(power) X(dest1) \
+    X(dest2) X(ne_lon) X(ne_lat) X(sw_lon) X(sw_lat) X(addressed) \
+    X(band_a) X(band_b) X(zonesize) X(stationtype) X(stationtype_text) \
+    X(interval) X(quiet) X(part) X(vendorid) X(model) X(serial) \
+    X(mothership_mmsi) X(structured) X(app_id) X(gnss)
+
+/* fixed strings among the values */
+#define REPORT_WORDS \
+    X(AIS) X(nan) X(fast) X(fastleft) X(fastright) X(high) X(A) X(B)
+
+#define X(k) KEY_##k,
+enum { REPORT_KEYS NKEYS };
+#undef X
+#define X(w) WORD_##w,
+enum { REPORT_WORDS NWORDS };
+#undef X
+
+/*
+ * Shared by every module object, as the types are: built once, by the
+ * first exec, with the GIL held, and only read afterwards.
+ */
+static PyObject *key[NKEYS];
+static PyObject *word[NWORDS];
+static PyObject *status_word[16];	/* "0" to "15", for types 1-3 */
+/* tuples of each table's texts, the INVALID one last */
+static PyObject *legend[legend_navaid + 1];
+/* json.loads, for the application payloads of types 6 and 8 */
+static PyObject *json_loads;
+
+static int
+report_init(void)
+{
+    static const char *keyname[] = {
+#define X(k) #k,
+        REPORT_KEYS
+#undef X
+    };
+    static const char *wordname[] = {
+#define X(w) #w,
+        REPORT_WORDS
+#undef X
+    };
+    PyObject *json;
+    int i;
+
+    /* set last, so a failed attempt is made again in full */
+    if (json_loads != NULL)
+        return 0;
+    for (i = 0; i < NKEYS; i++)
+        if ((key[i] = PyUnicode_InternFromString(keyname[i])) == NULL)
+            return -1;
+    for (i = 0; i < NWORDS; i++)
+        if ((word[i] = PyUnicode_InternFromString(wordname[i])) == NULL)
+            return -1;
+    for (i = 0; i < NITEMS(status_word); i++)
+        if ((status_word[i] = PyUnicode_FromFormat("%d", i)) == NULL)
+            return -1;
+    for (i = 0; i < NITEMS(legend); i++) {
+        unsigned int n, count = json_ais_legend_count(i);
+
+        if ((legend[i] = PyTuple_New(count + 1)) == NULL)
+            return -1;
+        for (n = 0; n <= count; n++) {
+            size_t len;
+            const char *text = json_ais_legend(i, n, &len);
+            /* the texts come quoted, ready for a JSON report */
+            PyObject *s = PyUnicode_DecodeLatin1(text + 1,
+                                                 (Py_ssize_t)len - 2, NULL);
+
+            if (s == NULL)
+                return -1;
+            PyTuple_SET_ITEM(legend[i], n, s);
+        }
     }
-    
-//    printf("Message: %s, length: %ul\n", msg, sizeof(msg));
-    
+    if ((json = PyImport_ImportModule("json")) == NULL)
+        return -1;
+    json_loads = PyObject_GetAttrString(json, "loads");
+    Py_DECREF(json);
+    return json_loads == NULL ? -1 : 0;
+}
+
+static PyObject*
+report_legend(enum json_ais_legend_t table, unsigned int n)
+/* borrowed */
+{
+    Py_ssize_t count = PyTuple_GET_SIZE(legend[table]) - 1;
+
+    return PyTuple_GET_ITEM(legend[table],
+                            n < (size_t)count ? (Py_ssize_t)n : count);
+}
+
+static PyObject*
+report_fixed(int val, unsigned int per, int places, double dval)
+/*
+ * What a %.*f of dval reads back as, where dval is
+ * val / (per * 10^places); the arithmetic of json_fixed().
+ */
+{
+    static const double scale[] = {1.0, 10.0, 100.0, 1000.0, 10000.0};
+    unsigned int mag = val < 0 ? 0U - (unsigned int)val : (unsigned int)val;
+    unsigned int q = mag / per, r = mag % per;
+
+    if (2 * r == per) {
+        char tmp[32];
+
+        (void)PyOS_snprintf(tmp, sizeof(tmp), "%.*f", places, dval);
+        return PyFloat_FromDouble(PyOS_string_to_double(tmp, NULL, NULL));
+    }
+    if (2 * r > per)
+        q++;
+    return PyFloat_FromDouble((val < 0 ? -(double)q : (double)q)
+                              / scale[places]);
+}
+
+static PyObject*
+report_string(const char *str)
+{
+    return PyUnicode_DecodeLatin1(str, (Py_ssize_t)strlen(str), NULL);
+}
+
+static PyObject*
+report_format(const char *fmt, ...)
+/* a short string by printf rules, such as a timestamp */
+{
+    char tmp[64];
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = PyOS_vsnprintf(tmp, sizeof(tmp), fmt, ap);
+    va_end(ap);
+    if (n < 0 || n >= (int)sizeof(tmp))
+        n = (int)strlen(tmp);
+    return PyUnicode_FromStringAndSize(tmp, n);
+}
+
+static PyObject*
+report_degrees(int val, double div)
+/* as "%f" of val / div, a string in the JSON for types 22 and 23 */
+{
+    char *str = PyOS_double_to_string(val / div, 'f', 6, 0, NULL);
+    PyObject *obj;
+
+    if (str == NULL)
+        return NULL;
+    obj = PyUnicode_FromString(str);
+    PyMem_Free(str);
+    return obj;
+}
+
+static PyObject*
+report_data(const char *bits, size_t bitcount)
+/* binary payload as "bitcount:hex" */
+{
+    char scratch[MAX_PACKET_LENGTH * 2 + 1];
+
+    return PyUnicode_FromFormat("%zd:%s", (Py_ssize_t)bitcount,
+                                gpsd_hexdump(scratch, sizeof(scratch),
+                                             (char *)bits,
+                                             BITS_TO_BYTES(bitcount)));
+}
+
+static bool
+report_put(PyObject *dict, int k, PyObject *val)
+/* steals val */
+{
+    bool ok = val != NULL && PyDict_SetItem(dict, key[k], val) == 0;
+
+    Py_XDECREF(val);
+    return ok;
+}
+
+/* each stops at the first failure, leaving the exception set */
+#define PUT(k, val)	(ok = ok && report_put(d, KEY_##k, (val)))
+#define PUT_REF(k, val)	(ok = ok && PyDict_SetItem(d, key[KEY_##k], (val)) == 0)
+#define PUT_UINT(k, val)	PUT(k, PyLong_FromUnsignedLong(val))
+#define PUT_BOOL(k, val)	PUT_REF(k, (val) ? Py_True : Py_False)
+#define PUT_STR(k, val)	PUT(k, report_string(val))
+#define PUT_LEGEND(k, table, n)	PUT_REF(k, report_legend(table, n))
+
+static PyObject*
+report_payload(const struct ais_t *ais, PyObject *d)
+/* types 6 and 8 with a structured payload: the JSON report, parsed */
+{
+    char buf[REPORT_MAX];
+    size_t len = json_aivdm_dump(ais, NULL, true, buf, sizeof(buf));
+    PyObject *text, *parsed;
+
+    if (len >= sizeof(buf))
+        return d;
+    text = PyUnicode_FromStringAndSize(buf, (Py_ssize_t)len);
+    if (text == NULL) {
+        Py_DECREF(d);
+        return NULL;
+    }
+    parsed = PyObject_CallFunctionObjArgs(json_loads, text, NULL);
+    Py_DECREF(text);
+    if (parsed == NULL) {
+        /* some payloads have no valid JSON form; keep the header */
+        if (!PyErr_ExceptionMatches(PyExc_ValueError)) {
+            Py_DECREF(d);
+            return NULL;
+        }
+        PyErr_Clear();
+        return d;
+    }
+    Py_DECREF(d);
+    return parsed;
+}
+
+static PyObject*
+report_build(const struct ais_t *ais)
+/* the native form of json_aivdm_dump(ais, NULL, true, ...) */
+{
+    PyObject *d = PyDict_New();
+    bool ok = d != NULL;
+
+    PUT_REF(class, word[WORD_AIS]);
+    PUT_UINT(type, ais->type);
+    PUT_UINT(repeat, ais->repeat);
+    PUT_UINT(mmsi, ais->mmsi);
+    PUT_REF(scaled, Py_True);
+    switch (ais->type) {
+    case 1:			/* Position Report */
+    case 2:
+    case 3:
+        PUT_REF(status, status_word[ais->type1.status & 15]);
+        PUT_LEGEND(status_text, legend_nav, ais->type1.status);
+        if (ais->type1.turn == -128)
+            PUT_REF(turn, word[WORD_nan]);
+        else if (ais->type1.turn == -127)
+            PUT_REF(turn, word[WORD_fastleft]);
+        else if (ais->type1.turn == 127)
+            PUT_REF(turn, word[WORD_fastright]);
+        else {
+            double rot1 = ais->type1.turn / 4.733;
+
+            PUT_UINT(turn, (unsigned int)nearbyint(rot1 * rot1));
+        }
+        if (ais->type1.speed == AIS_SPEED_NOT_AVAILABLE)
+            PUT_REF(speed, word[WORD_nan]);
+        else if (ais->type1.speed == AIS_SPEED_FAST_MOVER)
+            PUT_REF(speed, word[WORD_fast]);
+        else
+            PUT(speed, report_fixed((int)ais->type1.speed, 1, 1,
+                                    ais->type1.speed / 10.0));
+        PUT_BOOL(accuracy, ais->type1.accuracy);
+        PUT(lon, report_fixed(ais->type1.lon, 60, 4,
+                              ais->type1.lon / AIS_LATLON_DIV));
+        PUT(lat, report_fixed(ais->type1.lat, 60, 4,
+                              ais->type1.lat / AIS_LATLON_DIV));
+        PUT(course, report_fixed((int)ais->type1.course, 1, 1,
+                                 ais->type1.course / 10.0));
+        PUT_UINT(heading, ais->type1.heading);
+        PUT_UINT(second, ais->type1.second);
+        PUT_UINT(maneuver, ais->type1.maneuver);
+        PUT_BOOL(raim, ais->type1.raim);
+        PUT_UINT(radio, ais->type1.radio);
+        break;
+    case 4:			/* Base Station Report */
+    case 11:			/* UTC/Date Response */
+        PUT(timestamp, report_format("%04u-%02u-%02uT%02u:%02u:%02uZ",
+                                     ais->type4.year, ais->type4.month,
+                                     ais->type4.day, ais->type4.hour,
+                                     ais->type4.minute, ais->type4.second));
+        PUT_BOOL(accuracy, ais->type4.accuracy);
+        PUT(lon, report_fixed(ais->type4.lon, 60, 4,
+                              ais->type4.lon / AIS_LATLON_DIV));
+        PUT(lat, report_fixed(ais->type4.lat, 60, 4,
+                              ais->type4.lat / AIS_LATLON_DIV));
+        PUT_UINT(epfd, ais->type4.epfd);
+        PUT_LEGEND(epfd_text, legend_epfd, ais->type4.epfd);
+        PUT_BOOL(raim, ais->type4.raim);
+        PUT_UINT(radio, ais->type4.radio);
+        break;
+    case 5:			/* Ship static and voyage related data */
+        PUT_UINT(imo, ais->type5.imo);
+        PUT_UINT(ais_version, ais->type5.ais_version);
+        PUT_STR(callsign, ais->type5.callsign);
+        PUT_STR(shipname, ais->type5.shipname);
+        PUT_UINT(shiptype, ais->type5.shiptype);
+        PUT_LEGEND(shiptype_text, legend_shiptype, ais->type5.shiptype);
+        PUT_UINT(to_bow, ais->type5.to_bow);
+        PUT_UINT(to_stern, ais->type5.to_stern);
+        PUT_UINT(to_port, ais->type5.to_port);
+        PUT_UINT(to_starboard, ais->type5.to_starboard);
+        PUT_UINT(epfd, ais->type5.epfd);
+        PUT_LEGEND(epfd_text, legend_epfd, ais->type5.epfd);
+        PUT(eta, report_format("%02u-%02uT%02u:%02uZ",
+                               ais->type5.month, ais->type5.day,
+                               ais->type5.hour, ais->type5.minute));
+        PUT(draught, report_fixed((int)ais->type5.draught, 1, 1,
+                                  ais->type5.draught / 10.0));
+        PUT_STR(destination, ais->type5.destination);
+        PUT_UINT(dte, ais->type5.dte);
+        break;
+    case 6:			/* Binary Message */
+        PUT_UINT(seqno, ais->type6.seqno);
+        PUT_UINT(dest_mmsi, ais->type6.dest_mmsi);
+        PUT_BOOL(retransmit, ais->type6.retransmit);
+        PUT_UINT(dac, ais->type6.dac);
+        PUT_UINT(fid, ais->type6.fid);
+        if (!ais->type6.structured)
+            PUT(data, report_data(ais->type6.bitdata, ais->type6.bitcount));
+        else if (ok)
+            return report_payload(ais, d);
+        break;
+    case 7:			/* Binary Acknowledge */
+    case 13:			/* Safety Related Acknowledge */
+        PUT_UINT(mmsi1, ais->type7.mmsi1);
+        PUT_UINT(mmsi2, ais->type7.mmsi2);
+        PUT_UINT(mmsi3, ais->type7.mmsi3);
+        PUT_UINT(mmsi4, ais->type7.mmsi4);
+        break;
+    case 8:			/* Binary Broadcast Message */
+        PUT_UINT(dac, ais->type8.dac);
+        PUT_UINT(fid, ais->type8.fid);
+        if (!ais->type8.structured)
+            PUT(data, report_data(ais->type8.bitdata, ais->type8.bitcount));
+        else if (ok)
+            return report_payload(ais, d);
+        break;
+    case 9:			/* Standard SAR Aircraft Position Report */
+        if (ais->type9.alt == AIS_ALT_NOT_AVAILABLE)
+            PUT_REF(alt, word[WORD_nan]);
+        else if (ais->type9.alt == AIS_ALT_HIGH)
+            PUT_REF(alt, word[WORD_high]);
+        else
+            PUT_UINT(alt, ais->type9.alt);
+        if (ais->type9.speed == AIS_SAR_SPEED_NOT_AVAILABLE)
+            PUT_REF(speed, word[WORD_nan]);
+        else if (ais->type9.speed == AIS_SAR_FAST_MOVER)
+            PUT_REF(speed, word[WORD_fast]);
+        else
+            PUT_UINT(speed, ais->type9.speed);
+        PUT_BOOL(accuracy, ais->type9.accuracy);
+        PUT(lon, report_fixed(ais->type9.lon, 60, 4,
+                              ais->type9.lon / AIS_LATLON_DIV));
+        PUT(lat, report_fixed(ais->type9.lat, 60, 4,
+                              ais->type9.lat / AIS_LATLON_DIV));
+        PUT(course, report_fixed((int)ais->type9.course, 1, 1,
+                                 ais->type9.course / 10.0));
+        PUT_UINT(second, ais->type9.second);
+        PUT_UINT(regional, ais->type9.regional);
+        PUT_UINT(dte, ais->type9.dte);
+        PUT_BOOL(raim, ais->type9.raim);
+        PUT_UINT(radio, ais->type9.radio);
+        break;
+    case 10:			/* UTC/Date Inquiry */
+        PUT_UINT(dest_mmsi, ais->type10.dest_mmsi);
+        break;
+    case 12:			/* Safety Related Message */
+        PUT_UINT(seqno, ais->type12.seqno);
+        PUT_UINT(dest_mmsi, ais->type12.dest_mmsi);
+        PUT_BOOL(retransmit, ais->type12.retransmit);
+        PUT_STR(text, ais->type12.text);
+        break;
+    case 14:			/* Safety Related Broadcast Message */
+        PUT_STR(text, ais->type14.text);
+        break;
+    case 15:			/* Interrogation */
+        PUT_UINT(mmsi1, ais->type15.mmsi1);
+        PUT_UINT(type1_1, ais->type15.type1_1);
+        PUT_UINT(offset1_1, ais->type15.offset1_1);
+        PUT_UINT(type1_2, ais->type15.type1_2);
+        PUT_UINT(offset1_2, ais->type15.offset1_2);
+        PUT_UINT(mmsi2, ais->type15.mmsi2);
+        PUT_UINT(type2_1, ais->type15.type2_1);
+        PUT_UINT(offset2_1, ais->type15.offset2_1);
+        break;
+    case 16:			/* Assigned Mode Command */
+        PUT_UINT(mmsi1, ais->type16.mmsi1);
+        PUT_UINT(offset1, ais->type16.offset1);
+        PUT_UINT(increment1, ais->type16.increment1);
+        PUT_UINT(mmsi2, ais->type16.mmsi2);
+        PUT_UINT(offset2, ais->type16.offset2);
+        PUT_UINT(increment2, ais->type16.increment2);
+        break;
+    case 17:			/* GNSS Broadcast Binary Message */
+        PUT(lon, report_fixed(ais->type17.lon, 60, 1,
+                              ais->type17.lon / AIS_GNSS_LATLON_DIV));
+        PUT(lat, report_fixed(ais->type17.lat, 60, 1,
+                              ais->type17.lat / AIS_GNSS_LATLON_DIV));
+        PUT(data, report_data(ais->type17.bitdata, ais->type17.bitcount));
+        break;
+    case 18:			/* Standard Class B CS Position Report */
+        PUT_UINT(reserved, ais->type18.reserved);
+        PUT(speed, report_fixed((int)ais->type18.speed, 1, 1,
+                                ais->type18.speed / 10.0));
+        PUT_BOOL(accuracy, ais->type18.accuracy);
+        PUT(lon, report_fixed(ais->type18.lon, 60, 4,
+                              ais->type18.lon / AIS_LATLON_DIV));
+        PUT(lat, report_fixed(ais->type18.lat, 60, 4,
+                              ais->type18.lat / AIS_LATLON_DIV));
+        PUT(course, report_fixed((int)ais->type18.course, 1, 1,
+                                 ais->type18.course / 10.0));
+        PUT_UINT(heading, ais->type18.heading);
+        PUT_UINT(second, ais->type18.second);
+        PUT_UINT(regional, ais->type18.regional);
+        PUT_BOOL(cs, ais->type18.cs);
+        PUT_BOOL(display, ais->type18.display);
+        PUT_BOOL(dsc, ais->type18.dsc);
+        PUT_BOOL(band, ais->type18.band);
+        PUT_BOOL(msg22, ais->type18.msg22);
+        PUT_BOOL(raim, ais->type18.raim);
+        PUT_UINT(radio, ais->type18.radio);
+        break;
+    case 19:			/* Extended Class B CS Position Report */
+        PUT_UINT(reserved, ais->type19.reserved);
+        PUT(speed, report_fixed((int)ais->type19.speed, 1, 1,
+                                ais->type19.speed / 10.0));
+        PUT_BOOL(accuracy, ais->type19.accuracy);
+        PUT(lon, report_fixed(ais->type19.lon, 60, 4,
+                              ais->type19.lon / AIS_LATLON_DIV));
+        PUT(lat, report_fixed(ais->type19.lat, 60, 4,
+                              ais->type19.lat / AIS_LATLON_DIV));
+        PUT(course, report_fixed((int)ais->type19.course, 1, 1,
+                                 ais->type19.course / 10.0));
+        PUT_UINT(heading, ais->type19.heading);
+        PUT_UINT(second, ais->type19.second);
+        PUT_UINT(regional, ais->type19.regional);
+        PUT_STR(shipname, ais->type19.shipname);
+        PUT_UINT(shiptype, ais->type19.shiptype);
+        PUT_LEGEND(shiptype_text, legend_shiptype, ais->type19.shiptype);
+        PUT_UINT(to_bow, ais->type19.to_bow);
+        PUT_UINT(to_stern, ais->type19.to_stern);
+        PUT_UINT(to_port, ais->type19.to_port);
+        PUT_UINT(to_starboard, ais->type19.to_starboard);
+        PUT_UINT(epfd, ais->type19.epfd);
+        PUT_LEGEND(epfd_text, legend_epfd, ais->type19.epfd);
+        PUT_BOOL(raim, ais->type19.raim);
+        PUT_UINT(dte, ais->type19.dte);
+        PUT_BOOL(assigned, ais->type19.assigned);
+        break;
+    case 20:			/* Data Link Management Message */
+        PUT_UINT(offset1, ais->type20.offset1);
+        PUT_UINT(number1, ais->type20.number1);
+        PUT_UINT(timeout1, ais->type20.timeout1);
+        PUT_UINT(increment1, ais->type20.increment1);
+        PUT_UINT(offset2, ais->type20.offset2);
+        PUT_UINT(number2, ais->type20.number2);
+        PUT_UINT(timeout2, ais->type20.timeout2);
+        PUT_UINT(increment2, ais->type20.increment2);
+        PUT_UINT(offset3, ais->type20.offset3);
+        PUT_UINT(number3, ais->type20.number3);
+        PUT_UINT(timeout3, ais->type20.timeout3);
+        PUT_UINT(increment3, ais->type20.increment3);
+        PUT_UINT(offset4, ais->type20.offset4);
+        PUT_UINT(number4, ais->type20.number4);
+        PUT_UINT(timeout4, ais->type20.timeout4);
+        PUT_UINT(increment4, ais->type20.increment4);
+        break;
+    case 21:			/* Aid to Navigation */
+        PUT_UINT(aid_type, ais->type21.aid_type);
+        PUT_LEGEND(aid_type_text, legend_navaid, ais->type21.aid_type);
+        PUT_STR(name, ais->type21.name);
+        PUT(lon, report_fixed(ais->type21.lon, 60, 4,
+                              ais->type21.lon / AIS_LATLON_DIV));
+        PUT(lat, report_fixed(ais->type21.lat, 60, 4,
+                              ais->type21.lat / AIS_LATLON_DIV));
+        PUT_BOOL(accuracy, ais->type21.accuracy);
+        PUT_UINT(to_bow, ais->type21.to_bow);
+        PUT_UINT(to_stern, ais->type21.to_stern);
+        PUT_UINT(to_port, ais->type21.to_port);
+        PUT_UINT(to_starboard, ais->type21.to_starboard);
+        PUT_UINT(epfd, ais->type21.epfd);
+        PUT_LEGEND(epfd_text, legend_epfd, ais->type21.epfd);
+        PUT_UINT(second, ais->type21.second);
+        PUT_UINT(regional, ais->type21.regional);
+        PUT_BOOL(off_position, ais->type21.off_position);
+        PUT_BOOL(raim, ais->type21.raim);
+        PUT_BOOL(virtual_aid, ais->type21.virtual_aid);
+        break;
+    case 22:			/* Channel Management */
+        PUT_UINT(channel_a, ais->type22.channel_a);
+        PUT_UINT(channel_b, ais->type22.channel_b);
+        PUT_UINT(txrx, ais->type22.txrx);
+        PUT_BOOL(power, ais->type22.power);
+        if (ais->type22.addressed) {
+            PUT_UINT(dest1, ais->type22.mmsi.dest1);
+            PUT_UINT(dest2, ais->type22.mmsi.dest2);
+        } else {
+            PUT(ne_lon, report_degrees(ais->type22.area.ne_lon,
+                                       AIS_CHANNEL_LATLON_DIV));
+            PUT(ne_lat, report_degrees(ais->type22.area.ne_lat,
+                                       AIS_CHANNEL_LATLON_DIV));
+            PUT(sw_lon, report_degrees(ais->type22.area.sw_lon,
+                                       AIS_CHANNEL_LATLON_DIV));
+            PUT(sw_lat, report_degrees(ais->type22.area.sw_lat,
+                                       AIS_CHANNEL_LATLON_DIV));
+        }
+        PUT_BOOL(addressed, ais->type22.addressed);
+        PUT_BOOL(band_a, ais->type22.band_a);
+        PUT_BOOL(band_b, ais->type22.band_b);
+        PUT_UINT(zonesize, ais->type22.zonesize);
+        break;
+    case 23:			/* Group Assignment Command */
+        PUT(ne_lon, report_degrees(ais->type23.ne_lon,
+                                   AIS_CHANNEL_LATLON_DIV));
+        PUT(ne_lat, report_degrees(ais->type23.ne_lat,
+                                   AIS_CHANNEL_LATLON_DIV));
+        PUT(sw_lon, report_degrees(ais->type23.sw_lon,
+                                   AIS_CHANNEL_LATLON_DIV));
+        PUT(sw_lat, report_degrees(ais->type23.sw_lat,
+                                   AIS_CHANNEL_LATLON_DIV));
+        PUT_UINT(stationtype, ais->type23.stationtype);
+        PUT_LEGEND(stationtype_text, legend_stationtype,
+                   ais->type23.stationtype);
+        PUT_UINT(shiptype, ais->type23.shiptype);
+        PUT_LEGEND(shiptype_text, legend_shiptype, ais->type23.shiptype);
+        PUT_UINT(interval, ais->type23.interval);
+        PUT_UINT(quiet, ais->type23.quiet);
+        break;
+    case 24:			/* Class B CS Static Data Report */
+        if (ais->type24.part == part_a)
+            PUT_REF(part, word[WORD_A]);
+        else if (ais->type24.part == part_b)
+            PUT_REF(part, word[WORD_B]);
+        if (ais->type24.part != part_b)
+            PUT_STR(shipname, ais->type24.shipname);
+        if (ais->type24.part != part_a) {
+            PUT_UINT(shiptype, ais->type24.shiptype);
+            PUT_LEGEND(shiptype_text, legend_shiptype, ais->type24.shiptype);
+            PUT_STR(vendorid, ais->type24.vendorid);
+            PUT_UINT(model, ais->type24.model);
+            PUT_UINT(serial, ais->type24.serial);
+            PUT_STR(callsign, ais->type24.callsign);
+            if (AIS_AUXILIARY_MMSI(ais->mmsi))
+                PUT_UINT(mothership_mmsi, ais->type24.mothership_mmsi);
+            else {
+                PUT_UINT(to_bow, ais->type24.dim.to_bow);
+                PUT_UINT(to_stern, ais->type24.dim.to_stern);
+                PUT_UINT(to_port, ais->type24.dim.to_port);
+                PUT_UINT(to_starboard, ais->type24.dim.to_starboard);
+            }
+        }
+        break;
+    case 25:			/* Binary Message, Single Slot */
+        PUT_BOOL(addressed, ais->type25.addressed);
+        PUT_BOOL(structured, ais->type25.structured);
+        PUT_UINT(dest_mmsi, ais->type25.dest_mmsi);
+        PUT_UINT(app_id, ais->type25.app_id);
+        PUT(data, report_data(ais->type25.bitdata, ais->type25.bitcount));
+        break;
+    case 26:			/* Binary Message, Multiple Slot */
+        PUT_BOOL(addressed, ais->type26.addressed);
+        PUT_BOOL(structured, ais->type26.structured);
+        PUT_UINT(dest_mmsi, ais->type26.dest_mmsi);
+        PUT_UINT(app_id, ais->type26.app_id);
+        PUT(data, report_data(ais->type26.bitdata, ais->type26.bitcount));
+        PUT_UINT(radio, ais->type26.radio);
+        break;
+    case 27:			/* Long Range AIS Broadcast message */
+        PUT_LEGEND(status, legend_nav, ais->type27.status);
+        PUT_BOOL(accuracy, ais->type27.accuracy);
+        PUT(lon, report_fixed(ais->type27.lon, 60, 1,
+                              ais->type27.lon / AIS_LONGRANGE_LATLON_DIV));
+        PUT(lat, report_fixed(ais->type27.lat, 60, 1,
+                              ais->type27.lat / AIS_LONGRANGE_LATLON_DIV));
+        PUT_UINT(speed, ais->type27.speed);
+        PUT_UINT(course, ais->type27.course);
+        PUT_BOOL(raim, ais->type27.raim);
+        PUT_BOOL(gnss, ais->type27.gnss);
+        break;
+    }
+    if (!ok)
+        Py_CLEAR(d);
+    return d;
+}
+
+#undef PUT
+#undef PUT_REF
+#undef PUT_UINT
+#undef PUT_BOOL
+#undef PUT_STR
+#undef PUT_LEGEND
+
+static PyObject*
+decoder_decode(DecoderObject *decoder, const char *msg, int native)
+{
     struct ais_t ais;
     
-    char buf[JSON_VAL_MAX * 2 + 1];
+    char buf[REPORT_MAX];
     size_t buflen = sizeof(buf);
     
-//    printf("Buffer: %s, length: %ul\n", buf, sizeof(buf));
-    
-    if (aivdm_decode(msg, strlen(msg)+1, &(session[decoderId]), &ais, 1)) {
-//      printf("type: %d, repeat: %d, mmsi: %d\n", ais.type, ais.repeat, ais.mmsi);
+    if (!decoder_ready(decoder))
+        return NULL;
+    if (aivdm_decode(msg, strlen(msg)+1, decoder->session, &ais, 1)) {
+        if (native)
+            return report_build(&ais);
         json_aivdm_dump(&ais, NULL, true, buf, buflen);
-//      printf("JSON: %s", buf);
         return Py_BuildValue("s", buf);
     }
     Py_INCREF(Py_None);
     return Py_None;
 }
 
+/* names of the checksum policies, in enum aivdm_checksum_t order */
+static const char *checksum_names[] = {"ignore", "flag", "reject"};
+
+static PyObject*
+decoder_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"checksum", NULL};
+    const char *checksum = "ignore";
+    DecoderObject *self;
+    int policy;
+
+    if (args != NULL
+        && !PyArg_ParseTupleAndKeywords(args, kwargs, "|s:Decoder", kwlist,
+                                        &checksum))
+        return NULL;
+    for (policy = 0; policy < NITEMS(checksum_names); policy++)
+        if (strcmp(checksum, checksum_names[policy]) == 0)
+            break;
+    if (policy == NITEMS(checksum_names))
+        return PyErr_Format(PyExc_ValueError, "bad checksum policy: '%s'",
+                            checksum);
+    if ((self = (DecoderObject *)type->tp_alloc(type, 0)) == NULL)
+        return NULL;
+    self->session = PyMem_Calloc(1, sizeof(*self->session));
+    if (self->session == NULL) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+    self->session->driver.aivdm.checksum = (enum aivdm_checksum_t)policy;
+    return (PyObject *)self;
+}
+
+static DecoderObject*
+decoder_assign(PyObject *module, int decoderId)
+/* hand out an id; borrowed */
+{
+    DecoderObject **legacy = LEGACY(module);
+
+    legacy[decoderId] = (DecoderObject *)decoder_new(&DecoderType, NULL, NULL);
+    return legacy[decoderId];
+}
+
+static PyObject*
+libais_decode(PyObject* self, PyObject* args, PyObject *kwargs)
+{
+    const char* msg;
+    int decoderId=-1;
+    int native=0;
+    DecoderObject *decoder;
+    
+    static char *kwlist[] = {"message","decoderId", "native", NULL};
+    
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|ip", kwlist, &msg, &decoderId, &native))
+        return NULL;
+
+    /* no decoder given means the default one, '0' */
+    if (decoderId == -1)
+        decoderId = 0;
+    if (decoderId < 0 || decoderId >= MAXDEVICES) {
+        PyErr_SetString(PyExc_ValueError, "no such decoder");
+        return NULL;
+    }
+
+    /* an id never handed out is assigned on first use */
+    if (LEGACY(self)[decoderId] == NULL
+        && decoder_assign(self, decoderId) == NULL)
+        return NULL;
+    decoder = LEGACY(self)[decoderId];
+    
+    return decoder_decode(decoder, msg, native);
+}
+
+/* one decoded message of a decode_many() call */
+struct many_report_t {
+    size_t line;		/* index into the input */
+    size_t offset;		/* of its JSON report in the text buffer */
+    size_t len;
+};
+
+static bool
+decode_many_nogil(const struct aivdm_span_t *span, size_t nspans,
+                  struct gps_device_t *sess, struct many_report_t **report,
+                  size_t *nreports, char **text)
+/* runs without the GIL, so it touches no Python objects; false on ENOMEM */
+{
+    struct ais_t *ais = malloc(MANY_BATCH * sizeof(*ais));
+    size_t *line = malloc(MANY_BATCH * sizeof(*line));
+    size_t done = 0, size = 0, textlen = 0, textsize = 0;
+    bool ok = ais != NULL && line != NULL;
+
+    *report = NULL;
+    *text = NULL;
+    *nreports = 0;
+    while (ok && done < nspans) {
+        struct aivdm_batch_t batch = {ais, MANY_BATCH, line, NULL, NULL,
+                                      (size_t)-1, true, 0, 0};
+        size_t used = aivdm_decode_spans(span + done, nspans - done,
+                                         sess, &batch);
+        size_t i;
+
+        /* grow both buffers for the worst case of this batch */
+        if (*nreports + batch.nais > size) {
+            struct many_report_t *grown;
+
+            size = 2 * (*nreports + batch.nais);
+            if ((grown = realloc(*report, size * sizeof(**report))) == NULL) {
+                ok = false;
+                break;
+            }
+            *report = grown;
+        }
+        if (textlen + batch.nais * REPORT_MAX > textsize) {
+            char *grown;
+
+            textsize = 2 * (textlen + batch.nais * REPORT_MAX);
+            if ((grown = realloc(*text, textsize)) == NULL) {
+                ok = false;
+                break;
+            }
+            *text = grown;
+        }
+        for (i = 0; i < batch.nais; i++) {
+            struct many_report_t *r = &(*report)[(*nreports)++];
+            char *out = *text + textlen;
+
+            r->line = done + line[i];
+            r->offset = textlen;
+            r->len = json_aivdm_dump(&ais[i], NULL, true, out, REPORT_MAX);
+            if (r->len >= REPORT_MAX)	/* truncated, as decode() returns it */
+                r->len = strnlen(out, REPORT_MAX);
+            textlen += r->len;
+        }
+        if (used == 0)
+            break;
+        done += used;
+    }
+    free(ais);
+    free(line);
+    return ok;
+}
+
+static bool
+decode_many_native(const struct aivdm_span_t *span, size_t nspans,
+                   struct gps_device_t *sess, PyObject *result)
+/* decodes a batch at a time without the GIL, then builds its reports */
+{
+    struct ais_t *ais = PyMem_Malloc(MANY_BATCH * sizeof(*ais));
+    size_t *line = PyMem_Malloc(MANY_BATCH * sizeof(*line));
+    size_t done = 0, used, i;
+    bool ok = ais != NULL && line != NULL;
+
+    if (!ok)
+        PyErr_NoMemory();
+    while (ok && done < nspans) {
+        struct aivdm_batch_t batch = {ais, MANY_BATCH, line, NULL, NULL,
+                                      (size_t)-1, true, 0, 0};
+
+        Py_BEGIN_ALLOW_THREADS
+        used = aivdm_decode_spans(span + done, nspans - done, sess, &batch);
+        Py_END_ALLOW_THREADS
+        for (i = 0; ok && i < batch.nais; i++) {
+            PyObject *report = report_build(&ais[i]);
+
+            ok = report != NULL
+                && PyList_SetItem(result, (Py_ssize_t)(done + line[i]),
+                                  report) == 0;
+        }
+        if (used == 0)
+            break;
+        done += used;
+    }
+    PyMem_Free(ais);
+    PyMem_Free(line);
+    return ok;
+}
+
+static PyObject*
+decoder_decode_many(DecoderObject *decoder, PyObject *lines, int native)
+{
+    PyObject *items, *result = NULL;
+    struct aivdm_span_t *span;
+    struct many_report_t *report;
+    size_t nspans, nreports, i;
+    char *text;
+    bool ok;
+
+    if (!decoder_ready(decoder))
+        return NULL;
+    /* a tuple of our own, so the strings outlive any change to lines */
+    if ((items = PySequence_Tuple(lines)) == NULL)
+        return NULL;
+    nspans = (size_t)PyTuple_GET_SIZE(items);
+    if ((span = PyMem_Malloc((nspans + 1) * sizeof(*span))) == NULL) {
+        Py_DECREF(items);
+        return PyErr_NoMemory();
+    }
+    for (i = 0; i < nspans; i++) {
+        PyObject *item = PyTuple_GET_ITEM(items, i);
+        Py_ssize_t len;
+        const char *ptr;
+
+        if (PyUnicode_Check(item))
+            ptr = PyUnicode_AsUTF8AndSize(item, &len);
+        else if (PyBytes_Check(item)) {
+            ptr = PyBytes_AS_STRING(item);
+            len = PyBytes_GET_SIZE(item);
+        }
+        else {
+            PyErr_Format(PyExc_TypeError,
+                         "lines must be str or bytes, not %.100s",
+                         Py_TYPE(item)->tp_name);
+            ptr = NULL;
+        }
+        if (ptr == NULL) {
+            PyMem_Free(span);
+            Py_DECREF(items);
+            return NULL;
+        }
+        /* as read from a file, with its line ending */
+        while (len > 0 && (ptr[len - 1] == '\n' || ptr[len - 1] == '\r'))
+            len--;
+        span[i].ptr = ptr;
+        span[i].len = (size_t)len;
+    }
+
+    /* one entry per line: the report it completed, or None */
+    if ((result = PyList_New((Py_ssize_t)nspans)) == NULL) {
+        PyMem_Free(span);
+        Py_DECREF(items);
+        return NULL;
+    }
+    for (i = 0; i < nspans; i++) {
+        Py_INCREF(Py_None);
+        PyList_SET_ITEM(result, (Py_ssize_t)i, Py_None);
+    }
+
+    decoder->busy = true;
+    if (native) {
+        if (!decode_many_native(span, nspans, decoder->session, result))
+            Py_CLEAR(result);
+        decoder->busy = false;
+        PyMem_Free(span);
+        Py_DECREF(items);
+        return result;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    ok = decode_many_nogil(span, nspans, decoder->session,
+                           &report, &nreports, &text);
+    Py_END_ALLOW_THREADS
+    decoder->busy = false;
+    PyMem_Free(span);
+
+    if (!ok) {
+        PyErr_NoMemory();
+        Py_CLEAR(result);
+    }
+    for (i = 0; result != NULL && i < nreports; i++) {
+        PyObject *json = PyUnicode_FromStringAndSize(
+            text + report[i].offset, (Py_ssize_t)report[i].len);
+
+        if (json == NULL
+            || PyList_SetItem(result, (Py_ssize_t)report[i].line, json) < 0)
+            Py_CLEAR(result);
+    }
+    free(report);
+    free(text);
+    Py_DECREF(items);
+    return result;
+}
+
+static PyObject*
+libais_decode_many(PyObject* self, PyObject* args, PyObject *kwargs)
+{
+    PyObject *lines, *result;
+    int decoderId, native = 0;
+    DecoderObject *decoder;
+
+    static char *kwlist[] = {"lines", "decoderId", "native", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|p", kwlist,
+                                     &lines, &decoderId, &native))
+        return NULL;
+    if ((decoder = decoder_by_id(self, decoderId)) == NULL)
+        return NULL;
+    /* lines may run code that releases the id */
+    Py_INCREF(decoder);
+    result = decoder_decode_many(decoder, lines, native);
+    Py_DECREF(decoder);
+    return result;
+}
+
+/*
+ * Columnar position reports, for bulk work from Python.  The input is
+ * a whole chunk of a log in any contiguous buffer; it is split into
+ * lines and decoded without the GIL, and the results go into typed
+ * arrays rather than an object per message.
+ */
+static const struct position_column_t {
+    const char *name;
+    const char *format;		/* as in the struct module */
+    Py_ssize_t itemsize;
+    size_t member;		/* offset of the column in aivdm_positions_t */
+} position_column[] = {
+    {"line", "N", sizeof(size_t), offsetof(struct aivdm_positions_t, line)},
+    {"type", "B", 1, offsetof(struct aivdm_positions_t, type)},
+    {"mmsi", "I", sizeof(unsigned int),
+     offsetof(struct aivdm_positions_t, mmsi)},
+    {"second", "B", 1, offsetof(struct aivdm_positions_t, second)},
+    {"lat", "d", sizeof(double), offsetof(struct aivdm_positions_t, lat)},
+    {"lon", "d", sizeof(double), offsetof(struct aivdm_positions_t, lon)},
+    {"sog", "f", sizeof(float), offsetof(struct aivdm_positions_t, sog)},
+    {"cog", "f", sizeof(float), offsetof(struct aivdm_positions_t, cog)},
+    {"heading", "H", sizeof(unsigned short),
+     offsetof(struct aivdm_positions_t, heading)},
+};
+#define NCOLUMNS	NITEMS(position_column)
+
+#define COLUMN(pos, c) \
+	(*(void **)((char *)(pos) + position_column[c].member))
+
+static size_t
+positions_run(Py_buffer *data, DecoderObject *decoder, bool final,
+              struct aivdm_positions_t *pos)
+/* the decode itself, without the GIL; returns the bytes consumed */
+{
+    size_t used;
+
+    pos->flush = final;
+    decoder->busy = true;
+    Py_BEGIN_ALLOW_THREADS
+    used = aivdm_decode_positions(data->buf, (size_t)data->len,
+                                  decoder->session, pos);
+    Py_END_ALLOW_THREADS
+    decoder->busy = false;
+    return used;
+}
+
+static PyObject*
+decoder_positions(DecoderObject *decoder, Py_buffer *data, int final)
+{
+    struct aivdm_positions_t pos;
+    PyObject *array[NCOLUMNS] = {NULL}, *columns = NULL, *result = NULL;
+    const char *p, *end;
+    size_t rows = 1, used;
+    int c;
+
+    if (!decoder_ready(decoder))
+        return NULL;
+
+    /* a row per line at most */
+    for (p = data->buf, end = p + data->len;
+         (p = memchr(p, '\n', (size_t)(end - p))) != NULL; p++)
+        rows++;
+    memset(&pos, 0, sizeof(pos));
+    pos.maxrows = rows;
+    for (c = 0; c < NCOLUMNS; c++) {
+        array[c] = PyByteArray_FromStringAndSize(NULL,
+            (Py_ssize_t)rows * position_column[c].itemsize);
+        if (array[c] == NULL)
+            goto done;
+        COLUMN(&pos, c) = PyByteArray_AS_STRING(array[c]);
+    }
+
+    used = positions_run(data, decoder, final, &pos);
+
+    if ((columns = PyDict_New()) == NULL)
+        goto done;
+    for (c = 0; c < NCOLUMNS; c++) {
+        PyObject *view;
+        int rc;
+
+        if (PyByteArray_Resize(array[c], (Py_ssize_t)pos.nrows
+                               * position_column[c].itemsize) < 0)
+            goto done;
+        if ((view = PyMemoryView_FromObject(array[c])) == NULL)
+            goto done;
+        Py_SETREF(view, PyObject_CallMethod(view, "cast", "s",
+                                            position_column[c].format));
+        if (view == NULL)
+            goto done;
+        rc = PyDict_SetItemString(columns, position_column[c].name, view);
+        Py_DECREF(view);
+        if (rc < 0)
+            goto done;
+    }
+    result = Py_BuildValue("nO", (Py_ssize_t)used, columns);
+done:
+    for (c = 0; c < NCOLUMNS; c++)
+        Py_XDECREF(array[c]);
+    Py_XDECREF(columns);
+    return result;
+}
+
+static PyObject*
+libais_decode_positions(PyObject* self, PyObject* args, PyObject *kwargs)
+{
+    Py_buffer data;
+    int decoderId, final = 0;
+    DecoderObject *decoder;
+    PyObject *result = NULL;
+
+    static char *kwlist[] = {"data", "decoderId", "final", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*i|p", kwlist,
+                                     &data, &decoderId, &final))
+        return NULL;
+    if ((decoder = decoder_by_id(self, decoderId)) != NULL)
+        result = decoder_positions(decoder, &data, final);
+    PyBuffer_Release(&data);
+    return result;
+}
+
+static bool
+format_matches(const char *format, const struct position_column_t *col)
+/* same kind of number, ignoring a native byte order mark */
+{
+    static const char unsigned_int[] = "BHILQN", real[] = "fd";
+
+    if (format == NULL)
+        format = "B";
+    if (*format == '@' || *format == '='
+#if PY_LITTLE_ENDIAN
+        || *format == '<'
+#else
+        || *format == '>'
+#endif
+        )
+        format++;
+    if (format[0] == '\0' || format[1] != '\0')
+        return false;
+    if (strchr(unsigned_int, col->format[0]) != NULL)
+        return strchr(unsigned_int, format[0]) != NULL;
+    return strchr(real, format[0]) != NULL;
+}
+
+static PyObject*
+decoder_positions_into(DecoderObject *decoder, PyObject *out,
+                       Py_buffer *data, int final)
+{
+    PyObject *result = NULL;
+    Py_buffer view[NCOLUMNS];
+    bool have[NCOLUMNS] = {false};
+    char *scratch[NCOLUMNS] = {NULL};
+    int c;
+    struct aivdm_positions_t pos;
+    size_t used, i;
+
+    memset(&pos, 0, sizeof(pos));
+    pos.maxrows = (size_t)-1;
+    if (!decoder_ready(decoder))
+        return NULL;
+
+    /* out[name] for each column out has, be it a dict or a structured array */
+    for (c = 0; c < NCOLUMNS; c++) {
+        const struct position_column_t *col = &position_column[c];
+        PyObject *target = PyMapping_GetItemString(out, col->name);
+        int rc;
+
+        if (target == NULL) {
+            if (!PyErr_ExceptionMatches(PyExc_LookupError)
+                && !PyErr_ExceptionMatches(PyExc_ValueError))
+                goto done;
+            PyErr_Clear();
+            continue;
+        }
+        rc = PyObject_GetBuffer(target, &view[c], PyBUF_RECORDS);
+        Py_DECREF(target);
+        if (rc < 0)
+            goto done;
+        have[c] = true;
+        if (view[c].ndim != 1 || view[c].itemsize != col->itemsize
+            || !format_matches(view[c].format, col)) {
+            PyErr_Format(PyExc_TypeError,
+                         "column '%s' must be one-dimensional, of format '%s'",
+                         col->name, col->format);
+            goto done;
+        }
+        if ((size_t)view[c].shape[0] < pos.maxrows)
+            pos.maxrows = (size_t)view[c].shape[0];
+        if (view[c].strides[0] == col->itemsize)
+            COLUMN(&pos, c) = view[c].buf;
+    }
+    if (pos.maxrows == (size_t)-1) {
+        PyErr_SetString(PyExc_TypeError, "out has no position columns");
+        goto done;
+    }
+    /* strided columns, such as the fields of a structured array */
+    for (c = 0; c < NCOLUMNS; c++)
+        if (have[c] && COLUMN(&pos, c) == NULL) {
+            scratch[c] = PyMem_Malloc(pos.maxrows * (size_t)view[c].itemsize + 1);
+            if (scratch[c] == NULL) {
+                PyErr_NoMemory();
+                goto done;
+            }
+            COLUMN(&pos, c) = scratch[c];
+        }
+
+    used = positions_run(data, decoder, final, &pos);
+
+    for (c = 0; c < NCOLUMNS; c++)
+        if (scratch[c] != NULL)
+            for (i = 0; i < pos.nrows; i++)
+                memcpy((char *)view[c].buf + (Py_ssize_t)i * view[c].strides[0],
+                       scratch[c] + i * (size_t)view[c].itemsize,
+                       (size_t)view[c].itemsize);
+    result = Py_BuildValue("nn", (Py_ssize_t)used, (Py_ssize_t)pos.nrows);
+done:
+    for (c = 0; c < NCOLUMNS; c++) {
+        if (have[c])
+            PyBuffer_Release(&view[c]);
+        PyMem_Free(scratch[c]);
+    }
+    return result;
+}
+
+static PyObject*
+libais_decode_positions_into(PyObject* self, PyObject* args, PyObject *kwargs)
+{
+    PyObject *out, *result = NULL;
+    Py_buffer data;
+    int decoderId, final = 0;
+    DecoderObject *decoder;
+
+    static char *kwlist[] = {"out", "data", "decoderId", "final", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oy*i|p", kwlist,
+                                     &out, &data, &decoderId, &final))
+        return NULL;
+    if ((decoder = decoder_by_id(self, decoderId)) != NULL) {
+        /* out[name] may run code that releases the id */
+        Py_INCREF(decoder);
+        result = decoder_positions_into(decoder, out, &data, final);
+        Py_DECREF(decoder);
+    }
+    PyBuffer_Release(&data);
+    return result;
+}
+
+static int
+stats_put(PyObject *dict, const char *key, unsigned long value)
+{
+    PyObject *v = PyLong_FromUnsignedLong(value);
+    int err;
+
+    if (v == NULL)
+        return -1;
+    err = PyDict_SetItemString(dict, key, v);
+    Py_DECREF(v);
+    return err;
+}
+
+static PyObject*
+decoder_stats(DecoderObject *decoder)
+/* the counters are kept by the decoder anyway; this only copies them */
+{
+    const struct aivdm_stats_t *stats;
+    PyObject *dict, *types = NULL;
+    int i;
+
+    if (!decoder_ready(decoder))
+        return NULL;
+    stats = &decoder->session->driver.aivdm.stats;
+    if ((dict = PyDict_New()) == NULL)
+        return NULL;
+    if (stats_put(dict, "sentences", stats->sentences) < 0
+        || stats_put(dict, "decoded", stats->decoded) < 0
+        || stats_put(dict, "pending_fragments",
+                     aivdm_pending_fragments(decoder->session)) < 0
+        || stats_put(dict, "checksum_errors", stats->checksum_errors) < 0
+        || stats_put(dict, "bad_channel", stats->bad_channel) < 0
+        || stats_put(dict, "partials_dropped", stats->partials_dropped) < 0
+        || stats_put(dict, "partials_expired", stats->partials_expired) < 0
+        || stats_put(dict, "filter_matched", stats->filter_matched) < 0
+        || stats_put(dict, "filter_skipped", stats->filter_skipped) < 0
+        || (types = PyDict_New()) == NULL)
+        goto fail;
+    for (i = 0; i < AIVDM_TYPES; i++) {
+        PyObject *k, *v;
+        int err;
+
+        if (stats->types[i] == 0)
+            continue;
+        k = PyLong_FromLong(i);
+        v = PyLong_FromUnsignedLong(stats->types[i]);
+        err = (k == NULL || v == NULL) ? -1 : PyDict_SetItem(types, k, v);
+        Py_XDECREF(k);
+        Py_XDECREF(v);
+        if (err < 0)
+            goto fail;
+    }
+    if (PyDict_SetItemString(dict, "types", types) < 0)
+        goto fail;
+    Py_DECREF(types);
+    return dict;
+fail:
+    Py_XDECREF(types);
+    Py_DECREF(dict);
+    return NULL;
+}
+
+static PyObject*
+libais_stats(PyObject* self, PyObject* args)
+{
+    int decoderId;
+    DecoderObject *decoder;
+
+    if (!PyArg_ParseTuple(args, "i", &decoderId))
+        return NULL;
+    if ((decoder = decoder_by_id(self, decoderId)) == NULL)
+        return NULL;
+    return decoder_stats(decoder);
+}
+
 static PyObject*
 libais_getDecoderId(PyObject* self)
 {
     for (int i=0; i<MAXDEVICES; i++) {
-        if (assigned[i]==false) {
-            assigned[i]=true;
+        if (LEGACY(self)[i] == NULL) {
+            if (decoder_assign(self, i) == NULL)
+                return NULL;
             return Py_BuildValue("i", i);
         }
     }
@@ -82,32 +1537,210 @@ static PyObject*
 libais_releaseDecoderId(PyObject* self, PyObject* args)
 {
     int decoderId;
+    DecoderObject *decoder;
     
     if (!PyArg_ParseTuple(args, "i", &decoderId))
         return NULL;
+    if ((decoder = decoder_by_id(self, decoderId)) == NULL)
+        return NULL;
+    if (!decoder_ready(decoder))
+        return NULL;
     
-    if (assigned[decoderId]==true) {
-        assigned[decoderId]=false;
-        return Py_BuildValue("i", 0);
-    }
-    return NULL;
+    /* the next user of the id starts afresh */
+    Py_CLEAR(LEGACY(self)[decoderId]);
+    return Py_BuildValue("i", 0);
 }
 
+static void
+decoder_dealloc(DecoderObject *self)
+{
+    PyMem_Free(self->session);
+    Py_XDECREF(self->watchlist);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject*
+Decoder_decode(DecoderObject *self, PyObject *args, PyObject *kwargs)
+{
+    const char *msg;
+    int native = 0;
+
+    static char *kwlist[] = {"message", "native", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|p", kwlist,
+                                     &msg, &native))
+        return NULL;
+    return decoder_decode(self, msg, native);
+}
+
+static PyObject*
+Decoder_decode_many(DecoderObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *lines;
+    int native = 0;
+
+    static char *kwlist[] = {"lines", "native", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|p", kwlist,
+                                     &lines, &native))
+        return NULL;
+    return decoder_decode_many(self, lines, native);
+}
+
+static PyObject*
+Decoder_decode_positions(DecoderObject *self, PyObject *args,
+                         PyObject *kwargs)
+{
+    Py_buffer data;
+    int final = 0;
+    PyObject *result;
+
+    static char *kwlist[] = {"data", "final", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|p", kwlist,
+                                     &data, &final))
+        return NULL;
+    result = decoder_positions(self, &data, final);
+    PyBuffer_Release(&data);
+    return result;
+}
+
+static PyObject*
+Decoder_decode_positions_into(DecoderObject *self, PyObject *args,
+                              PyObject *kwargs)
+{
+    PyObject *out, *result;
+    Py_buffer data;
+    int final = 0;
+
+    static char *kwlist[] = {"out", "data", "final", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oy*|p", kwlist,
+                                     &out, &data, &final))
+        return NULL;
+    result = decoder_positions_into(self, out, &data, final);
+    PyBuffer_Release(&data);
+    return result;
+}
+
+static PyObject*
+Decoder_set_filter(DecoderObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *types = Py_None, *mmsi = Py_None;
+
+    static char *kwlist[] = {"types", "mmsi", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OO", kwlist,
+                                     &types, &mmsi))
+        return NULL;
+    return decoder_set_filter(self, types, mmsi);
+}
+
+static PyObject*
+Decoder_stats(DecoderObject *self)
+{
+    return decoder_stats(self);
+}
+
+static PyMethodDef decoder_methods[] =
+{
+    {"decode", (PyCFunction)Decoder_decode, METH_VARARGS|METH_KEYWORDS, "decode(message, native=False): as the module's decode()."},
+    {"decode_many", (PyCFunction)Decoder_decode_many, METH_VARARGS|METH_KEYWORDS, "decode_many(lines, native=False): as the module's decode_many()."},
+    {"decode_positions", (PyCFunction)Decoder_decode_positions, METH_VARARGS|METH_KEYWORDS, "decode_positions(data, final=False): as the module's decode_positions()."},
+    {"decode_positions_into", (PyCFunction)Decoder_decode_positions_into, METH_VARARGS|METH_KEYWORDS, "decode_positions_into(out, data, final=False): as the module's decode_positions_into()."},
+    {"set_filter", (PyCFunction)Decoder_set_filter, METH_VARARGS|METH_KEYWORDS, "set_filter(types=None, mmsi=None): as the module's setFilter()."},
+    {"stats", (PyCFunction)Decoder_stats, METH_NOARGS, "stats(): as the module's stats()."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyTypeObject DecoderType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "libais.Decoder",
+    .tp_basicsize = sizeof(DecoderObject),
+    .tp_dealloc = (destructor)decoder_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Decoder(checksum='ignore'): an AIVDM decoder with its own reassembly state, freed with it. checksum is what is done with a sentence failing its NMEA checksum: 'ignore' does not check it, 'flag' counts it in stats() and decodes it, 'reject' counts and drops it. Decoders are independent: one per thread may run with the GIL released.",
+    .tp_methods = decoder_methods,
+    .tp_new = decoder_new,
+};
+
 static PyMethodDef libais_methods[] =
 {
-    {"decode", (PyCFunction)libais_decode, METH_VARARGS|METH_KEYWORDS, "Decode AIVDM sentence."},
+    {"decode", (PyCFunction)libais_decode, METH_VARARGS|METH_KEYWORDS, "Decode AIVDM sentence. With native=True the report is a dict instead of JSON text."},
+    {"decode_many", (PyCFunction)libais_decode_many, METH_VARARGS|METH_KEYWORDS, "Decode a sequence of AIVDM sentences, str or bytes, with the GIL released. Returns a list with the report each line completed, or 'None'; native=True gives dicts instead of JSON text."},
+    {"decode_positions", (PyCFunction)libais_decode_positions, METH_VARARGS|METH_KEYWORDS, "Decode the position reports in a chunk of a log, bytes or any contiguous buffer, with the GIL released. Returns the number of bytes consumed, an unterminated last line being left for the next call unless final=True, and a dict of typed memoryviews, one per column: line, type, mmsi, second, lat, lon, sog, cog, heading."},
+    {"decode_positions_into", (PyCFunction)libais_decode_positions_into, METH_VARARGS|METH_KEYWORDS, "As decode_positions(), filling out[name] for each column out has, such as the fields of a numpy structured array or a dict of arrays. Returns the number of bytes consumed and the number of rows written; decoding stops when the shortest column is full."},
     {"getDecoderId" , (PyCFunction)libais_getDecoderId, METH_NOARGS, "Get a decoder id. Returns 'None' if no decoders are available."},
     {"releaseDecoderId", (PyCFunction)libais_releaseDecoderId, METH_VARARGS, "Give decoderId back."},
+    {"setFilter", (PyCFunction)libais_setFilter, METH_VARARGS|METH_KEYWORDS, "Drop messages unless of one of the given types and from an MMSI in the given set, before decoding them. 'None' admits all."},
+    {"stats", (PyCFunction)libais_stats, METH_VARARGS, "Counters of a decoder since it was assigned, as a dict: sentences seen, messages decoded, fragments held awaiting the rest of their message, checksum errors (counted unless the checksum policy is 'ignore', the default), sentences on a channel other than A or B (bad_channel), multipart messages dropped or expired unfinished, sentences the filter matched and skipped, and 'types', decoded messages by type."},
+    {"loadMMSISet", (PyCFunction)libais_loadMMSISet, METH_VARARGS, "Read an MMSISet from a text file of one MMSI per line."},
     {NULL, NULL, 0, NULL}
 };
 
-PyMODINIT_FUNC
-initlibais(void)
+static int
+libais_exec(PyObject *module)
 {
-    // Initialize deocder assignment array
-    for (int i=0; i<MAXDEVICES; i++) {
-        assigned[i]=false;
+    /* settle everything shared before any call can drop the GIL */
+    aivdm_init();
+    if (report_init() < 0)
+        return -1;
+    if (PyType_Ready(&MMSISetType) < 0 || PyType_Ready(&DecoderType) < 0)
+        return -1;
+    Py_INCREF(&MMSISetType);
+    if (PyModule_AddObject(module, "MMSISet", (PyObject *)&MMSISetType) < 0) {
+        Py_DECREF(&MMSISetType);
+        return -1;
+    }
+    Py_INCREF(&DecoderType);
+    if (PyModule_AddObject(module, "Decoder", (PyObject *)&DecoderType) < 0) {
+        Py_DECREF(&DecoderType);
+        return -1;
     }
+    return 0;
+}
+
+static int
+libais_traverse(PyObject *module, visitproc visit, void *arg)
+{
+    for (int i = 0; i < MAXDEVICES; i++)
+        Py_VISIT(LEGACY(module)[i]);
+    return 0;
+}
 
-    (void) Py_InitModule("libais", libais_methods);
+static int
+libais_clear(PyObject *module)
+{
+    for (int i = 0; i < MAXDEVICES; i++)
+        Py_CLEAR(LEGACY(module)[i]);
+    return 0;
+}
+
+static void
+libais_free(void *module)
+{
+    (void)libais_clear((PyObject *)module);
+}
+
+static PyModuleDef_Slot libais_slots[] = {
+    {Py_mod_exec, libais_exec},
+    {0, NULL}
+};
+
+static struct PyModuleDef libais_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "libais",
+    .m_doc = "Decoding of AIS/NMEA sentences.",
+    .m_size = sizeof(LibaisState),
+    .m_methods = libais_methods,
+    .m_slots = libais_slots,
+    .m_traverse = libais_traverse,
+    .m_clear = libais_clear,
+    .m_free = libais_free,
+};
+
+PyMODINIT_FUNC
+PyInit_libais(void)
+{
+    return PyModuleDef_Init(&libais_module);
 }
@@ -8,6 +8,8 @@
 
 #include <syslog.h>
 #include <assert.h>
+#include <pthread.h>
+#include <math.h>
 
 #include "libais.h"
 
@@ -56,170 +58,642 @@ const char /*@ observer @*/ *gpsd_hexdump(char *scbuf, size_t scbuflen,
  *
  **************************************************************************/
 
-/*@ -fixedformalarray -usedef -branchstate @*/
-bool aivdm_decode(const char *buf, size_t buflen,
-                         struct gps_device_t *session,
-                         struct ais_t *ais,
-                         int debug)
+/*
+ * Six-bit value of each armored payload character.  The armoring maps
+ * 0-39 onto '0'-'W' and 40-63 onto '`'-'w'; everything else is marked
+ * AIVDM_ARMOR_INVALID, which has bits set above the low six.
+ */
+#define AIVDM_ARMOR_INVALID	0xff
+static const unsigned char aivdm_armor[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+/*
+ * Vectorized de-armoring.  Each kernel converts whole blocks of 16 or
+ * 32 armored characters into 12 or 24 bytes at a byte-aligned output
+ * position and returns the number of characters consumed.  It stops
+ * in front of any block holding an invalid character, so the scalar
+ * loop below sees it and rejects the sentence.  Kernels store a full
+ * vector, so they only run while that many bytes of room remain.
+ */
+typedef size_t (*aivdm_unpack_t)(unsigned char *out, size_t room,
+                                 const unsigned char *data, size_t len);
+
+static size_t aivdm_unpack_scalar(unsigned char *out UNUSED, size_t room UNUSED,
+                                  const unsigned char *data UNUSED,
+                                  size_t len UNUSED)
 {
-#ifdef __UNUSED_DEBUG__
-    char *sixbits[64] = {
-        "000000", "000001", "000010", "000011", "000100",
-        "000101", "000110", "000111", "001000", "001001",
-        "001010", "001011", "001100", "001101", "001110",
-        "001111", "010000", "010001", "010010", "010011",
-        "010100", "010101", "010110", "010111", "011000",
-        "011001", "011010", "011011", "011100", "011101",
-        "011110", "011111", "100000", "100001", "100010",
-        "100011", "100100", "100101", "100110", "100111",
-        "101000", "101001", "101010", "101011", "101100",
-        "101101", "101110", "101111", "110000", "110001",
-        "110010", "110011", "110100", "110101", "110110",
-        "110111", "111000", "111001", "111010", "111011",
-        "111100", "111101", "111110", "111111",
-    };
-#endif /* __UNUSED_DEBUG__ */
-    int nfrags, ifrag, nfields = 0;
-    unsigned char *field[NMEA_MAX*2];
-    unsigned char fieldcopy[NMEA_MAX*2+1];
-    unsigned char *data, *cp;
-    unsigned char pad;
-    //struct aivdm_context_t *ais_context = malloc(sizeof *ais_context);
-    struct aivdm_context_t *ais_context;
+    return 0;
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+
+__attribute__((target("sse4.1")))
+static size_t aivdm_unpack_sse41(unsigned char *out, size_t room,
+                                 const unsigned char *data, size_t len)
+{
+    const __m128i lo_min = _mm_set1_epi8('0' - 1);
+    const __m128i lo_max = _mm_set1_epi8('W' + 1);
+    const __m128i hi_min = _mm_set1_epi8('`' - 1);
+    const __m128i hi_max = _mm_set1_epi8('w' + 1);
+    const __m128i order = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                        14, 13, 12, -1, -1, -1, -1);
+    size_t i;
+
+    for (i = 0; i + 16 <= len && i / 4 * 3 + 16 <= room; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i lo = _mm_and_si128(_mm_cmpgt_epi8(c, lo_min),
+                                   _mm_cmplt_epi8(c, lo_max));
+        __m128i hi = _mm_and_si128(_mm_cmpgt_epi8(c, hi_min),
+                                   _mm_cmplt_epi8(c, hi_max));
+        __m128i v;
+
+        if (_mm_movemask_epi8(_mm_or_si128(lo, hi)) != 0xffff)
+            break;
+        /* '0'-'W' -> 0-39, '`'-'w' -> 40-63 */
+        v = _mm_sub_epi8(_mm_sub_epi8(c, _mm_set1_epi8('0')),
+                         _mm_and_si128(hi, _mm_set1_epi8(8)));
+        /* merge pairs into 12 bits, then pairs of those into 24 */
+        v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+        v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+        v = _mm_shuffle_epi8(v, order);
+        _mm_storeu_si128((__m128i *)(out + i / 4 * 3), v);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t aivdm_unpack_avx2(unsigned char *out, size_t room,
+                                const unsigned char *data, size_t len)
+{
+    const __m256i lo_min = _mm256_set1_epi8('0' - 1);
+    const __m256i lo_max = _mm256_set1_epi8('W' + 1);
+    const __m256i hi_min = _mm256_set1_epi8('`' - 1);
+    const __m256i hi_max = _mm256_set1_epi8('w' + 1);
+    const __m256i order = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                           14, 13, 12, -1, -1, -1, -1,
+                                           2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                           14, 13, 12, -1, -1, -1, -1);
+    const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+    size_t i;
+
+    for (i = 0; i + 32 <= len && i / 4 * 3 + 32 <= room; i += 32) {
+        __m256i c = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i lo = _mm256_and_si256(_mm256_cmpgt_epi8(c, lo_min),
+                                      _mm256_cmpgt_epi8(lo_max, c));
+        __m256i hi = _mm256_and_si256(_mm256_cmpgt_epi8(c, hi_min),
+                                      _mm256_cmpgt_epi8(hi_max, c));
+        __m256i v;
+
+        if (_mm256_movemask_epi8(_mm256_or_si256(lo, hi)) != -1)
+            break;
+        v = _mm256_sub_epi8(_mm256_sub_epi8(c, _mm256_set1_epi8('0')),
+                            _mm256_and_si256(hi, _mm256_set1_epi8(8)));
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, order);
+        /* each lane holds 12 bytes; close the gap between them */
+        v = _mm256_permutevar8x32_epi32(v, compact);
+        _mm256_storeu_si256((__m256i *)(out + i / 4 * 3), v);
+    }
+    /* finish with at most one 16-character block */
+    return i + aivdm_unpack_sse41(out + i / 4 * 3, room - i / 4 * 3,
+                                  data + i, len - i);
+}
+#endif /* x86 */
+
+static size_t aivdm_unpack_resolve(unsigned char *, size_t,
+                                   const unsigned char *, size_t);
+
+/* chosen by aivdm_init(); every candidate gives identical output */
+static aivdm_unpack_t aivdm_unpack = aivdm_unpack_resolve;
+static pthread_once_t aivdm_unpack_once = PTHREAD_ONCE_INIT;
+
+static void aivdm_unpack_choose(void)
+{
+    aivdm_unpack_t unpack = aivdm_unpack_scalar;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        unpack = aivdm_unpack_avx2;
+    else if (__builtin_cpu_supports("sse4.1"))
+        unpack = aivdm_unpack_sse41;
+#endif
+    aivdm_unpack = unpack;
+}
+
+void aivdm_init(void)
+{
+    (void)pthread_once(&aivdm_unpack_once, aivdm_unpack_choose);
+}
+
+static size_t aivdm_unpack_resolve(unsigned char *out, size_t room,
+                                   const unsigned char *data, size_t len)
+/* first use without aivdm_init() */
+{
+    aivdm_init();
+    return aivdm_unpack(out, room, data, len);
+}
+
+static bool aivdm_dearmor(struct aivdm_context_t *ais_context,
+                          const unsigned char *data, size_t len)
+/* append len armored characters to the context's bit buffer */
+{
+    size_t bitlen = ais_context->bitlen;
+    unsigned char *out;
+    unsigned int nacc;		/* bits pending in acc, always < CHAR_BIT */
+    uint32_t acc;
+    size_t i;
+
+    /* written so that neither side can wrap */
+    if (bitlen > AIVDM_MAX_BITS || 6 * len > AIVDM_MAX_BITS - bitlen) {
+//        gpsd_report(&session->context->errout, LOG_INF,
+//                    "overlong AIVDM payload truncated.\n");
+        return false;
+    }
+
+    /* carry over the valid leading bits of a partially filled byte */
+    out = ais_context->bits + bitlen / CHAR_BIT;
+    nacc = bitlen % CHAR_BIT;
+    acc = (nacc != 0) ? (uint32_t)(*out >> (CHAR_BIT - nacc)) : 0;
+
+    /* vector stage, only from a byte boundary */
+    i = 0;
+    if (nacc == 0) {
+        i = aivdm_unpack(out,
+                         sizeof(ais_context->bits) - (size_t)(out - ais_context->bits),
+                         data, len);
+        out += i / 4 * 3;
+    }
+
+    /* bulk stage: four characters are exactly 24 bits */
+    for (; i + 4 <= len; i += 4) {
+        unsigned int a = aivdm_armor[data[i]];
+        unsigned int b = aivdm_armor[data[i + 1]];
+        unsigned int c = aivdm_armor[data[i + 2]];
+        unsigned int d = aivdm_armor[data[i + 3]];
+
+        if (((a | b | c | d) & ~0x3fU) != 0)
+            return false;
+        acc = (acc << 24) | (a << 18) | (b << 12) | (c << 6) | d;
+        out[0] = (unsigned char)(acc >> (nacc + 16));
+        out[1] = (unsigned char)(acc >> (nacc + 8));
+        out[2] = (unsigned char)(acc >> nacc);
+        out += 3;
+        acc &= (1U << nacc) - 1;
+    }
+
+    /* up to three trailing characters */
+    for (; i < len; i++) {
+        unsigned int v = aivdm_armor[data[i]];
+
+        if ((v & ~0x3fU) != 0)
+            return false;
+        acc = (acc << 6) | v;
+        nacc += 6;
+        if (nacc >= CHAR_BIT) {
+            nacc -= CHAR_BIT;
+            *out++ = (unsigned char)(acc >> nacc);
+            acc &= (1U << nacc) - 1;
+        }
+    }
+    /* whole-byte store of the partial tail, zero-filled */
+    if (nacc != 0)
+        *out = (unsigned char)(acc << (CHAR_BIT - nacc));
+
+    ais_context->bitlen = bitlen + 6 * len;
+    return true;
+}
+
+/* a field of a sentence, as a span of the caller's buffer */
+struct aivdm_field_t {
+    const char *ptr;
+    size_t len;
+};
+
+#define AIVDM_FIELDS	7	/* fields up to and including the fill bits */
+
+/* a sentence split into fields, pointing into the caller's buffer */
+struct aivdm_sentence_t {
+    struct aivdm_field_t field[AIVDM_FIELDS];
+    int nfields;
+    size_t len;			/* characters before the terminator */
+    unsigned char sum;		/* XOR of the characters between '!' and '*' */
+    const char *star;		/* the '*' before the checksum, or NULL */
+};
+
+/* characters the tokenizer must look at: ',' '*' and the terminators */
+static const bool aivdm_special[256] = {
+    [','] = true, ['*'] = true, ['\0'] = true, ['\r'] = true, ['\n'] = true,
+};
+
+static void aivdm_tokenize(const char *buf, size_t buflen,
+                           struct aivdm_sentence_t *sentence)
+/* split a sentence into fields and checksum it in one pass, without copying */
+{
+    struct aivdm_field_t *field = sentence->field;
+    const char *cp, *end = buf + buflen;
+    const char *star = NULL;
+    unsigned char sum = 0, starsum = 0;
+    int nfields = 1;
+
+    /*
+     * The sentence ends at buflen or at the first NUL, CR or LF,
+     * whichever comes first, so the input need not be NUL-terminated.
+     * Only the first AIVDM_FIELDS fields are recorded; the last of
+     * them stops at the next comma, as field splitting always did.
+     */
+    field[0].ptr = buf;
+    for (cp = buf; cp < end; cp++) {
+        char c = *cp;
+
+        /* one test keeps ordinary characters off the slow path */
+        if (!aivdm_special[(unsigned char)c]) {
+            sum ^= (unsigned char)c;
+            continue;
+        }
+        if (c == ',') {
+            if (nfields <= AIVDM_FIELDS)
+                field[nfields - 1].len = (size_t)(cp - field[nfields - 1].ptr);
+            if (nfields < AIVDM_FIELDS)
+                field[nfields].ptr = cp + 1;
+            nfields++;
+        } else if (c == '*') {
+            if (star == NULL) {
+                star = cp;
+                starsum = sum;
+            }
+        } else if (c == '\0' || c == '\r' || c == '\n')
+            break;
+        sum ^= (unsigned char)c;
+    }
+    if (nfields <= AIVDM_FIELDS)
+        field[nfields - 1].len = (size_t)(cp - field[nfields - 1].ptr);
+    sentence->nfields = nfields;
+    sentence->len = (size_t)(cp - buf);
+    sentence->star = star;
+    /* the leading '!' (or '$') is not part of the checksum */
+    sentence->sum = starsum ^ (unsigned char)buf[0];
+}
+
+static int aivdm_hexdigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+static bool aivdm_checksum_ok(const struct aivdm_sentence_t *sentence)
+/* does the *hh trailer match the sum taken while tokenizing? */
+{
+    const char *star = sentence->star;
+    int hi, lo;
+
+    if (star == NULL || star + 2 >= sentence->field[0].ptr + sentence->len)
+        return false;
+    hi = aivdm_hexdigit(star[1]);
+    lo = aivdm_hexdigit(star[2]);
+    return hi >= 0 && lo >= 0 && (unsigned char)((hi << 4) | lo) == sentence->sum;
+}
+
+#define AIVDM_ATOI_MAX	9999	/* far above any part count or sequence ID */
+
+static int aivdm_atoi(const struct aivdm_field_t *field)
+/*
+ * value of a small decimal field; like atoi(), stops at the first
+ * non-digit, but gives -1 for a value above AIVDM_ATOI_MAX, so that a
+ * long run of digits can neither overflow nor pass for a valid count
+ */
+{
+    size_t i;
+    int n = 0;
+
+    for (i = 0; i < field->len && isdigit((unsigned char)field->ptr[i]); i++)
+        if ((n = n * 10 + (field->ptr[i] - '0')) > AIVDM_ATOI_MAX)
+            return -1;
+    return n;
+}
+
+static bool aivdm_filter_admits(const struct aivdm_filter_t *filter,
+                                unsigned int type, unsigned int mmsi)
+/* does a message with this header pass the prefilter? */
+{
+    if (filter->types != 0
+        && (type >= CHAR_BIT * sizeof(filter->types)
+            || (filter->types & (1UL << type)) == 0))
+        return false;
+    if (filter->mmsi != NULL && !ais_mmsi_set_contains(filter->mmsi, mmsi))
+        return false;
+    return true;
+}
+
+static bool aivdm_prefilter(const struct aivdm_filter_t *filter,
+                            const struct aivdm_field_t *payload)
+/*
+ * Apply the prefilter to the header in the first seven characters of a
+ * payload.  A payload too short or too broken to hold one is passed on,
+ * to be filtered after decoding or rejected by the dearmoring.
+ */
+{
+    unsigned int v[7];
     int i;
-    
+
+    if (filter->types == 0 && filter->mmsi == NULL)
+        return true;
+    if (payload->len < NITEMS(v))
+        return true;
+    for (i = 0; i < NITEMS(v); i++)
+        if ((v[i] = aivdm_armor[(unsigned char)payload->ptr[i]])
+            == AIVDM_ARMOR_INVALID)
+            return true;
+    /* type in bits 0-5, repeat in 6-7, MMSI in 8-37 */
+    return aivdm_filter_admits(filter, v[0],
+                               (v[1] & 0x0f) << 26 | v[2] << 20 | v[3] << 14
+                               | v[4] << 8 | v[5] << 2 | v[6] >> 4);
+}
+
+static struct aivdm_context_t *aivdm_partial(struct gps_device_t *session,
+                                             char channel, int seqid,
+                                             int nfrags, int ifrag)
+/* find the reassembly slot for a fragment, claiming one for a first part */
+{
+    struct aivdm_stats_t *stats = &session->driver.aivdm.stats;
+    struct aivdm_context_t *match = NULL, *idle = NULL, *oldest = NULL;
+    int i;
+
+    /* expire stale partials while looking for this sequence */
+    for (i = 0; i < AIVDM_PARTIALS; i++) {
+        struct aivdm_context_t *slot = &session->driver.aivdm.partial[i];
+
+        if (slot->channel != '\0'
+            && stats->sentences - slot->stamp > AIVDM_PARTIAL_TIMEOUT) {
+            slot->channel = '\0';
+            stats->partials_expired++;
+        }
+        if (slot->channel == '\0') {
+            if (idle == NULL)
+                idle = slot;
+        } else if (slot->channel == channel && slot->seqid == seqid
+                   && slot->nfrags == nfrags)
+            match = slot;
+        else if (oldest == NULL || slot->stamp < oldest->stamp)
+            oldest = slot;
+    }
+
+    if (ifrag != 1) {
+        /* later parts must extend a sequence in order */
+        if (match == NULL || ifrag != match->decoded_frags + 1) {
+//            gpsd_report(&session->context->errout, LOG_ERROR,
+//                        "invalid fragment #%d received.\n", ifrag);
+            return NULL;
+        }
+        return match;
+    }
+
+    /*
+     * A first part restarts its own sequence if one is pending;
+     * otherwise it takes a free slot, or the least recently extended one.
+     */
+    if (match != NULL)
+        stats->partials_dropped++;
+    else if (idle != NULL)
+        match = idle;
+    else {
+        match = oldest;
+        stats->partials_dropped++;
+    }
+    match->channel = channel;
+    match->seqid = seqid;
+    match->nfrags = nfrags;
+    match->decoded_frags = 0;
+    return match;
+}
+
+static bool aivdm_accept(const char *buf, size_t buflen,
+                         struct gps_device_t *session,
+                         struct aivdm_sentence_t *sentence,
+                         bool *checksum_bad, int *channel,
+                         enum aivdm_status_t *status)
+/*
+ * The checks every sentence goes through before its payload is used:
+ * tokenize it, vet its shape, checksum and channel.  On failure the
+ * reason is left in status.
+ */
+{
+    const struct aivdm_field_t *field = sentence->field;
+
+#define AIVDM_REJECT(why)	do { *status = (why); return false; } while (0)
+    *checksum_bad = false;
     if (buflen == 0)
-        return false;
+        AIVDM_REJECT(aivdm_empty);
+    session->driver.aivdm.stats.sentences++;
     
     /* we may need to dump the raw packet */
 //    gpsd_report(&session->context->errout, LOG_PROG,
 //                "AIVDM packet length %zd: %s\n", buflen, buf);
     
-    /* first clear the result, making sure we don't return garbage */
-    memset(ais, 0, sizeof(*ais));
-    
+    /* extract packet fields */
+    aivdm_tokenize(buf, buflen, sentence);
+
     /* discard overlong sentences */
-    if (strlen(buf) > sizeof(fieldcopy)-1) {
+    if (sentence->len > NMEA_MAX*2) {
 //        gpsd_report(&session->context->errout, LOG_ERROR, "overlong AIVDM packet.\n");
-        return false;
+        AIVDM_REJECT(aivdm_malformed);
     }
-    
-    /* extract packet fields */
-    (void)strlcpy((char *)fieldcopy, buf, sizeof(fieldcopy));
-    field[nfields++] = (unsigned char *)buf;
-    for (cp = fieldcopy;
-         cp < fieldcopy + buflen; cp++)
-        if (*cp == (unsigned char)',') {
-            *cp = '\0';
-            field[nfields++] = cp + 1;
-        }
-
 
     /* discard sentences with exiguous commas; catches run-ons */
-    if (nfields < 7) {
+    if (sentence->nfields < AIVDM_FIELDS) {
 //        gpsd_report(&session->context->errout, LOG_ERROR, "malformed AIVDM packet.\n");
-        return false;
+        AIVDM_REJECT(aivdm_malformed);
+    }
+
+    /* the checksum was taken while tokenizing; only the compare is left */
+    if (session->driver.aivdm.checksum != checksum_ignore
+        && !aivdm_checksum_ok(sentence)) {
+        session->driver.aivdm.stats.checksum_errors++;
+//        gpsd_report(&session->context->errout, LOG_WARN,
+//                    "AIVDM checksum mismatch.\n");
+        if (session->driver.aivdm.checksum == checksum_reject)
+            AIVDM_REJECT(aivdm_bad_checksum);
+        *checksum_bad = true;
     }
     
-    switch (field[4][0]) {
+    switch (field[4].len != 0 ? field[4].ptr[0] : '\0') {
         case '\0':
             /*
              * Apparently an empty channel is normal for AIVDO sentences,
              * which makes sense as they don't come in over radio.  This
              * is going to break if there's ever an AIVDO type 24, though.
              */
-            if (strncmp((const char *)field[0], "!AIVDO", 6) != 0) {
+            if (field[0].len < 6 || strncmp(field[0].ptr, "!AIVDO", 6) != 0) {
 //                gpsd_report(&session->context->errout, LOG_INF,
 //                            "invalid empty AIS channel. Assuming 'A'\n");
             }
-            ais_context = &session->driver.aivdm.context[0];
+            *channel = 0;
             session->driver.aivdm.ais_channel ='A';
             break;
         case '1':
-            if (strcmp((char *)field[4], (char *)"12") == 0) {
+            if (field[4].len == 2 && field[4].ptr[1] == '2') {
 //                gpsd_report(&session->context->errout, LOG_INF,
 //                            "ignoring bogus AIS channel '12'.\n");
-                return false;
+                session->driver.aivdm.stats.bad_channel++;
+                AIVDM_REJECT(aivdm_bad_channel);
             }
             /*@fallthrough@*/
         case 'A':
-            ais_context = &session->driver.aivdm.context[0];
+            *channel = 0;
             session->driver.aivdm.ais_channel ='A';
             break;
         case '2':
             /*@fallthrough@*/
         case 'B':
-            ais_context = &session->driver.aivdm.context[1];
+            *channel = 1;
             session->driver.aivdm.ais_channel ='B';
             break;
         case 'C':
 //            gpsd_report(&session->context->errout, LOG_INF,
 //                        "ignoring AIS channel C (secure AIS).\n");
-            return false;
+            session->driver.aivdm.stats.bad_channel++;
+            AIVDM_REJECT(aivdm_bad_channel);
         default:
 //            gpsd_report(&session->context->errout, LOG_ERROR,
-//                        "invalid AIS channel 0x%0X .\n", field[4][0]);
-            return false;
+//                        "invalid AIS channel 0x%0X .\n", field[4].ptr[0]);
+            session->driver.aivdm.stats.bad_channel++;
+            AIVDM_REJECT(aivdm_bad_channel);
     }
+#undef AIVDM_REJECT
+    return true;
+}
+
+/*@ -fixedformalarray -usedef -branchstate @*/
+enum aivdm_status_t aivdm_decode_status(const char *buf, size_t buflen,
+                                        struct gps_device_t *session,
+                                        struct ais_t *ais)
+{
+#ifdef __UNUSED_DEBUG__
+    char *sixbits[64] = {
+        "000000", "000001", "000010", "000011", "000100",
+        "000101", "000110", "000111", "001000", "001001",
+        "001010", "001011", "001100", "001101", "001110",
+        "001111", "010000", "010001", "010010", "010011",
+        "010100", "010101", "010110", "010111", "011000",
+        "011001", "011010", "011011", "011100", "011101",
+        "011110", "011111", "100000", "100001", "100010",
+        "100011", "100100", "100101", "100110", "100111",
+        "101000", "101001", "101010", "101011", "101100",
+        "101101", "101110", "101111", "110000", "110001",
+        "110010", "110011", "110100", "110101", "110110",
+        "110111", "111000", "111001", "111010", "111011",
+        "111100", "111101", "111110", "111111",
+    };
+#endif /* __UNUSED_DEBUG__ */
+    int nfrags, ifrag, seqid, channel;
+    struct aivdm_sentence_t sentence;
+    const struct aivdm_field_t *field = sentence.field;
+    enum aivdm_status_t status;
+    bool checksum_bad;
+    unsigned char pad;
+    //struct aivdm_context_t *ais_context = malloc(sizeof *ais_context);
+    struct aivdm_context_t *ais_context;
+    
+    if (!aivdm_accept(buf, buflen, session, &sentence,
+                      &checksum_bad, &channel, &status))
+        return status;
     
-    nfrags = atoi((char *)field[1]); /* number of fragments to expect */
-    ifrag = atoi((char *)field[2]); /* fragment id */
-    data = field[5];
-    pad = field[6][0]; /* number of padding bits */
+    nfrags = aivdm_atoi(&field[1]); /* number of fragments to expect */
+    ifrag = aivdm_atoi(&field[2]); /* fragment id */
+    seqid = field[3].len != 0 ? aivdm_atoi(&field[3]) : -1; /* sequential message ID */
+    pad = field[6].len != 0 ? field[6].ptr[0] : '\0'; /* number of padding bits */
 //    gpsd_report(&session->context->errout, LOG_PROG,
-//                "nfrags=%d, ifrag=%d, decoded_frags=%d, data=%s\n",
-//                nfrags, ifrag, ais_context->decoded_frags, data);
+//                "nfrags=%d, ifrag=%d, seqid=%d, data=%.*s\n",
+//                nfrags, ifrag, seqid, (int)field[5].len, field[5].ptr);
     
     /* assemble the binary data */
-    
-
-    /* check fragment ordering */
-    if (ifrag != ais_context->decoded_frags + 1) {
-//        gpsd_report(&session->context->errout, LOG_ERROR,
-//                    "invalid fragment #%d received, expected #%d.\n",
-//                    ifrag, ais_context->decoded_frags + 1);
-        if (ifrag != 1)
-            return false;
-        /* else, ifrag==1: Just discard all that was previously decoded and
-         * simply handle that packet */
-        ais_context->decoded_frags = 0;
+    if (nfrags < 1 || ifrag < 1 || ifrag > nfrags
+        || (field[3].len != 0 && seqid < 0))
+        return aivdm_malformed;
+    if (nfrags == 1)
+        ais_context = &session->driver.aivdm.single;
+    else {
+        ais_context = aivdm_partial(session,
+                                    session->driver.aivdm.ais_channel,
+                                    seqid, nfrags, ifrag);
+        if (ais_context == NULL)
+            return aivdm_orphan;
     }
 
-
+    /*
+     * No need to clear the bit buffer here: aivdm_dearmor() stores whole
+     * bytes and zero-fills the partial last one, and the decoders never
+     * look past BITS_TO_BYTES(bitlen).
+     */
     if (ifrag == 1) {
-        (void)memset(ais_context->bits, '\0', sizeof(ais_context->bits));
         ais_context->bitlen = 0;
+        ais_context->checksum_bad = false;
+        ais_context->filtered =
+            !aivdm_prefilter(&session->driver.aivdm.filter, &field[5]);
     }
+    ais_context->checksum_bad |= checksum_bad;
+
+    /* a message failing the prefilter is followed only to its end */
+    if (ais_context->filtered) {
+        session->driver.aivdm.stats.filter_skipped++;
+        if (ifrag == nfrags) {
+            ais_context->decoded_frags = 0;
+            ais_context->channel = '\0';
+        } else {
+            ais_context->decoded_frags++;
+            ais_context->stamp = session->driver.aivdm.stats.sentences;
+        }
+        return aivdm_filtered;
+    }
+    session->driver.aivdm.stats.filter_matched++;
     
     /* wacky 6-bit encoding, shades of FIELDATA */
+    if (!aivdm_dearmor(ais_context,
+                       (const unsigned char *)field[5].ptr, field[5].len)) {
+//        gpsd_report(&session->context->errout, LOG_ERROR,
+//                    "invalid AIVDM payload.\n");
+        if (nfrags > 1) {
+            /* the rest of the sequence can't be used either */
+            ais_context->channel = '\0';
+            session->driver.aivdm.stats.partials_dropped++;
+        }
+        return aivdm_bad_payload;
+    }
     /*@ +charint @*/
-    for (cp = data; cp < data + strlen((char *)data); cp++) {
-        unsigned char ch;
-        ch = *cp;
-        ch -= 48;
-        if (ch >= 40)
-            ch -= 8;
-//#ifdef __UNUSED_DEBUG__
-//        gpsd_report(&session->context->errout, LOG_RAW,
-//                    "%c: %s\n", *cp, sixbits[ch]);
-//#endif /* __UNUSED_DEBUG__ */
-        /*@ -shiftnegative @*/
-        for (i = 5; i >= 0; i--) {
-            if ((ch >> i) & 0x01) {
-                ais_context->bits[ais_context->bitlen / 8] |=
-                (1 << (7 - ais_context->bitlen % 8));
-            }
-            ais_context->bitlen++;
-            if (ais_context->bitlen > sizeof(ais_context->bits)) {
-//                gpsd_report(&session->context->errout, LOG_INF,
-//                            "overlong AIVDM payload truncated.\n");
-                return false;
+    if (isdigit(pad)) {
+        /* more padding than payload would wrap bitlen */
+        if ((size_t)(pad - '0') > ais_context->bitlen) {
+            if (nfrags > 1) {
+                ais_context->channel = '\0';
+                session->driver.aivdm.stats.partials_dropped++;
             }
+            return aivdm_bad_payload;
         }
-        /*@ +shiftnegative @*/
-    }
-    if (isdigit(pad))
         ais_context->bitlen -= (pad - '0');	/* ASCII assumption */
+    }
     /*@ -charint @*/
     
     /* time to pass buffered-up data to where it's actually processed? */
@@ -233,20 +707,484 @@ bool aivdm_decode(const char *buf, size_t buflen,
 //                                     (char *)ais_context->bits, clen));
 //        }
         
-        /* clear waiting fragments count */
+        /* clear waiting fragments count, freeing a reassembly slot */
         ais_context->decoded_frags = 0;
+        ais_context->channel = '\0';
+        session->driver.aivdm.ais_checksum_bad = ais_context->checksum_bad;
         
         /* decode the assembled binary packet */
         
         struct gpsd_errout_t errout;
-        return ais_binary_decode(&errout,
-                                 ais,
-                                 ais_context->bits,
-                                 ais_context->bitlen,
-                                 &ais_context->type24_queue);
+        if (!ais_binary_decode_fields(&errout,
+                                      ais,
+                                      ais_context->bits,
+                                      ais_context->bitlen,
+                                      &session->driver.aivdm.type24_queue[channel],
+                                      AIS_FIELDS_ALL & ~session->driver.aivdm.skip_fields))
+            return aivdm_undecodable;
+        /* in case the first part was too short to prefilter */
+        if (!aivdm_filter_admits(&session->driver.aivdm.filter,
+                                 ais->type, ais->mmsi)) {
+            /* every part was counted as matched on the way here */
+            session->driver.aivdm.stats.filter_matched -= (unsigned long)nfrags;
+            session->driver.aivdm.stats.filter_skipped += (unsigned long)nfrags;
+            return aivdm_filtered;
+        }
+        session->driver.aivdm.stats.decoded++;
+        session->driver.aivdm.stats.types[ais->type % AIVDM_TYPES]++;
+        return aivdm_decoded;
     }
     
     /* we're still waiting on another sentence */
     ais_context->decoded_frags++;
-    return false;
+    ais_context->stamp = session->driver.aivdm.stats.sentences;
+    return aivdm_pending;
+}
+
+bool aivdm_decode(const char *buf, size_t buflen,
+                  struct gps_device_t *session,
+                  struct ais_t *ais,
+                  int debug)
+{
+    return aivdm_decode_status(buf, buflen, session, ais) == aivdm_decoded;
+}
+
+unsigned int aivdm_pending_fragments(const struct gps_device_t *session)
+/* fragments held for multipart messages not yet complete nor expired */
+{
+    const struct aivdm_stats_t *stats = &session->driver.aivdm.stats;
+    unsigned int pending = 0;
+    int i;
+
+    for (i = 0; i < AIVDM_PARTIALS; i++) {
+        const struct aivdm_context_t *slot = &session->driver.aivdm.partial[i];
+
+        if (slot->channel != '\0'
+            && stats->sentences - slot->stamp <= AIVDM_PARTIAL_TIMEOUT)
+            pending += (unsigned int)slot->decoded_frags;
+    }
+    return pending;
+}
+
+static bool aivdm_batch_line(struct gps_device_t *session,
+                             struct aivdm_batch_t *batch,
+                             const char *line, size_t len)
+/* feed one line to the decoder, recording the outcome; false when full */
+{
+    enum aivdm_status_t status;
+
+    if (batch->nlines >= batch->maxlines || batch->nais >= batch->maxais)
+        return false;
+    if (len > 0 && line[len - 1] == '\r')
+        len--;
+    status = aivdm_decode_status(line, len, session, &batch->ais[batch->nais]);
+    if (status == aivdm_decoded) {
+        if (batch->line != NULL)
+            batch->line[batch->nais] = batch->nlines;
+        if (batch->checksum_bad != NULL)
+            batch->checksum_bad[batch->nais] =
+                session->driver.aivdm.ais_checksum_bad;
+        batch->nais++;
+    }
+    if (batch->status != NULL)
+        batch->status[batch->nlines] = status;
+    batch->nlines++;
+    return true;
+}
+
+size_t aivdm_decode_batch(const char *buf, size_t buflen,
+                          struct gps_device_t *session,
+                          struct aivdm_batch_t *batch)
+{
+    const char *p = buf, *end = buf + buflen;
+
+    batch->nlines = batch->nais = 0;
+    while (p < end) {
+        const char *nl = memchr(p, '\n', (size_t)(end - p));
+
+        if (nl == NULL) {
+            /* an unterminated tail waits for more data unless told not to */
+            if (batch->flush && aivdm_batch_line(session, batch,
+                                                 p, (size_t)(end - p)))
+                p = end;
+            break;
+        }
+        if (!aivdm_batch_line(session, batch, p, (size_t)(nl - p)))
+            break;
+        p = nl + 1;
+    }
+    return (size_t)(p - buf);
+}
+
+size_t aivdm_decode_spans(const struct aivdm_span_t *span, size_t nspans,
+                          struct gps_device_t *session,
+                          struct aivdm_batch_t *batch)
+{
+    size_t i;
+
+    batch->nlines = batch->nais = 0;
+    for (i = 0; i < nspans; i++)
+        if (!aivdm_batch_line(session, batch, span[i].ptr, span[i].len))
+            break;
+    return i;
+}
+
+/*
+ * Columnar decoding of position reports.  These always fit in one
+ * sentence, so a sentence is dropped as soon as its fragment count or
+ * the type in its first payload character rules it out; the ones left
+ * are de-armored and their few fields read straight into the columns.
+ */
+static void aivdm_set_valid(/*@null@*/unsigned char *bitmap, size_t row,
+                            bool valid)
+{
+    unsigned char mask = (unsigned char)(1U << (row % CHAR_BIT));
+
+    if (bitmap != NULL)
+        bitmap[row / CHAR_BIT] = (unsigned char)
+            ((bitmap[row / CHAR_BIT] & ~mask) | (valid ? mask : 0));
+}
+
+static bool aivdm_position_row(struct aivdm_positions_t *pos,
+                               const unsigned char *bits, size_t bitlen)
+/* append one report to the columns; false if it is too short */
+{
+    size_t buflen = BITS_TO_BYTES(bitlen);
+    size_t row = pos->nrows;
+    unsigned int type = (unsigned int)ubits_be(bits, buflen, 0, 6);
+    unsigned int speed, course, heading = 511, second = 60;
+    int lon, lat;
+    double div;
+    bool longrange = (type == 27);
+
+#define UBITS(s, l)	(unsigned int)ubits_be(bits, buflen, s, l)
+#define SBITS(s, l)	(int)sbits_be(bits, buflen, s, l)
+    /* the same length rules as ais_binary_decode() */
+    switch (type) {
+    case 1:
+    case 2:
+    case 3:
+        if (bitlen < 168)
+            return false;
+        speed = UBITS(50, 10);
+        lon = SBITS(61, 28);
+        lat = SBITS(89, 27);
+        course = UBITS(116, 12);
+        heading = UBITS(128, 9);
+        second = UBITS(137, 6);
+        div = AIS_LATLON_DIV;
+        break;
+    case 18:
+    case 19:
+        if (bitlen < (type == 18 ? 168U : 312U))
+            return false;
+        speed = UBITS(46, 10);
+        lon = SBITS(57, 28);
+        lat = SBITS(85, 27);
+        course = UBITS(112, 12);
+        heading = UBITS(124, 9);
+        second = UBITS(133, 6);
+        div = AIS_LATLON_DIV;
+        break;
+    case 27:
+        if (bitlen != 96 && bitlen != 168)
+            return false;
+        lon = SBITS(44, 18);
+        lat = SBITS(62, 17);
+        speed = UBITS(79, 6);
+        course = UBITS(85, 9);
+        div = AIS_LONGRANGE_LATLON_DIV;
+        break;
+    default:
+        return false;
+    }
+#undef UBITS
+#undef SBITS
+
+    if (pos->type != NULL)
+        pos->type[row] = (unsigned char)type;
+    if (pos->mmsi != NULL)
+        pos->mmsi[row] = (unsigned int)ubits_be(bits, buflen, 8, 30);
+    if (pos->second != NULL)
+        pos->second[row] = (unsigned char)second;
+    aivdm_set_valid(pos->second_valid, row, second < 60);
+    if (pos->heading != NULL)
+        pos->heading[row] = (unsigned short)heading;
+    aivdm_set_valid(pos->heading_valid, row, heading < 360);
+
+    /* out-of-range values, the not-available ones included, become NaN */
+    if (pos->lon != NULL)
+        pos->lon[row] = abs(lon) <= 180 * div ? lon / div : NAN;
+    aivdm_set_valid(pos->lon_valid, row, abs(lon) <= 180 * div);
+    if (pos->lat != NULL)
+        pos->lat[row] = abs(lat) <= 90 * div ? lat / div : NAN;
+    aivdm_set_valid(pos->lat_valid, row, abs(lat) <= 90 * div);
+    if (longrange) {
+        /* type 27 has whole knots and degrees */
+        if (pos->sog != NULL)
+            pos->sog[row] = speed < 63 ? (float)speed : NAN;
+        aivdm_set_valid(pos->sog_valid, row, speed < 63);
+        if (pos->cog != NULL)
+            pos->cog[row] = course < 360 ? (float)course : NAN;
+        aivdm_set_valid(pos->cog_valid, row, course < 360);
+    } else {
+        if (pos->sog != NULL)
+            pos->sog[row] = speed < 1023 ? speed / 10.0f : NAN;
+        aivdm_set_valid(pos->sog_valid, row, speed < 1023);
+        if (pos->cog != NULL)
+            pos->cog[row] = course < 3600 ? course / 10.0f : NAN;
+        aivdm_set_valid(pos->cog_valid, row, course < 3600);
+    }
+    if (pos->line != NULL)
+        pos->line[row] = pos->nlines;
+    pos->nrows++;
+    return true;
+}
+
+static bool aivdm_position_line(struct gps_device_t *session,
+                                struct aivdm_positions_t *pos,
+                                const char *line, size_t len)
+/* feed one line to the position decoder; false when the columns are full */
+{
+    struct aivdm_context_t *ais_context = &session->driver.aivdm.single;
+    struct aivdm_sentence_t sentence;
+    const struct aivdm_field_t *field = sentence.field;
+    enum aivdm_status_t status;
+    bool checksum_bad;
+    int channel;
+    unsigned char pad, type;
+
+    if (pos->nrows >= pos->maxrows)
+        return false;
+    if (len > 0 && line[len - 1] == '\r')
+        len--;
+    if (aivdm_accept(line, len, session, &sentence,
+                     &checksum_bad, &channel, &status)
+        && aivdm_atoi(&field[1]) == 1 && aivdm_atoi(&field[2]) == 1
+        && field[5].len != 0) {
+        if (!aivdm_prefilter(&session->driver.aivdm.filter, &field[5])) {
+            session->driver.aivdm.stats.filter_skipped++;
+            pos->nlines++;
+            return true;
+        }
+        session->driver.aivdm.stats.filter_matched++;
+        switch (type = aivdm_armor[(unsigned char)field[5].ptr[0]]) {
+        case 1:
+        case 2:
+        case 3:
+        case 18:
+        case 19:
+        case 27:
+            ais_context->bitlen = 0;
+            if (!aivdm_dearmor(ais_context, (const unsigned char *)field[5].ptr,
+                               field[5].len))
+                break;
+            pad = field[6].len != 0 ? field[6].ptr[0] : '\0';
+            if (isdigit(pad)) {
+                if ((size_t)(pad - '0') > ais_context->bitlen)
+                    break;
+                ais_context->bitlen -= (pad - '0');
+            }
+            if (aivdm_position_row(pos, ais_context->bits,
+                                   ais_context->bitlen)) {
+                aivdm_set_valid(pos->checksum_bad, pos->nrows - 1,
+                                checksum_bad);
+                session->driver.aivdm.stats.decoded++;
+                session->driver.aivdm.stats.types[type]++;
+            }
+            break;
+        }
+    }
+    pos->nlines++;
+    return true;
+}
+
+size_t aivdm_decode_positions(const char *buf, size_t buflen,
+                              struct gps_device_t *session,
+                              struct aivdm_positions_t *pos)
+{
+    const char *p = buf, *end = buf + buflen;
+
+    pos->nlines = pos->nrows = 0;
+    while (p < end) {
+        const char *nl = memchr(p, '\n', (size_t)(end - p));
+
+        if (nl == NULL) {
+            if (pos->flush && aivdm_position_line(session, pos,
+                                                  p, (size_t)(end - p)))
+                p = end;
+            break;
+        }
+        if (!aivdm_position_line(session, pos, p, (size_t)(nl - p)))
+            break;
+        p = nl + 1;
+    }
+    return (size_t)(p - buf);
+}
+
+size_t aivdm_decode_position_spans(const struct aivdm_span_t *span,
+                                   size_t nspans,
+                                   struct gps_device_t *session,
+                                   struct aivdm_positions_t *pos)
+{
+    size_t i;
+
+    pos->nlines = pos->nrows = 0;
+    for (i = 0; i < nspans; i++)
+        if (!aivdm_position_line(session, pos, span[i].ptr, span[i].len))
+            break;
+    return i;
+}
+
+/*
+ * Parallel batch decoding.  Reassembly state only ever spans sentences
+ * from one receiver on one channel, so those streams can be decoded
+ * independently: each (stream, channel) shard gets its own session and
+ * is owned by exactly one worker, which sees the shard's sentences in
+ * input order.  Workers decode line i into ais[i]; the results are then
+ * packed down in input order.
+ */
+struct aivdm_worker_t {
+    const struct aivdm_span_t *span;
+    const unsigned int *shard;
+    enum aivdm_status_t *status;
+    bool *checksum_bad;
+    struct ais_t *ais;
+    size_t nspans;
+    struct gps_device_t *sessions;
+    unsigned int index, nworkers;
+};
+
+static int aivdm_channel_index(const struct aivdm_span_t *span)
+/* peek at the channel field; anything unusual is left to shard 0 */
+{
+    const char *p = span->ptr, *end = span->ptr + span->len;
+    int commas = 0;
+
+    for (; p < end && *p != '\0'; p++)
+        if (*p == ',' && ++commas == 4)
+            return (p + 1 < end && (p[1] == 'B' || p[1] == '2')) ? 1 : 0;
+    return 0;
+}
+
+static unsigned int aivdm_shard(const struct aivdm_span_t *span,
+                                /*@null@*/const unsigned int *stream,
+                                size_t nstreams, size_t i)
+{
+    unsigned int receiver = stream != NULL ? stream[i] % nstreams : 0;
+
+    return receiver * AIVDM_CHANNELS + aivdm_channel_index(&span[i]);
+}
+
+static void *aivdm_worker(void *arg)
+{
+    struct aivdm_worker_t *w = (struct aivdm_worker_t *)arg;
+    size_t i;
+
+    for (i = 0; i < w->nspans; i++) {
+        unsigned int shard = w->shard[i];
+        const struct aivdm_span_t *span = &w->span[i];
+        size_t len = span->len;
+
+        if (shard % w->nworkers != w->index)
+            continue;
+        if (len > 0 && span->ptr[len - 1] == '\r')
+            len--;
+        w->status[i] = aivdm_decode_status(span->ptr, len,
+                                           &w->sessions[shard], &w->ais[i]);
+        w->checksum_bad[i] = w->sessions[shard].driver.aivdm.ais_checksum_bad;
+    }
+    return NULL;
+}
+
+size_t aivdm_decode_parallel(const struct aivdm_span_t *span,
+                             /*@null@*/const unsigned int *stream,
+                             size_t nspans,
+                             struct gps_device_t *sessions, size_t nstreams,
+                             int nthreads,
+                             struct aivdm_batch_t *batch)
+{
+    struct aivdm_worker_t worker[AIVDM_MAX_THREADS];
+    pthread_t tid[AIVDM_MAX_THREADS];
+    bool started[AIVDM_MAX_THREADS];
+    enum aivdm_status_t *status;
+    bool *checksum_bad;
+    unsigned int *shard;
+    size_t i, nshards = nstreams * AIVDM_CHANNELS;
+    int t;
+
+    batch->nlines = batch->nais = 0;
+    /* every line may decode, and is decoded in place, so bound by both */
+    if (nstreams == 0)
+        return 0;
+    if (nthreads > AIVDM_MAX_THREADS)
+        nthreads = AIVDM_MAX_THREADS;
+    if ((size_t)nthreads > nshards)
+        nthreads = (int)nshards;
+    if (nthreads <= 1) {
+        /* no workers, so no need to decode in place and pack later */
+        for (i = 0; i < nspans; i++)
+            if (!aivdm_batch_line(&sessions[aivdm_shard(span, stream,
+                                                        nstreams, i)],
+                                  batch, span[i].ptr, span[i].len))
+                break;
+        return i;
+    }
+    if (nspans > batch->maxlines)
+        nspans = batch->maxlines;
+    if (nspans > batch->maxais)
+        nspans = batch->maxais;
+    if (nspans == 0)
+        return 0;
+
+    shard = malloc(nspans * (sizeof(*shard) + sizeof(*status)
+                             + sizeof(*checksum_bad)));
+    if (shard == NULL)
+        return 0;
+    status = (enum aivdm_status_t *)(shard + nspans);
+    checksum_bad = (bool *)(status + nspans);
+    for (i = 0; i < nspans; i++)
+        shard[i] = aivdm_shard(span, stream, nstreams, i);
+
+    for (t = 0; t < nthreads; t++) {
+        worker[t].span = span;
+        worker[t].shard = shard;
+        worker[t].status = status;
+        worker[t].checksum_bad = checksum_bad;
+        worker[t].ais = batch->ais;
+        worker[t].nspans = nspans;
+        worker[t].sessions = sessions;
+        worker[t].index = (unsigned int)t;
+        worker[t].nworkers = (unsigned int)nthreads;
+    }
+    /* settle the de-armoring kernel before the workers race to pick it */
+    aivdm_init();
+    /* the calling thread takes worker 0, and any that fail to start */
+    for (t = 1; t < nthreads; t++)
+        started[t] = pthread_create(&tid[t], NULL,
+                                    aivdm_worker, &worker[t]) == 0;
+    (void)aivdm_worker(&worker[0]);
+    for (t = 1; t < nthreads; t++)
+        if (started[t])
+            (void)pthread_join(tid[t], NULL);
+        else
+            (void)aivdm_worker(&worker[t]);
+
+    /* pack the decoded messages down; ais[nais] never lies above ais[i] */
+    for (i = 0; i < nspans; i++) {
+        if (status[i] == aivdm_decoded) {
+            if (batch->nais != i)
+                batch->ais[batch->nais] = batch->ais[i];
+            if (batch->line != NULL)
+                batch->line[batch->nais] = i;
+            if (batch->checksum_bad != NULL)
+                batch->checksum_bad[batch->nais] = checksum_bad[i];
+            batch->nais++;
+        }
+        if (batch->status != NULL)
+            batch->status[i] = status[i];
+    }
+    batch->nlines = nspans;
+    free(shard);
+    return nspans;
 }
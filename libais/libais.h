@@ -18,6 +18,9 @@
 #include "bits.h"
 #include "gpsd.h"
 #include "gps_json.h"
+#include "ais_record.h"
+#include "ais_arrow.h"
+#include "ais_mmsi.h"
 
 //#define JSON_BOOL(x)	((x)?"true":"false")
 #define NITEMS(x) (int)(sizeof(x)/sizeof(x[0]))
@@ -41,15 +44,139 @@
 extern /*@ observer @*/ const char *gpsd_hexdump(/*@out@*/char *, size_t,
                                                  /*@null@*/char *, size_t);
 
+/*
+ * Pick the de-armoring kernel for this CPU.  Done on first use anyway;
+ * callers that will decode on several threads of their own call it
+ * once first.  Safe to call again, from any thread.
+ */
+extern void aivdm_init(void);
+
 extern bool aivdm_decode(const char *buf, size_t buflen,
                          struct gps_device_t *session,
                          struct ais_t *ais,
                          int debug);
 
+extern enum aivdm_status_t aivdm_decode_status(const char *buf, size_t buflen,
+                                               struct gps_device_t *session,
+                                               struct ais_t *ais);
+
+/* sentences of multipart messages held in session, awaiting their rest */
+extern unsigned int aivdm_pending_fragments(const struct gps_device_t *session);
+
+/* one sentence, not necessarily NUL-terminated */
+struct aivdm_span_t {
+    const char *ptr;
+    size_t len;
+};
+
+/*
+ * Output of a batch decode.  Decoded messages are packed into ais[] in
+ * input order; line[i], if wanted, is the input line that completed
+ * ais[i], and checksum_bad[i] whether any of its sentences failed the
+ * checksum under checksum_flag.  status[] gets one entry per line
+ * consumed.  The caller sets the pointers and capacities, the decoder
+ * fills in nais and nlines.
+ */
+struct aivdm_batch_t {
+    struct ais_t *ais;
+    size_t maxais;
+    /*@null@*/size_t *line;		/* parallel to ais[] */
+    /*@null@*/bool *checksum_bad;	/* parallel to ais[] */
+    /*@null@*/enum aivdm_status_t *status;
+    size_t maxlines;		/* capacity of status[], or a line limit */
+    bool flush;			/* decode an unterminated last line too */
+    size_t nais;
+    size_t nlines;
+};
+
+/*
+ * Decode newline-separated sentences until the buffer, ais[] or
+ * status[] runs out.  Returns the number of bytes consumed; an
+ * unterminated tail is left for the next call unless flush is set.
+ */
+extern size_t aivdm_decode_batch(const char *buf, size_t buflen,
+                                 struct gps_device_t *session,
+                                 struct aivdm_batch_t *batch);
+
+/* the same over an array of sentences; returns the number consumed */
+extern size_t aivdm_decode_spans(const struct aivdm_span_t *span, size_t nspans,
+                                 struct gps_device_t *session,
+                                 struct aivdm_batch_t *batch);
+
+/*
+ * Columnar output for position reports (types 1-3, 18, 19 and 27);
+ * every other message is skipped without being decoded.  Each column
+ * is a caller-owned array of maxrows entries, and any of them may be
+ * NULL.  The nullable columns each have a validity bitmap of
+ * (maxrows + 7) / 8 bytes, least significant bit first as in Arrow; a
+ * clear bit means the report gave "not available" or an out-of-range
+ * value.  Such floating-point values are stored as NaN, the others as
+ * received.  checksum_bad is a bitmap of the same layout whose set bits
+ * mark the rows whose sentence failed the checksum under checksum_flag.
+ * AIS carries no date or time of day in these reports, only the UTC
+ * second, so line[] is there to join the caller's own reception times.
+ * Type 27 has neither second nor heading.
+ */
+struct aivdm_positions_t {
+    size_t maxrows;
+    bool flush;			/* decode an unterminated last line too */
+    /*@null@*/size_t *line;		/* input line of each report */
+    /*@null@*/unsigned char *type;
+    /*@null@*/unsigned int *mmsi;
+    /*@null@*/unsigned char *second;	/* UTC second */
+    /*@null@*/double *lat;		/* degrees */
+    /*@null@*/double *lon;		/* degrees */
+    /*@null@*/float *sog;		/* knots */
+    /*@null@*/float *cog;		/* degrees */
+    /*@null@*/unsigned short *heading;	/* degrees */
+    /*@null@*/unsigned char *second_valid;
+    /*@null@*/unsigned char *lat_valid;
+    /*@null@*/unsigned char *lon_valid;
+    /*@null@*/unsigned char *sog_valid;
+    /*@null@*/unsigned char *cog_valid;
+    /*@null@*/unsigned char *heading_valid;
+    /*@null@*/unsigned char *checksum_bad;
+    size_t nrows;
+    size_t nlines;
+};
+
+/* like aivdm_decode_batch() and aivdm_decode_spans(), into columns */
+extern size_t aivdm_decode_positions(const char *buf, size_t buflen,
+                                     struct gps_device_t *session,
+                                     struct aivdm_positions_t *pos);
+extern size_t aivdm_decode_position_spans(const struct aivdm_span_t *span,
+                                          size_t nspans,
+                                          struct gps_device_t *session,
+                                          struct aivdm_positions_t *pos);
+
+/*
+ * Multithreaded aivdm_decode_spans().  stream[i], if given, names the
+ * receiver line i came from, below nstreams.  sessions[] holds
+ * nstreams * AIVDM_CHANNELS decoder states, one per (stream, channel)
+ * shard, carried from call to call; each shard is decoded in order on
+ * one thread, so parallelism is bounded by the number of shards.
+ * With more than one thread, decodes at most maxais lines per call,
+ * since each line is decoded in place before the results are packed.
+ */
+#define AIVDM_MAX_THREADS	64
+extern size_t aivdm_decode_parallel(const struct aivdm_span_t *span,
+                                    /*@null@*/const unsigned int *stream,
+                                    size_t nspans,
+                                    struct gps_device_t *sessions,
+                                    size_t nstreams,
+                                    int nthreads,
+                                    struct aivdm_batch_t *batch);
+
 extern bool ais_binary_decode(const struct gpsd_errout_t *errout,
                               struct ais_t *ais,
                               const unsigned char *, size_t,
                               /*@null@*/struct ais_type24_queue_t *);
+/* the same, decoding only the AIS_FIELDS_* groups in the mask */
+extern bool ais_binary_decode_fields(const struct gpsd_errout_t *errout,
+                                     struct ais_t *ais,
+                                     const unsigned char *, size_t,
+                                     /*@null@*/struct ais_type24_queue_t *,
+                                     unsigned int);
 
 void gpsd_report(const struct gpsd_errout_t *, const int, const char *, ...);
 
@@ -6,27 +6,627 @@
 //  Copyright (c) 2014 Chris Bünger. All rights reserved.
 //
 
+/*
+ * Decode AIVDM logs from the command line.
+ *
+ * usage: libais [-f json|csv|record|arrow] [-u] [-o output] [-t types]
+ *               [-m mmsi-file] [-c ignore|flag|reject] [-q] [file...]
+ *
+ * Files are mapped and decoded in place, and so is standard input when
+ * it is a regular file; otherwise it is read in large blocks.  With no
+ * file, or "-", standard input is read.  Output is one JSON report per
+ * line (the default), CSV, or the binary records of ais_record.h, all
+ * through one large buffer.  Arrow output is the four IPC streams of
+ * ais_arrow.h, one per family, written to output.positions.arrow,
+ * output.static.arrow, output.base.arrow and output.binary.arrow, with
+ * "ais" as the default output; messages of no family are left out.
+ * -t takes a comma-separated list of message types and -m a watchlist
+ * of MMSIs, one per line, for the decoder's prefilter.  Unless -q is
+ * given, throughput is reported on standard error at exit.  -c sets
+ * what is done with a sentence failing its checksum: by default
+ * checksums are not checked, with flag they are counted, and with
+ * reject such sentences are also dropped.
+ */
+
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include "libais.h"
 #include "gps.h"
 
-int main(int argc, const char * argv[]) {
-    // insert code here...
-    printf("Hello, World!\n");
-    
-    struct gps_device_t session;
-    struct ais_t ais;
-    
-    const char msg[] = "!AIVDM,1,1,,B,177KI=011nrFFK1p0wTKII2>06;`,0*04";
-    size_t len = sizeof(msg);
-
-    char buf[JSON_VAL_MAX * 2 + 1];
-    size_t buflen = sizeof(buf);
-    
-    aivdm_decode(msg, len, &session, &ais, 0);
-    printf("type: %d, repeat: %d, mmsi: %d\n", ais.type, ais.repeat, ais.mmsi);
-    json_aivdm_dump(&ais, NULL, true, buf, buflen);
-    printf("JSON: %s", buf);
-
-    return 0;
+#define BATCH_MAX	1024		/* messages decoded per batch */
+#define OUT_BUFSIZE	(4 << 20)	/* output buffer */
+#define OUT_ROW_MAX	GPS_JSON_RESPONSE_MAX	/* room reserved for one row */
+#define READ_BLOCK	(8 << 20)	/* most read from a pipe at once */
+#define MAP_WINDOW	((size_t)64 << 20)	/* mapped bytes decoded at a time */
+
+enum format_t {format_json, format_csv, format_record, format_arrow};
+
+struct output_t {
+    int fd;
+    char *buf;
+    size_t len;
+    bool error;
+};
+
+struct totals_t {
+    unsigned long long bytes;
+    unsigned long long lines;
+    unsigned long long messages;
+    unsigned long long truncated;	/* JSON reports too long for a row */
+};
+
+static struct gps_device_t session;
+static struct ais_t ais[BATCH_MAX];
+static struct output_t out;
+static struct totals_t totals;
+static enum format_t format = format_json;
+static bool scaled = true;
+static struct ais_arrow_t *arrow[AIS_ARROW_FAMILIES];
+static FILE *arrow_fp[AIS_ARROW_FAMILIES];
+
+static const char *arrow_names[AIS_ARROW_FAMILIES] = {
+    [ais_arrow_positions] = "positions",
+    [ais_arrow_static] = "static",
+    [ais_arrow_base] = "base",
+    [ais_arrow_binary] = "binary",
+};
+
+static void out_flush(void)
+{
+    size_t done = 0;
+
+    while (done < out.len && !out.error) {
+	ssize_t n = write(out.fd, out.buf + done, out.len - done);
+
+	if (n < 0 && errno != EINTR) {
+	    perror("libais: write");
+	    out.error = true;
+	} else if (n > 0)
+	    done += (size_t)n;
+    }
+    out.len = 0;
+}
+
+static char *out_reserve(size_t n)
+/* room for n more bytes at the end of the buffer */
+{
+    if (OUT_BUFSIZE - out.len < n)
+	out_flush();
+    return out.buf + out.len;
+}
+
+/*
+ * CSV output.  One row per message, over the columns of the Arrow
+ * position and static families merged: a field the message does not
+ * carry, or gives as "not available", is left empty.  Other messages
+ * yield only their type, repeat and MMSI.  Values are in degrees,
+ * knots and metres.
+ */
+
+static const char csv_header[] =
+    "type,repeat,mmsi,status,speed,lon,lat,course,heading,second,"
+    "imo,callsign,shipname,shiptype,to_bow,to_stern,to_port,to_starboard,"
+    "draught,destination\n";
+
+static char *csv_fixed(char *p, long long val, int prec, bool valid)
+/* val in units of 10^-prec, written without printf; each field ends in ',' */
+{
+    char digits[24];
+    int n = 0;
+    unsigned long long u = (unsigned long long)val;
+
+    if (valid) {
+	if (val < 0) {
+	    *p++ = '-';
+	    u = -u;
+	}
+	do {
+	    digits[n++] = (char)('0' + u % 10);
+	    u /= 10;
+	} while (u != 0 || n <= prec);
+	while (n > 0) {
+	    if (n == prec)
+		*p++ = '.';
+	    *p++ = digits[--n];
+	}
+    }
+    *p++ = ',';
+    return p;
+}
+#define csv_uint(p, val, valid)	csv_fixed(p, (long long)(val), 0, valid)
+#define csv_degrees(p, val, div, valid) \
+	csv_fixed(p, llrint((val) / (div) * 1e6), 6, valid)
+
+static char *csv_text(char *p, const char *str, size_t size, bool valid)
+/* quoted only when it has to be; six-bit text may hold ',' and '"' */
+{
+    size_t n = valid ? strnlen(str, size) : 0, i;
+    bool quote = false;
+
+    for (i = 0; i < n; i++)
+	quote |= (str[i] == ',' || str[i] == '"');
+    if (quote)
+	*p++ = '"';
+    for (i = 0; i < n; i++) {
+	if (str[i] == '"')
+	    *p++ = '"';
+	*p++ = str[i];
+    }
+    if (quote)
+	*p++ = '"';
+    *p++ = ',';
+    return p;
+}
+
+static char *csv_skip(char *p, size_t n)
+/* n empty fields */
+{
+    (void)memset(p, ',', n);
+    return p + n;
+}
+
+#define CSV_TEXT(p, member, valid) csv_text(p, member, sizeof(member), valid)
+
+static char *csv_position(char *p, const struct ais_t *ais)
+/* status to second, as in the Arrow position family */
+{
+    unsigned int status = 0, speed = 0, course = 0, heading = 0, second = 0;
+    int lon, lat;
+    double div = AIS_LATLON_DIV;
+
+    switch (ais->type) {
+    case 1:
+    case 2:
+    case 3:
+	status = ais->type1.status;
+	speed = ais->type1.speed;
+	lon = ais->type1.lon;
+	lat = ais->type1.lat;
+	course = ais->type1.course;
+	heading = ais->type1.heading;
+	second = ais->type1.second;
+	break;
+    case 18:
+	speed = ais->type18.speed;
+	lon = ais->type18.lon;
+	lat = ais->type18.lat;
+	course = ais->type18.course;
+	heading = ais->type18.heading;
+	second = ais->type18.second;
+	break;
+    case 19:
+	speed = ais->type19.speed;
+	lon = ais->type19.lon;
+	lat = ais->type19.lat;
+	course = ais->type19.course;
+	heading = ais->type19.heading;
+	second = ais->type19.second;
+	break;
+    case 27:
+	status = ais->type27.status;
+	lon = ais->type27.lon;
+	lat = ais->type27.lat;
+	div = AIS_LONGRANGE_LATLON_DIV;
+	break;
+    case 4:
+    case 11:
+	lon = ais->type4.lon;
+	lat = ais->type4.lat;
+	second = ais->type4.second;
+	break;
+    default:
+	return csv_skip(p, 7);
+    }
+
+    p = csv_uint(p, status, ais->type <= 3 || ais->type == 27);
+    if (ais->type == 27)
+	p = csv_uint(p, ais->type27.speed,
+		     ais->type27.speed != AIS_LONGRANGE_SPEED_NOT_AVAILABLE);
+    else
+	p = csv_fixed(p, speed, 1, ais->type != 4 && ais->type != 11
+		      && speed != AIS_SPEED_NOT_AVAILABLE);
+    p = csv_degrees(p, lon, div, abs(lon) <= 180 * div);
+    p = csv_degrees(p, lat, div, abs(lat) <= 90 * div);
+    if (ais->type == 27)
+	p = csv_uint(p, ais->type27.course, ais->type27.course < 360);
+    else
+	p = csv_fixed(p, course, 1, ais->type != 4 && ais->type != 11
+		      && course < AIS_COURSE_NOT_AVAILABLE);
+    p = csv_uint(p, heading, ais->type != 4 && ais->type != 11
+		 && ais->type != 27 && heading < 360);
+    p = csv_uint(p, second, ais->type != 27 && second < AIS_SEC_NOT_AVAILABLE);
+    return p;
+}
+
+static char *csv_static(char *p, const struct ais_t *ais)
+/* imo to destination, as in the Arrow static family */
+{
+    bool a = ais->type == 24 && ais->type24.part != part_b;
+    bool b = ais->type == 24 && ais->type24.part != part_a;
+    bool dim = b && !AIS_AUXILIARY_MMSI(ais->mmsi);
+
+    switch (ais->type) {
+    case 5:
+	p = csv_uint(p, ais->type5.imo, true);
+	p = CSV_TEXT(p, ais->type5.callsign, true);
+	p = CSV_TEXT(p, ais->type5.shipname, true);
+	p = csv_uint(p, ais->type5.shiptype, true);
+	p = csv_uint(p, ais->type5.to_bow, true);
+	p = csv_uint(p, ais->type5.to_stern, true);
+	p = csv_uint(p, ais->type5.to_port, true);
+	p = csv_uint(p, ais->type5.to_starboard, true);
+	p = csv_fixed(p, ais->type5.draught, 1, true);
+	return CSV_TEXT(p, ais->type5.destination, true);
+    case 19:
+	p = csv_uint(p, 0, false);
+	p = csv_uint(p, 0, false);
+	p = CSV_TEXT(p, ais->type19.shipname, true);
+	p = csv_uint(p, ais->type19.shiptype, true);
+	p = csv_uint(p, ais->type19.to_bow, true);
+	p = csv_uint(p, ais->type19.to_stern, true);
+	p = csv_uint(p, ais->type19.to_port, true);
+	p = csv_uint(p, ais->type19.to_starboard, true);
+	return csv_skip(p, 2);
+    case 24:
+	p = csv_uint(p, 0, false);
+	p = CSV_TEXT(p, ais->type24.callsign, b);
+	p = CSV_TEXT(p, ais->type24.shipname, a);
+	p = csv_uint(p, ais->type24.shiptype, b);
+	p = csv_uint(p, ais->type24.dim.to_bow, dim);
+	p = csv_uint(p, ais->type24.dim.to_stern, dim);
+	p = csv_uint(p, ais->type24.dim.to_port, dim);
+	p = csv_uint(p, ais->type24.dim.to_starboard, dim);
+	return csv_skip(p, 2);
+    default:
+	return csv_skip(p, 10);
+    }
+}
+
+static void emit(const struct ais_t *msg)
+{
+    char *p = out_reserve(OUT_ROW_MAX), *q;
+    size_t n = 0;
+
+    switch (format) {
+    case format_json:
+	n = json_aivdm_dump(msg, NULL, scaled, p, OUT_ROW_MAX);
+	if (n >= OUT_ROW_MAX) {
+	    totals.truncated++;
+	    return;
+	}
+	/* JSON Lines: "\n" rather than the "\r\n" of gpsd's reports */
+	if (n >= 2 && p[n - 2] == '\r') {
+	    p[n - 2] = '\n';
+	    n--;
+	}
+	break;
+    case format_csv:
+	q = csv_uint(p, msg->type, true);
+	q = csv_uint(q, msg->repeat, true);
+	q = csv_uint(q, msg->mmsi, true);
+	q = csv_static(csv_position(q, msg), msg);
+	q[-1] = '\n';		/* in place of the last field's ',' */
+	n = (size_t)(q - p);
+	break;
+    case format_record:
+	n = ais_record_dump(msg, (unsigned char *)p, AIS_RECORD_MAX);
+	break;
+    case format_arrow:
+	break;			/* written a batch at a time by decode() */
+    }
+    out.len += n;
+}
+
+static size_t decode(const char *buf, size_t len, bool flush)
+/* decode and write out whole lines; returns the bytes consumed */
+{
+    size_t used = 0;
+
+    while (used < len) {
+	struct aivdm_batch_t batch = {ais, BATCH_MAX, NULL, NULL, NULL,
+				      (size_t)-1,
+				      flush, 0, 0};
+	size_t n = aivdm_decode_batch(buf + used, len - used, &session, &batch);
+	size_t i;
+
+	if (format == format_arrow)
+	    (void)ais_arrow_write_batch(arrow, &batch);
+	else
+	    for (i = 0; i < batch.nais; i++)
+		emit(&ais[i]);
+	totals.lines += batch.nlines;
+	totals.messages += batch.nais;
+	if (n == 0)
+	    break;		/* an unterminated last line */
+	used += n;
+    }
+    totals.bytes += used;
+    return used;
+}
+
+static bool decode_mapped(int fd, size_t size)
+/*
+ * Decode a mapped file a window at a time, dropping each window's
+ * pages from the mapping once they are done with, so that the
+ * process stays small however large the file.
+ */
+{
+    const char *map;
+    size_t off = 0, done = 0, page = (size_t)sysconf(_SC_PAGESIZE);
+
+    if (size == 0)
+	return true;
+    map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+	return false;
+    (void)madvise((void *)map, size, MADV_SEQUENTIAL);
+    while (off < size) {
+	size_t n = size - off < MAP_WINDOW ? size - off : MAP_WINDOW;
+	size_t used = decode(map + off, n, off + n == size);
+
+	/* a line longer than the window: take the rest in one go */
+	if (used == 0)
+	    used = decode(map + off, size - off, true);
+	off += used;
+	if (off / page * page > done) {
+	    (void)madvise((void *)(map + done), off / page * page - done,
+			  MADV_DONTNEED);
+	    done = off / page * page;
+	}
+    }
+    (void)munmap((void *)map, size);
+    return true;
+}
+
+static bool decode_stream(int fd)
+/* read in large blocks, carrying an unterminated line over */
+{
+    static char buf[2 * READ_BLOCK];
+    size_t len = 0;
+    ssize_t n;
+
+    for (;;) {
+	size_t used;
+
+	n = read(fd, buf + len, sizeof(buf) - len);
+	if (n < 0 && errno == EINTR)
+	    continue;
+	if (n <= 0)
+	    break;
+	len += (size_t)n;
+	used = decode(buf, len, false);
+	/* a line as long as the buffer is no line at all */
+	if (used == 0 && len == sizeof(buf))
+	    used = decode(buf, len, true);
+	(void)memmove(buf, buf + used, len - used);
+	len -= used;
+    }
+    (void)decode(buf, len, true);
+    return n == 0;
+}
+
+static bool decode_file(const char *path)
+{
+    struct stat sb;
+    int fd = 0;
+    bool ok;
+
+    if (strcmp(path, "-") != 0 && (fd = open(path, O_RDONLY)) < 0) {
+	(void)fprintf(stderr, "libais: %s: %s\n", path, strerror(errno));
+	return false;
+    }
+    ok = fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode)
+	&& decode_mapped(fd, (size_t)sb.st_size);
+    if (!ok)
+	ok = decode_stream(fd);
+    if (!ok)
+	(void)fprintf(stderr, "libais: %s: %s\n", path, strerror(errno));
+    if (fd != 0)
+	(void)close(fd);
+    return ok;
+}
+
+static bool parse_types(const char *arg, unsigned long *types)
+{
+    char *end;
+
+    *types = 0;
+    do {
+	unsigned long type = strtoul(arg, &end, 10);
+
+	if (end == arg || type >= CHAR_BIT * sizeof(*types))
+	    return false;
+	*types |= 1UL << type;
+	arg = end + 1;
+    } while (*end == ',');
+    return *end == '\0';
+}
+
+static bool arrow_open(const char *prefix)
+/* a writer per family, on prefix.family.arrow */
+{
+    char path[PATH_MAX];
+    int family;
+
+    for (family = 0; family < AIS_ARROW_FAMILIES; family++) {
+	(void)snprintf(path, sizeof(path), "%s.%s.arrow",
+		       prefix, arrow_names[family]);
+	if ((arrow_fp[family] = fopen(path, "wb")) == NULL
+	    || (arrow[family] = ais_arrow_open(family,
+					       arrow_fp[family])) == NULL) {
+	    (void)fprintf(stderr, "libais: %s: %s\n", path, strerror(errno));
+	    return false;
+	}
+    }
+    return true;
+}
+
+static bool arrow_close(void)
+/* end the streams; false if any failed */
+{
+    bool ok = true;
+    int family;
+
+    for (family = 0; family < AIS_ARROW_FAMILIES; family++) {
+	if (arrow[family] != NULL)
+	    ok = ais_arrow_close(arrow[family]) && ok;
+	if (arrow_fp[family] != NULL)
+	    ok = fclose(arrow_fp[family]) == 0 && ok;
+	arrow[family] = NULL;
+	arrow_fp[family] = NULL;
+    }
+    return ok;
+}
+
+static void usage(void)
+{
+    (void)fprintf(stderr,
+		  "usage: libais [-f json|csv|record|arrow] [-u] [-o output] "
+		  "[-t types] [-m mmsi-file] [-c ignore|flag|reject] [-q] "
+		  "[file...]\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[]) {
+    struct ais_mmsi_set_t *watchlist = NULL;
+    const char *output = NULL;
+    struct timespec start, end;
+    bool quiet = false, ok = true;
+    double elapsed;
+    int opt, i;
+
+    out.fd = STDOUT_FILENO;
+    while ((opt = getopt(argc, argv, "c:f:m:o:qt:u")) != -1) {
+	switch (opt) {
+	case 'c':
+	    if (strcmp(optarg, "ignore") == 0)
+		session.driver.aivdm.checksum = checksum_ignore;
+	    else if (strcmp(optarg, "flag") == 0)
+		session.driver.aivdm.checksum = checksum_flag;
+	    else if (strcmp(optarg, "reject") == 0)
+		session.driver.aivdm.checksum = checksum_reject;
+	    else
+		usage();
+	    break;
+	case 'f':
+	    if (strcmp(optarg, "json") == 0)
+		format = format_json;
+	    else if (strcmp(optarg, "csv") == 0)
+		format = format_csv;
+	    else if (strcmp(optarg, "record") == 0)
+		format = format_record;
+	    else if (strcmp(optarg, "arrow") == 0)
+		format = format_arrow;
+	    else
+		usage();
+	    break;
+	case 'm': {
+	    FILE *fp = fopen(optarg, "r");
+	    size_t badline = 0;
+
+	    if (fp != NULL) {
+		watchlist = ais_mmsi_set_read(fp, &badline);
+		(void)fclose(fp);
+	    }
+	    if (watchlist == NULL) {
+		if (badline != 0)
+		    (void)fprintf(stderr, "libais: %s:%zu: bad MMSI\n",
+				  optarg, badline);
+		else
+		    (void)fprintf(stderr, "libais: %s: %s\n",
+				  optarg, strerror(errno));
+		exit(EXIT_FAILURE);
+	    }
+	    session.driver.aivdm.filter.mmsi = watchlist;
+	    break;
+	}
+	case 'o':
+	    output = optarg;
+	    break;
+	case 'q':
+	    quiet = true;
+	    break;
+	case 't':
+	    if (!parse_types(optarg, &session.driver.aivdm.filter.types))
+		usage();
+	    break;
+	case 'u':
+	    scaled = false;
+	    break;
+	default:
+	    usage();
+	}
+    }
+
+    if (format == format_arrow) {
+	if (!arrow_open(output != NULL ? output : "ais")) {
+	    (void)arrow_close();
+	    exit(EXIT_FAILURE);
+	}
+    } else if (output != NULL) {
+	out.fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (out.fd < 0) {
+	    (void)fprintf(stderr, "libais: %s: %s\n",
+			  output, strerror(errno));
+	    exit(EXIT_FAILURE);
+	}
+    }
+    if ((out.buf = malloc(OUT_BUFSIZE)) == NULL) {
+	perror("libais");
+	exit(EXIT_FAILURE);
+    }
+    if (format == format_csv)
+	out.len = strlen(strcpy(out.buf, csv_header));
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    if (optind == argc)
+	ok = decode_file("-");
+    for (i = optind; i < argc; i++)
+	ok = decode_file(argv[i]) && ok;
+    out_flush();
+    if (!arrow_close()) {
+	(void)fprintf(stderr, "libais: Arrow output failed\n");
+	ok = false;
+    }
+    (void)clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (!quiet) {
+	const struct aivdm_stats_t *stats = &session.driver.aivdm.stats;
+
+	elapsed = (end.tv_sec - start.tv_sec)
+	    + (end.tv_nsec - start.tv_nsec) / 1e9;
+	if (elapsed <= 0)
+	    elapsed = 1e-9;
+	(void)fprintf(stderr,
+		      "libais: %.1f MB in %.3f s, %.1f MB/s; "
+		      "%llu lines, %llu messages, %.0f messages/s\n",
+		      totals.bytes / 1e6, elapsed, totals.bytes / 1e6 / elapsed,
+		      totals.lines, totals.messages,
+		      totals.messages / elapsed);
+	if (session.driver.aivdm.checksum == checksum_ignore)
+	    (void)fprintf(stderr, "libais: checksums not checked, ");
+	else
+	    (void)fprintf(stderr, "libais: %lu checksum errors, ",
+			  stats->checksum_errors);
+	(void)fprintf(stderr,
+		      "%lu partials dropped, "
+		      "%lu expired, %lu sentences filtered out, "
+		      "%llu reports too long\n",
+		      stats->partials_dropped,
+		      stats->partials_expired, stats->filter_skipped,
+		      totals.truncated);
+    }
+    ais_mmsi_set_free(watchlist);
+    free(out.buf);
+    return (ok && !out.error) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -1,10 +1,18 @@
-from distutils.core import setup, Extension
+import sys
 
-SOURCES = ['libais-python.c', 'libais.c', 'gpsd_json.c', 'driver_ais.c', 'bits.c']
+from setuptools import setup, Extension
 
-libais = Extension('libais', sources = SOURCES)
+SOURCES = ['libais-python.c', 'libais.c', 'gpsd_json.c', 'ais_record.c', 'ais_arrow.c', 'ais_mmsi.c', 'driver_ais.c', 'bits.c', 'strl.c']
+
+# glibc lacks strlcat/strlcpy; the BSDs and macOS have their own
+MACROS = []
+if sys.platform == 'darwin' or 'bsd' in sys.platform:
+    MACROS = [('HAVE_STRLCAT', None), ('HAVE_STRLCPY', None)]
+
+libais = Extension('libais', sources = SOURCES, define_macros = MACROS, libraries = ['pthread'])
 
 setup (name = 'libais',
        version = '1.0',
        description = 'Package for decoding of AIS/NMEA sentences.',
+       python_requires = '>=3.5',
        ext_modules = [libais])
@@ -0,0 +1,518 @@
+/*
+ * Microbenchmarks behind the figures quoted in the history.  Build with
+ * optimization and without the sanitizers, from the libais directory:
+ *
+ *     cc -O2 -I. -o bench test/bench.c libais.c driver_ais.c bits.c \
+ *         gpsd_json.c ais_record.c ais_arrow.c ais_mmsi.c strl.c -lm -lpthread
+ *
+ * Usage: bench [-f log] [-t threads] [name...]
+ *
+ * With no name every benchmark is run.  Times are the best of a few
+ * runs, so that a busy host inflates them less.  The benchmarks that
+ * decode sentences read them from the log given with -f, or else
+ * generate a synthetic one: 200k messages, 80% types 1-3 and the rest
+ * spread over the other types, with random contents.  The generator is
+ * seeded, so every run sees the same corpus.  Those benchmarks but
+ * "parallel" use only interfaces as old as the library, so to compare
+ * with an older tree, build this file against it and name them.
+ *
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdbool.h>
+
+#include "libais.h"
+
+#define RUNS	5		/* the best of these is reported */
+#define CORPUS_MESSAGES	200000
+#define FRAGMENT_CHARS	60	/* payload characters per sentence */
+
+static volatile uint64_t sink;	/* keeps results from being optimized out */
+
+/* the corpus, as NUL-terminated lines in one buffer */
+static const char *corpus_path;
+static int max_threads;		/* for "parallel"; 0 means one per CPU */
+static char *corpus;
+static size_t corpus_len;
+static struct {
+    const char *ptr;
+    size_t len;
+} *line;
+static size_t nlines;
+
+static double now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * bits: the fields of a type 1 report over its 21-byte payload, by
+ * the reference ubits() and by the word-at-a-time ubits_be().
+ */
+static const unsigned int type1_fields[][2] = {
+    {0, 6}, {6, 2}, {8, 30}, {38, 4}, {42, 8}, {50, 10}, {60, 1},
+    {61, 28}, {89, 27}, {116, 12}, {128, 9}, {137, 6}, {143, 2},
+    {148, 1}, {149, 19},
+};
+#define TYPE1_FIELDS	(sizeof(type1_fields) / sizeof(type1_fields[0]))
+#define TYPE1_BYTES	21
+#define BITS_ROUNDS	2000000
+
+static void bench_bits(void)
+{
+    unsigned char buf[TYPE1_BYTES + 8];
+    double best_ref = 1e9, best_be = 1e9, t;
+    unsigned int n, k, run;
+
+    srand(1);
+    for (n = 0; n < sizeof(buf); n++)
+	buf[n] = (unsigned char)rand();
+    for (run = 0; run < RUNS; run++) {
+	t = now();
+	for (n = 0; n < BITS_ROUNDS; n++) {
+	    buf[n % TYPE1_BYTES] ^= (unsigned char)n;
+	    for (k = 0; k < TYPE1_FIELDS; k++)
+		sink += ubits(buf, type1_fields[k][0], type1_fields[k][1],
+			      false);
+	}
+	if ((t = now() - t) < best_ref)
+	    best_ref = t;
+	t = now();
+	for (n = 0; n < BITS_ROUNDS; n++) {
+	    buf[n % TYPE1_BYTES] ^= (unsigned char)n;
+	    for (k = 0; k < TYPE1_FIELDS; k++)
+		sink += ubits_be(buf, TYPE1_BYTES, type1_fields[k][0],
+				 type1_fields[k][1]);
+	}
+	if ((t = now() - t) < best_be)
+	    best_be = t;
+    }
+    (void)printf("bits: ubits() %.2f ns/field, ubits_be() %.2f ns/field\n",
+		 best_ref * 1e9 / (BITS_ROUNDS * TYPE1_FIELDS),
+		 best_be * 1e9 / (BITS_ROUNDS * TYPE1_FIELDS));
+}
+
+/*
+ * The synthetic corpus.  Messages have the length their type usually
+ * has, and binary messages a length picked from a spread; the type 6
+ * and 8 ones often carry a DAC and FID that have a decoder.
+ */
+static unsigned long long rng_state = 0x9e3779b97f4a7c15ULL;
+
+static unsigned int rng(void)
+/* xorshift64* */
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (unsigned int)((rng_state * 2685821657736338717ULL) >> 32);
+}
+
+static void put_bits(unsigned char *bits, unsigned int start,
+		     unsigned int width, unsigned int value)
+{
+    unsigned int i;
+
+    for (i = 0; i < width; i++) {
+	unsigned int bit = start + i;
+	unsigned char mask = (unsigned char)(0x80 >> (bit % CHAR_BIT));
+
+	if ((value >> (width - 1 - i)) & 1)
+	    bits[bit / CHAR_BIT] |= mask;
+	else
+	    bits[bit / CHAR_BIT] &= (unsigned char)~mask;
+    }
+}
+
+static unsigned int message_bits(unsigned int type)
+{
+    static const unsigned int binary[] = {
+	72, 96, 136, 168, 232, 248, 256, 360, 424, 600, 900,
+    };
+
+    switch (type) {
+    case 5:
+	return 424;
+    case 6: case 8: case 12: case 14: case 17: case 25: case 26:
+	return binary[rng() % (sizeof(binary) / sizeof(binary[0]))];
+    case 10: case 13:
+	return 72;
+    case 15: case 20: case 23:
+	return 160;
+    case 16:
+	return 144;
+    case 19:
+	return 312;
+    case 21:
+	return 272 + 40 * (rng() % 3);
+    case 24:
+	return rng() % 2 != 0 ? 168 : 160;
+    case 27:
+	return 96;
+    default:
+	return 168;
+    }
+}
+
+static size_t corpus_message(char *out, unsigned int seq)
+/* append the sentences of one random message; returns their length */
+{
+    static const unsigned int dac1_fid6[] = {10, 12, 14, 15, 16, 18, 20,
+					     21, 22, 25, 28, 30, 32, 55};
+    static const unsigned int dac1_fid8[] = {10, 11, 13, 15, 16, 17, 19,
+					     23, 24, 27, 29, 31, 40};
+    unsigned char bits[AIVDM_MAX_BITS / CHAR_BIT];
+    char payload[AIVDM_MAX_BITS / 6 + 1];
+    unsigned int type, nbits, nchars, pad, nfrags, i;
+    char channel = rng() % 2 != 0 ? 'A' : 'B';
+    size_t len = 0;
+
+    type = rng() % 5 != 0 ? 1 + rng() % 3 : 4 + rng() % 24;
+    nbits = message_bits(type);
+    for (i = 0; i < sizeof(bits); i++)
+	bits[i] = (unsigned char)rng();
+    put_bits(bits, 0, 6, type);
+    if (type == 24)
+	put_bits(bits, 38, 2, rng() % 2);
+    else if (type == 6 && rng() % 5 < 3) {
+	put_bits(bits, 72, 10, 1);
+	put_bits(bits, 82, 6, dac1_fid6[rng() % (sizeof(dac1_fid6)
+						  / sizeof(dac1_fid6[0]))]);
+    } else if (type == 8 && rng() % 5 < 3) {
+	put_bits(bits, 40, 10, 1);
+	put_bits(bits, 50, 6, dac1_fid8[rng() % (sizeof(dac1_fid8)
+						  / sizeof(dac1_fid8[0]))]);
+    }
+
+    nchars = (nbits + 5) / 6;
+    pad = nchars * 6 - nbits;
+    for (i = 0; i < nchars; i++) {
+	unsigned int v = (unsigned int)ubits(bits, i * 6, 6, false);
+
+	payload[i] = (char)(v < 40 ? '0' + v : '`' + v - 40);
+    }
+    nfrags = (nchars + FRAGMENT_CHARS - 1) / FRAGMENT_CHARS;
+    for (i = 0; i < nfrags; i++) {
+	unsigned int from = i * FRAGMENT_CHARS;
+	unsigned int n = nchars - from < FRAGMENT_CHARS
+	    ? nchars - from : FRAGMENT_CHARS;
+	unsigned char sum = 0;
+	char *start = out + len;
+	int k, body;
+
+	body = sprintf(start, "!AIVDM,%u,%u,", nfrags, i + 1);
+	if (nfrags > 1)
+	    body += sprintf(start + body, "%u", seq % 10);
+	body += sprintf(start + body, ",%c,%.*s,%u", channel, (int)n,
+			payload + from, i + 1 == nfrags ? pad : 0);
+	for (k = 1; k < body; k++)
+	    sum ^= (unsigned char)start[k];
+	len += (size_t)body + (size_t)sprintf(start + body, "*%02X\n", sum);
+    }
+    return len;
+}
+
+static void corpus_load(void)
+/* read or generate the corpus, once */
+{
+    size_t i, start;
+
+    if (corpus != NULL)
+	return;
+    if (corpus_path != NULL) {
+	FILE *fp = fopen(corpus_path, "rb");
+	size_t size = 1 << 20;
+
+	if (fp == NULL) {
+	    perror(corpus_path);
+	    exit(EXIT_FAILURE);
+	}
+	for (;;) {
+	    if ((corpus = realloc(corpus, size)) == NULL) {
+		perror("bench");
+		exit(EXIT_FAILURE);
+	    }
+	    corpus_len += fread(corpus + corpus_len, 1, size - corpus_len, fp);
+	    if (corpus_len < size)
+		break;
+	    size *= 2;
+	}
+	(void)fclose(fp);
+	if (corpus_len > 0 && corpus[corpus_len - 1] != '\n') {
+	    if (corpus_len == size
+		&& (corpus = realloc(corpus, size + 1)) == NULL) {
+		perror("bench");
+		exit(EXIT_FAILURE);
+	    }
+	    corpus[corpus_len++] = '\n';
+	}
+    } else {
+	/* four sentences of 100 characters cover the longest message */
+	if ((corpus = malloc((size_t)CORPUS_MESSAGES * 400)) == NULL) {
+	    perror("bench");
+	    exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < CORPUS_MESSAGES; i++)
+	    corpus_len += corpus_message(corpus + corpus_len, (unsigned int)i);
+    }
+
+    for (i = 0; i < corpus_len; i++)
+	nlines += corpus[i] == '\n';
+    if ((line = malloc((nlines + 1) * sizeof(*line))) == NULL) {
+	perror("bench");
+	exit(EXIT_FAILURE);
+    }
+    nlines = 0;
+    for (i = start = 0; i < corpus_len; i++)
+	if (corpus[i] == '\n') {
+	    corpus[i] = '\0';	/* old decoders go by strlen() */
+	    line[nlines].ptr = corpus + start;
+	    line[nlines++].len = i - start;
+	    start = i + 1;
+	}
+}
+
+/*
+ * decode: aivdm_decode() over every line of the corpus, in a fresh
+ * session each run; every line costs a fragment store, a reject or a
+ * full decode.
+ */
+static void bench_decode(void)
+{
+    static struct gps_device_t session;
+    /* trees before the user-010 bounds fixes write past a lone ais_t */
+    static struct ais_t ais[8];
+    double best = 1e9, t;
+    unsigned long decoded = 0;
+    size_t i;
+    unsigned int run;
+
+    corpus_load();
+    for (run = 0; run < RUNS; run++) {
+	memset(&session, 0, sizeof(session));
+	decoded = 0;
+	t = now();
+	for (i = 0; i < nlines; i++)
+	    decoded += aivdm_decode(line[i].ptr, line[i].len, &session,
+				    ais, 0);
+	if ((t = now() - t) < best)
+	    best = t;
+    }
+    (void)printf("decode: %zu lines, %lu messages, %.1f ns/line\n",
+		 nlines, decoded, best * 1e9 / (double)nlines);
+}
+
+/*
+ * json: json_aivdm_dump() of the corpus' messages, decoded beforehand,
+ * in scaled and unscaled form, by group of types.  Small groups are
+ * dumped repeatedly, so that every timing covers some JSON_DUMPS
+ * reports.
+ */
+#define JSON_DUMPS	200000
+static const struct {
+    const char *name;
+    unsigned long types;	/* bit n for type n */
+} json_groups[] = {
+    {"types 1-3", (1UL << 1) | (1UL << 2) | (1UL << 3)},
+    {"type 5", 1UL << 5},
+    {"types 6, 8", (1UL << 6) | (1UL << 8)},
+    {"type 24", 1UL << 24},
+    {"all", ~0UL},
+};
+
+static void bench_json(void)
+{
+    static struct gps_device_t session;
+    static char buf[JSON_VAL_MAX * 2 + 1];
+    struct ais_t *ais, **member;
+    size_t nais = 0, i, g;
+
+    corpus_load();
+    /* the slack at the end is for trees before the user-010 fixes */
+    ais = calloc(nlines + 8, sizeof(*ais));
+    member = calloc(nlines, sizeof(*member));
+    if (ais == NULL || member == NULL) {
+	perror("bench");
+	exit(EXIT_FAILURE);
+    }
+    memset(&session, 0, sizeof(session));
+    for (i = 0; i < nlines; i++)
+	nais += aivdm_decode(line[i].ptr, line[i].len, &session,
+			     &ais[nais], 0);
+
+    for (g = 0; g < sizeof(json_groups) / sizeof(json_groups[0]); g++) {
+	double best[2] = {1e9, 1e9}, t;
+	size_t n = 0, reps, r;
+	unsigned int run, scaled;
+
+	for (i = 0; i < nais; i++)
+	    if ((json_groups[g].types >> (ais[i].type % 64)) & 1)
+		member[n++] = &ais[i];
+	if (n == 0)
+	    continue;
+	reps = (JSON_DUMPS + n - 1) / n;
+	for (scaled = 0; scaled < 2; scaled++)
+	    for (run = 0; run < RUNS; run++) {
+		t = now();
+		for (r = 0; r < reps; r++)
+		    for (i = 0; i < n; i++) {
+			json_aivdm_dump(member[i], NULL, scaled != 0,
+					buf, sizeof(buf));
+			sink += (unsigned char)buf[0];
+		    }
+		if ((t = now() - t) < best[scaled])
+		    best[scaled] = t;
+	    }
+	n *= reps;
+	(void)printf("json: %-10s %6.0f ns scaled, %6.0f ns unscaled\n",
+		     json_groups[g].name,
+		     best[1] * 1e9 / (double)n, best[0] * 1e9 / (double)n);
+    }
+    free(member);
+    free(ais);
+}
+
+/*
+ * parallel: aivdm_decode_parallel() over the corpus with 1 to N
+ * threads, N from -t or one per CPU.  The messages are dealt round
+ * robin to PARALLEL_STREAMS receivers, so there are twice as many
+ * shards to spread over the threads, and the corpus is fed in batches
+ * of PARALLEL_BATCH lines, each of which starts and joins its threads.
+ */
+#define PARALLEL_STREAMS	8
+#define PARALLEL_BATCH	16384
+
+static bool last_fragment(const char *s)
+/* is this sentence the last of its message, or not a fragment at all? */
+{
+    unsigned long count, number;
+    char *end;
+
+    if ((s = strchr(s, ',')) == NULL)
+	return true;
+    count = strtoul(s + 1, &end, 10);
+    if (*end != ',')
+	return true;
+    number = strtoul(end + 1, &end, 10);
+    return *end != ',' || number >= count;
+}
+
+static void bench_parallel(void)
+{
+    static struct gps_device_t sessions[PARALLEL_STREAMS * AIVDM_CHANNELS];
+    struct aivdm_span_t *span;
+    unsigned int *stream, next = 0;
+    struct ais_t *ais;
+    double single = 0;
+    unsigned long decoded = 0;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int nthreads, top = max_threads;
+    size_t i;
+
+    corpus_load();
+    span = malloc(nlines * sizeof(*span));
+    stream = malloc(nlines * sizeof(*stream));
+    ais = malloc(PARALLEL_BATCH * sizeof(*ais));
+    if (span == NULL || stream == NULL || ais == NULL) {
+	perror("bench");
+	exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < nlines; i++) {
+	span[i].ptr = line[i].ptr;
+	span[i].len = line[i].len;
+	stream[i] = next;
+	if (last_fragment(line[i].ptr))
+	    next = (next + 1) % PARALLEL_STREAMS;
+    }
+
+    if (top <= 0)
+	top = ncpu > 0 ? (int)ncpu : 1;
+    if (top > AIVDM_MAX_THREADS)
+	top = AIVDM_MAX_THREADS;
+    for (nthreads = 1; nthreads <= top; nthreads++) {
+	double best = 1e9, t;
+	unsigned int run;
+
+	for (run = 0; run < RUNS; run++) {
+	    struct aivdm_batch_t batch = {ais, PARALLEL_BATCH, NULL, NULL,
+					  NULL, PARALLEL_BATCH, true, 0, 0};
+
+	    memset(sessions, 0, sizeof(sessions));
+	    decoded = 0;
+	    t = now();
+	    for (i = 0; i < nlines; i += batch.nlines) {
+		if (aivdm_decode_parallel(span + i, stream + i, nlines - i,
+					  sessions, PARALLEL_STREAMS,
+					  nthreads, &batch) == 0)
+		    break;
+		decoded += batch.nais;
+	    }
+	    if ((t = now() - t) < best)
+		best = t;
+	}
+	if (nthreads == 1)
+	    single = best;
+	(void)printf("parallel: %2d threads, %zu lines, %lu messages, "
+		     "%.1f ns/line, %.2fx\n", nthreads, nlines, decoded,
+		     best * 1e9 / (double)nlines, single / best);
+    }
+    (void)printf("parallel: %ld CPUs online\n", ncpu);
+    free(ais);
+    free(stream);
+    free(span);
+}
+
+static const struct {
+    const char *name;
+    void (*run)(void);
+} benches[] = {
+    {"bits", bench_bits},
+    {"decode", bench_decode},
+    {"json", bench_json},
+    {"parallel", bench_parallel},
+};
+#define NBENCHES	(sizeof(benches) / sizeof(benches[0]))
+
+int main(int argc, char *argv[])
+{
+    size_t b;
+    int i, opt;
+
+    while ((opt = getopt(argc, argv, "f:t:")) != -1) {
+	switch (opt) {
+	case 'f':
+	    corpus_path = optarg;
+	    break;
+	case 't':
+	    max_threads = atoi(optarg);
+	    break;
+	default:
+	    (void)fprintf(stderr,
+			  "usage: bench [-f log] [-t threads] [name...]\n");
+	    return EXIT_FAILURE;
+	}
+    }
+    if (optind == argc)
+	for (b = 0; b < NBENCHES; b++)
+	    benches[b].run();
+    for (i = optind; i < argc; i++) {
+	for (b = 0; b < NBENCHES; b++)
+	    if (strcmp(argv[i], benches[b].name) == 0)
+		break;
+	if (b == NBENCHES) {
+	    (void)fprintf(stderr, "bench: no benchmark '%s'\n", argv[i]);
+	    return EXIT_FAILURE;
+	}
+	benches[b].run();
+    }
+    return EXIT_SUCCESS;
+}
+
+/* bench.c ends here */
@@ -0,0 +1,200 @@
+/*
+ * Fuzz equivalence of the de-armoring kernels.  Every kernel the CPU
+ * supports must give exactly what the scalar loop alone gives, on
+ * random payloads and on mutations of real sentences: the same verdict
+ * and the same bits from aivdm_dearmor(), and the same status and JSON
+ * report from aivdm_decode_status().  The kernels are static, so this
+ * includes libais.c rather than linking it; run.sh builds it with the
+ * sanitizers, which also catch any kernel reading or writing out of
+ * bounds.
+ *
+ * Usage: dearmor [iterations [seed]]
+ *
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include "libais.c"
+
+#define ITERATIONS	100000
+
+struct kernel_t {
+    const char *name;
+    aivdm_unpack_t unpack;
+    bool supported;
+};
+
+static struct kernel_t kernels[] = {
+    {"scalar", aivdm_unpack_scalar, true},
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    {"sse4.1", aivdm_unpack_sse41, false},
+    {"avx2", aivdm_unpack_avx2, false},
+#endif
+};
+#define NKERNELS	(sizeof(kernels) / sizeof(kernels[0]))
+
+/* seeds for the mutation stage, a spread of types and lengths */
+static const char *seeds[] = {
+    "!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*24",
+    "!AIVDM,1,1,,B,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*4D",
+    "!AIVDM,1,1,,A,402R3WiuHkGOoO`@ANSE1Jw02<1@,0*38",
+    "!AIVDM,1,1,,B,85NoHR1KfI99t:BHBI3sWpAoS7VHRblW8McQtR3lsFR,0*12",
+    "!AIVDM,1,1,,A,B6CdCm0t3`tba35f@V9faHi7kP06,0*58",
+    "!AIVDM,1,1,,B,H42O55i18tMET00000000000000,2*6D",
+    "!AIVDM,1,1,,A,D02E34iDMN?b<`N000,4*3B",
+    "!AIVDM,2,1,1,A,55?MbV02;H;s<HtKR20EHE:0@T4@Dn2222222216L961O5Gf0NSQEp6ClRp8,0*1C",
+    "!AIVDM,2,2,1,A,88888888880,2*25",
+};
+
+static const char armor_chars[] =
+    "0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVW`abcdefghijklmnopqrstuvw";
+
+static unsigned long long rng_state;
+
+static unsigned int rng(void)
+/* xorshift64*, so runs are repeatable from the seed alone */
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (unsigned int)((rng_state * 2685821657736338717ULL) >> 32);
+}
+
+static void mutate(unsigned char *p, size_t len)
+/* a few substitutions, mostly with valid characters */
+{
+    unsigned int n = rng() % 4, k;
+
+    for (k = 0; k < n && len > 0; k++) {
+	size_t at = rng() % len;
+
+	switch (rng() % 4) {
+	case 0:
+	    p[at] = (unsigned char)rng();
+	    break;
+	case 1:
+	    p[at] ^= (unsigned char)(1 << (rng() % 8));
+	    break;
+	default:
+	    p[at] = (unsigned char)armor_chars[rng() % 64];
+	}
+    }
+}
+
+static int check_dearmor(unsigned long iter)
+/* one random payload through aivdm_dearmor() under every kernel */
+{
+    static unsigned char data[AIVDM_MAX_BITS / 6 + 64];
+    static struct aivdm_context_t ref, ctx;
+    size_t len = rng() % sizeof(data), start = 0, i, k;
+    bool ok, ref_ok = false;
+
+    for (i = 0; i < len; i++)
+	data[i] = (unsigned char)armor_chars[rng() % 64];
+    if (rng() % 2 != 0)
+	mutate(data, len);
+    /* a later fragment starts mid-byte and exercises the carry */
+    if (rng() % 2 != 0)
+	start = rng() % (AIVDM_MAX_BITS + 16);
+    for (i = 0; i < sizeof(ref.bits); i++)
+	ref.bits[i] = (unsigned char)rng();
+
+    for (k = 0; k < NKERNELS; k++) {
+	if (!kernels[k].supported)
+	    continue;
+	memcpy(ctx.bits, ref.bits, sizeof(ctx.bits));
+	ctx.bitlen = start;
+	aivdm_unpack = kernels[k].unpack;
+	ok = aivdm_dearmor(&ctx, data, len);
+	if (k == 0) {
+	    memcpy(&ref, &ctx, sizeof(ref));
+	    ref_ok = ok;
+	    continue;
+	}
+	if (ok != ref_ok
+	    || (ok && (ctx.bitlen != ref.bitlen
+		       || memcmp(ctx.bits, ref.bits,
+				 BITS_TO_BYTES(ref.bitlen)) != 0))) {
+	    (void)fprintf(stderr,
+			  "dearmor: iteration %lu: %s differs from scalar "
+			  "(%zu characters from bit %zu)\n",
+			  iter, kernels[k].name, len, start);
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+static int check_decode(unsigned long iter)
+/* one mutated seed through aivdm_decode_status() under every kernel */
+{
+    static struct gps_device_t session[NKERNELS];
+    static struct ais_t ais;
+    char line[256], ref[JSON_VAL_MAX * 2 + 1], out[JSON_VAL_MAX * 2 + 1];
+    const char *seed = seeds[rng() % (sizeof(seeds) / sizeof(seeds[0]))];
+    size_t len = strlen(seed), paylen, k;
+    enum aivdm_status_t ref_status = aivdm_empty, status;
+    char *payload = memcpy(line, seed, len + 1);
+
+    /* the payload is the sixth field */
+    for (k = 0; k < 5; k++)
+	payload = strchr(payload, ',') + 1;
+    paylen = strcspn(payload, ",");
+    mutate((unsigned char *)payload, paylen);
+    /* shorten or empty the payload, and vary the pad, now and then */
+    if (rng() % 8 == 0) {
+	size_t keep = rng() % (paylen + 1);
+
+	memmove(payload + keep, payload + paylen, len + 1 - (size_t)(payload + paylen - line));
+	len -= paylen - keep;
+	paylen = keep;
+    }
+    if (rng() % 4 == 0)
+	payload[paylen + 1] = (char)('0' + rng() % 10);
+    for (k = 0; k < NKERNELS; k++) {
+	if (!kernels[k].supported)
+	    continue;
+	aivdm_unpack = kernels[k].unpack;
+	status = aivdm_decode_status(line, len, &session[k], &ais);
+	out[0] = '\0';
+	if (status == aivdm_decoded)
+	    (void)json_aivdm_dump(&ais, NULL, true, out, sizeof(out));
+	if (k == 0) {
+	    ref_status = status;
+	    memcpy(ref, out, sizeof(ref));
+	} else if (status != ref_status || strcmp(out, ref) != 0) {
+	    (void)fprintf(stderr,
+			  "dearmor: iteration %lu: %s differs from scalar "
+			  "on %s\n", iter, kernels[k].name, line);
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : ITERATIONS;
+    unsigned long i;
+    size_t k;
+
+    rng_state = argc > 2 ? strtoull(argv[2], NULL, 0) : 0x9e3779b97f4a7c15ULL;
+    if (rng_state == 0)
+	rng_state = 1;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    kernels[1].supported = __builtin_cpu_supports("sse4.1");
+    kernels[2].supported = kernels[1].supported
+	&& __builtin_cpu_supports("avx2");
+#endif
+
+    for (i = 0; i < iterations; i++)
+	if (check_dearmor(i) != 0 || check_decode(i) != 0)
+	    return 1;
+    (void)printf("dearmor: %lu iterations, kernels:", iterations);
+    for (k = 0; k < NKERNELS; k++)
+	if (kernels[k].supported)
+	    (void)printf(" %s", kernels[k].name);
+    (void)printf("; ok\n");
+    return 0;
+}
+
+/* dearmor.c ends here */
@@ -0,0 +1,413 @@
+/*
+ * Regression cases for the sentence decoder: each is a sequence of
+ * sentences fed to a fresh session, with the status expected of each.
+ * Every case is run through aivdm_decode_status(), aivdm_decode_spans()
+ * and aivdm_decode_positions(); the point of most of them is that the
+ * decoder neither crashes nor touches memory it should not, so build
+ * this with the sanitizers, as run.sh does.  The filter is checked here
+ * too, with its counters, and so are the MMSI sets it uses, both kinds
+ * and their text form.
+ *
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "libais.h"
+#include "ais_mmsi.h"
+
+#define CASE_LINES	4
+
+struct case_t {
+    const char *name;
+    const char *line[CASE_LINES];	/* NULL-terminated unless full */
+    enum aivdm_status_t status[CASE_LINES];
+};
+
+static const struct case_t cases[] = {
+    /* an empty first part with 5 pad bits wrapped bitlen */
+    {"empty fragment with padding",
+     {"!AIVDM,2,1,3,A,,5*00",
+      "!AIVDM,2,2,3,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*00"},
+     {aivdm_bad_payload, aivdm_orphan}},
+    {"more padding than payload",
+     {"!AIVDM,1,1,,A,1,7*00"},
+     {aivdm_bad_payload}},
+    {"padding equal to payload",
+     {"!AIVDM,1,1,,A,,0*00"},
+     {aivdm_undecodable}},
+    /* part counts that overflowed an int */
+    {"overlong part count",
+     {"!AIVDM,99999999999999999999,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*00",
+      "!AIVDM,2,99999999999,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*00",
+      "!AIVDM,2,1,4294967297,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*00"},
+     {aivdm_malformed, aivdm_malformed, aivdm_malformed}},
+    {"type 1",
+     {"!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*23"},
+     {aivdm_decoded}},
+    {"type 5 in two parts",
+     {"!AIVDM,2,1,1,A,55?MbV02;H;s<HtKR20EHE:0@T4@Dn2222222216L961O5Gf0NSQEp6ClRp8,0*1C",
+      "!AIVDM,2,2,1,A,88888888880,2*25"},
+     {aivdm_pending, aivdm_decoded}},
+    {"overlong payload",
+     {"!AIVDM,1,1,,A,"
+      "1111111111111111111111111111111111111111111111111111111111111111"
+      "1111111111111111111111111111111111111111111111111111111111111111"
+      "1111111111111111111111111111111111111111111111111111111111111111"
+      "1111111111111111111111111111111111111111111111111111111111111111,0*00"},
+     {aivdm_malformed}},
+};
+
+static struct gps_device_t session;
+static struct ais_t ais[CASE_LINES];
+
+static size_t case_lines(const struct case_t *c)
+{
+    size_t n = 0;
+
+    while (n < CASE_LINES && c->line[n] != NULL)
+	n++;
+    return n;
+}
+
+static int run_status(const struct case_t *c)
+{
+    size_t i, n = case_lines(c);
+    int failed = 0;
+
+    memset(&session, 0, sizeof(session));
+    for (i = 0; i < n; i++) {
+	enum aivdm_status_t status =
+	    aivdm_decode_status(c->line[i], strlen(c->line[i]), &session, ais);
+
+	if (status != c->status[i]) {
+	    (void)fprintf(stderr, "%s: line %zu: status %d, expected %d\n",
+			  c->name, i + 1, (int)status, (int)c->status[i]);
+	    failed = 1;
+	}
+    }
+    return failed;
+}
+
+static int run_spans(const struct case_t *c)
+{
+    struct aivdm_span_t span[CASE_LINES];
+    enum aivdm_status_t status[CASE_LINES];
+    struct aivdm_batch_t batch = {ais, CASE_LINES, NULL, NULL, status,
+				  CASE_LINES, true, 0, 0};
+    size_t i, n = case_lines(c);
+    int failed = 0;
+
+    for (i = 0; i < n; i++) {
+	span[i].ptr = c->line[i];
+	span[i].len = strlen(c->line[i]);
+    }
+    memset(&session, 0, sizeof(session));
+    if (aivdm_decode_spans(span, n, &session, &batch) != n) {
+	(void)fprintf(stderr, "%s: spans not all consumed\n", c->name);
+	return 1;
+    }
+    for (i = 0; i < n; i++)
+	if (status[i] != c->status[i]) {
+	    (void)fprintf(stderr, "%s: span %zu: status %d, expected %d\n",
+			  c->name, i + 1, (int)status[i], (int)c->status[i]);
+	    failed = 1;
+	}
+    return failed;
+}
+
+static int run_positions(const struct case_t *c)
+/* only for the sanitizers: the columns are checked elsewhere */
+{
+    char buf[2048];
+    double lat[CASE_LINES], lon[CASE_LINES];
+    struct aivdm_positions_t pos;
+    size_t i, len = 0, n = case_lines(c);
+
+    for (i = 0; i < n; i++)
+	len += (size_t)snprintf(buf + len, sizeof(buf) - len, "%s\n",
+				c->line[i]);
+    memset(&pos, 0, sizeof(pos));
+    pos.maxrows = CASE_LINES;
+    pos.lat = lat;
+    pos.lon = lon;
+    memset(&session, 0, sizeof(session));
+    if (aivdm_decode_positions(buf, len, &session, &pos) != len) {
+	(void)fprintf(stderr, "%s: positions not all consumed\n", c->name);
+	return 1;
+    }
+    return 0;
+}
+
+static int run_checksum_flags(int nthreads)
+/* under checksum_flag each message of a batch carries its own flag */
+{
+    static const struct aivdm_span_t span[] = {
+#define SPAN(s)	{s, sizeof(s) - 1}
+	SPAN("!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*24"),
+	SPAN("!AIVDM,1,1,,B,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*00"),
+	SPAN("!AIVDM,1,1,,B,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*4D"),
+	SPAN("!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*25"),
+#undef SPAN
+    };
+    static const bool expect[] = {false, true, false, true};
+    static struct gps_device_t shard[AIVDM_CHANNELS];
+    bool checksum_bad[CASE_LINES];
+    struct aivdm_batch_t batch = {ais, CASE_LINES, NULL, checksum_bad, NULL,
+				  CASE_LINES, true, 0, 0};
+    size_t i;
+
+    memset(shard, 0, sizeof(shard));
+    for (i = 0; i < AIVDM_CHANNELS; i++)
+	shard[i].driver.aivdm.checksum = checksum_flag;
+    (void)aivdm_decode_parallel(span, NULL, CASE_LINES, shard, 1,
+				nthreads, &batch);
+    if (batch.nais != CASE_LINES) {
+	(void)fprintf(stderr, "checksum flags, %d threads: %zu decoded\n",
+		      nthreads, batch.nais);
+	return 1;
+    }
+    for (i = 0; i < CASE_LINES; i++)
+	if (checksum_bad[i] != expect[i]) {
+	    (void)fprintf(stderr,
+			  "checksum flags, %d threads: message %zu flag %d\n",
+			  nthreads, i + 1, (int)checksum_bad[i]);
+	    return 1;
+	}
+    return 0;
+}
+
+static int run_position_checksum_flags(void)
+/* the same flags for the columnar decoder, as a bitmap over rows */
+{
+    static const char buf[] =
+	"!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*24\n"
+	"!AIVDM,1,1,,B,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*00\n"
+	"!AIVDM,1,1,,A,402R3WiuHkGOoO`@ANSE1Jw02<1@,0*00\n"
+	"!AIVDM,1,1,,B,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*4D\n"
+	"!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*25\n";
+    unsigned char checksum_bad = 0xff;
+    struct aivdm_positions_t pos;
+
+    memset(&pos, 0, sizeof(pos));
+    pos.maxrows = CASE_LINES;
+    pos.checksum_bad = &checksum_bad;
+    memset(&session, 0, sizeof(session));
+    session.driver.aivdm.checksum = checksum_flag;
+    (void)aivdm_decode_positions(buf, sizeof(buf) - 1, &session, &pos);
+    /* the type 4 line makes no row */
+    if (pos.nrows != 4 || (checksum_bad & 0x0f) != 0x0a) {
+	(void)fprintf(stderr, "position checksum flags: %zu rows, %#x\n",
+		      pos.nrows, (unsigned int)checksum_bad);
+	return 1;
+    }
+    return 0;
+}
+
+#define FILTER_LINES	6
+
+static const struct filter_case_t {
+    const char *name;
+    unsigned long types;
+    unsigned int mmsi[2];	/* the watchlist, if the first is not 0 */
+    const char *line[FILTER_LINES];	/* NULL-terminated unless full */
+    enum aivdm_status_t status[FILTER_LINES];
+    unsigned long matched, skipped;
+} filter_cases[] = {
+    {"filter on types and MMSIs", (1UL << 1) | (1UL << 5),
+     {265547250, 351759000},
+     {"!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*24",
+      "!AIVDM,1,1,,B,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*4D",
+      "!AIVDM,1,1,,A,402R3WiuHkGOoO`@ANSE1Jw02<1@,0*38",
+      "!AIVDM,2,1,1,A,55?MbV02;H;s<HtKR20EHE:0@T4@Dn2222222216L961O5Gf0NSQEp6ClRp8,0*1C",
+      "!AIVDM,2,2,1,A,88888888880,2*25"},
+     {aivdm_decoded, aivdm_filtered, aivdm_filtered, aivdm_pending,
+      aivdm_decoded},
+     3, 2},
+    /* the last message's first part is too short to prefilter */
+    {"filter on types", 1UL << 1, {0, 0},
+     {"!AIVDM,1,1,,B,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*4D",
+      "!AIVDM,2,1,1,A,55?MbV02;H;s<HtKR20EHE:0@T4@Dn2222222216L961O5Gf0NSQEp6ClRp8,0*1C",
+      "!AIVDM,2,2,1,A,88888888880,2*25",
+      "!AIVDM,2,1,7,A,55?MbV,0*00",
+      "!AIVDM,2,2,7,A,02;H;s<HtKR20EHE:0@T4@Dn2222222216L961O5Gf0NSQEp6ClRp888888888880,2*00"},
+     {aivdm_decoded, aivdm_filtered, aivdm_filtered, aivdm_pending,
+      aivdm_filtered},
+     1, 4},
+};
+
+static int run_filter(const struct filter_case_t *c)
+/* the statuses, and every sentence counted as matched or skipped */
+{
+    struct ais_mmsi_set_t *set = NULL;
+    const struct aivdm_stats_t *stats = &session.driver.aivdm.stats;
+    size_t i;
+    int failed = 0;
+
+    memset(&session, 0, sizeof(session));
+    if (c->mmsi[0] != 0) {
+	if ((set = ais_mmsi_set_new(c->mmsi, 2)) == NULL)
+	    return 1;
+	session.driver.aivdm.filter.mmsi = set;
+    }
+    session.driver.aivdm.filter.types = c->types;
+    for (i = 0; i < FILTER_LINES && c->line[i] != NULL; i++) {
+	enum aivdm_status_t status =
+	    aivdm_decode_status(c->line[i], strlen(c->line[i]), &session, ais);
+
+	if (status != c->status[i]) {
+	    (void)fprintf(stderr, "%s: line %zu: status %d, expected %d\n",
+			  c->name, i + 1, (int)status, (int)c->status[i]);
+	    failed = 1;
+	}
+    }
+    if (stats->filter_matched != c->matched
+	|| stats->filter_skipped != c->skipped) {
+	(void)fprintf(stderr,
+		      "%s: %lu matched, %lu skipped, expected %lu, %lu\n",
+		      c->name, stats->filter_matched, stats->filter_skipped,
+		      c->matched, c->skipped);
+	failed = 1;
+    }
+    ais_mmsi_set_free(set);
+    return failed;
+}
+
+static int check_mmsi_set(const char *name, const unsigned int *mmsi,
+			  size_t n, bool bitmap)
+/* every member in, a few non-members and out-of-range values out */
+{
+    static const unsigned int outside[] = {
+	AIS_MMSI_MAX + 1, 0x80000000U, 0xFFFFFFFFU,
+    };
+    struct ais_mmsi_set_t *set = ais_mmsi_set_new(mmsi, n);
+    size_t i;
+    int failed = 0;
+
+    if (set == NULL) {
+	(void)fprintf(stderr, "%s: not built\n", name);
+	return 1;
+    }
+    /* the table is at most an eighth of the bitmap's 128 MB */
+    if ((ais_mmsi_set_bytes(set) > (16U << 20) + 1024) != bitmap) {
+	(void)fprintf(stderr, "%s: %zu bytes, expected a %s\n", name,
+		      ais_mmsi_set_bytes(set), bitmap ? "bitmap" : "table");
+	failed = 1;
+    }
+    if (ais_mmsi_set_size(set) != n) {
+	(void)fprintf(stderr, "%s: size %zu, expected %zu\n", name,
+		      ais_mmsi_set_size(set), n);
+	failed = 1;
+    }
+    for (i = 0; i < n && !failed; i++)
+	if (!ais_mmsi_set_contains(set, mmsi[i])) {
+	    (void)fprintf(stderr, "%s: %u missing\n", name, mmsi[i]);
+	    failed = 1;
+	}
+    /* the members are all odd */
+    for (i = 0; i < 1000 && !failed; i++)
+	if (ais_mmsi_set_contains(set, (unsigned int)(2 * i))) {
+	    (void)fprintf(stderr, "%s: %zu found\n", name, 2 * i);
+	    failed = 1;
+	}
+    for (i = 0; i < sizeof(outside) / sizeof(outside[0]); i++)
+	if (ais_mmsi_set_contains(set, outside[i])) {
+	    (void)fprintf(stderr, "%s: %#x found\n", name, outside[i]);
+	    failed = 1;
+	}
+    ais_mmsi_set_free(set);
+    return failed;
+}
+
+static int run_mmsi_sets(void)
+{
+    /* a set of n MMSIs is a table up to 2^21, a bitmap beyond */
+    static const size_t sizes[] = {0, 1, 17, (size_t)1 << 21,
+				   ((size_t)1 << 21) + 1};
+    unsigned int *mmsi = malloc((((size_t)1 << 21) + 1) * sizeof(*mmsi));
+    unsigned int v;
+    size_t i, n;
+    char name[64];
+    int failed = 0;
+
+    if (mmsi == NULL)
+	return 1;
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+	for (n = 0; n < sizes[i]; n++)
+	    mmsi[n] = (unsigned int)(2 * n * 257 + 1) & AIS_MMSI_MAX;
+	(void)snprintf(name, sizeof(name), "mmsi set of %zu", sizes[i]);
+	failed |= check_mmsi_set(name, mmsi, sizes[i],
+				 sizes[i] > ((size_t)1 << 21));
+    }
+    /*
+     * 17 MMSIs make a table of four buckets of 16; pick ones that all
+     * hash to the last bucket, as ais_mmsi.c does, so that the last
+     * probe wraps past the end of the table to the first bucket.
+     */
+    for (n = 0, v = 1; n < 17; v += 2)
+	if ((uint32_t)(v * 2654435769U) >> 30 == 3)
+	    mmsi[n++] = v;
+    failed |= check_mmsi_set("mmsi set wrapping", mmsi, n, false);
+    free(mmsi);
+    return failed;
+}
+
+static int check_mmsi_read(const char *text, int err, size_t badline,
+			   size_t count)
+/* ais_mmsi_set_read() of text gives count MMSIs, or fails at badline */
+{
+    FILE *fp = fmemopen((void *)text, strlen(text), "r");
+    struct ais_mmsi_set_t *set;
+    size_t line = 99;
+    int failed = 0;
+
+    if (fp == NULL)
+	return 1;
+    errno = 0;
+    set = ais_mmsi_set_read(fp, &line);
+    if (err != 0)
+	failed = set != NULL || errno != err;
+    else
+	failed = set == NULL || ais_mmsi_set_size(set) != count;
+    if (line != badline)
+	failed = 1;
+    if (failed)
+	(void)fprintf(stderr, "mmsi read of \"%s\": errno %d, badline %zu\n",
+		      text, errno, line);
+    ais_mmsi_set_free(set);
+    (void)fclose(fp);
+    return failed;
+}
+
+static int run_mmsi_reads(void)
+{
+    return check_mmsi_read("", 0, 0, 0)
+	| check_mmsi_read("# fleet\n\n 1\t# first\n2\r\n2\n1073741823\n",
+			  0, 0, 3)
+	| check_mmsi_read("1\n2x\n3\n", EINVAL, 2, 0)
+	| check_mmsi_read("1\n\n-3\n", EINVAL, 3, 0)
+	| check_mmsi_read("1\n1073741824\n", ERANGE, 2, 0)
+	| check_mmsi_read("99999999999999999999999\n", ERANGE, 1, 0);
+}
+
+int main(void)
+{
+    size_t i, k;
+    int failed = 0;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+	failed |= run_status(&cases[i]) | run_spans(&cases[i])
+	    | run_positions(&cases[i]);
+    failed |= run_checksum_flags(1) | run_checksum_flags(2)
+	| run_position_checksum_flags();
+    for (k = 0; k < sizeof(filter_cases) / sizeof(filter_cases[0]); k++)
+	failed |= run_filter(&filter_cases[k]);
+    failed |= run_mmsi_sets() | run_mmsi_reads();
+    (void)printf("regress: %zu cases, %zu filter cases, %s\n", i, k,
+		 failed ? "FAILED" : "ok");
+    return failed;
+}
+
+/* regress.c ends here */
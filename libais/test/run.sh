@@ -0,0 +1,31 @@
+#!/bin/sh
+#
+# Build the C tests against the library sources with the address and
+# undefined-behaviour sanitizers, and run them, then check the Arrow
+# output of the command-line decoder, built the same way.  From anywhere:
+#
+#     sh libais/test/run.sh
+#
+# CC and CFLAGS are taken from the environment.
+#
+set -e
+cd "$(dirname "$0")/.."
+
+CC=${CC:-cc}
+CFLAGS=${CFLAGS:-"-O1 -g -fno-omit-frame-pointer"}
+SANITIZE="-fsanitize=address,undefined -fno-sanitize-recover=all"
+SRCS="libais.c driver_ais.c bits.c gpsd_json.c ais_record.c ais_arrow.c ais_mmsi.c strl.c"
+OUT=${TMPDIR:-/tmp}/libais-test.$$
+mkdir -p "$OUT"
+trap 'rm -rf "$OUT"' EXIT
+
+$CC $CFLAGS $SANITIZE -I. -o "$OUT/regress" test/regress.c $SRCS -lm -lpthread
+"$OUT/regress"
+
+# includes libais.c, for the kernels
+$CC $CFLAGS $SANITIZE -I. -o "$OUT/dearmor" test/dearmor.c \
+    $(echo "$SRCS" | sed 's/libais\.c //') -lm -lpthread
+"$OUT/dearmor"
+
+# the Arrow writer, through the command-line decoder; needs pyarrow
+CC="$CC" CFLAGS="$CFLAGS" python3 test/test_arrow.py
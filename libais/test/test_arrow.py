@@ -0,0 +1,211 @@
+"""The Arrow streams must hold what the JSON reports say.
+
+The command-line decoder is built from the sources with the sanitizers,
+as run.sh builds the C tests, and run over a seeded random corpus
+covering types 1-27 twice: once for unscaled JSON reports, once for the
+four Arrow streams.  Each stream has to pass pyarrow's full validation,
+and every row has to match the JSON report of its message, value for
+value and null for null.  Skipped when pyarrow is missing.  From
+anywhere:
+
+    python3 libais/test/test_arrow.py [messages [seed]]
+
+CC and CFLAGS are taken from the environment.
+"""
+import calendar
+import datetime
+import json
+import os
+import re
+import shlex
+import struct
+import subprocess
+import sys
+import tempfile
+
+from corpus import corpus
+
+try:
+    import pyarrow.ipc
+except ImportError:
+    print('test_arrow: pyarrow not installed; skipped')
+    sys.exit(0)
+
+SOURCES = ['main.c', 'libais.c', 'driver_ais.c', 'bits.c', 'gpsd_json.c',
+           'ais_record.c', 'ais_arrow.c', 'ais_mmsi.c', 'strl.c']
+SANITIZE = ['-fsanitize=address,undefined', '-fno-sanitize-recover=all']
+FAMILIES = {'positions': (1, 2, 3, 18, 19, 27), 'static': (5, 24),
+            'base': (4, 11), 'binary': (6, 8, 25, 26)}
+
+LATLON_DIV = 600000.0
+LONGRANGE_LATLON_DIV = 600.0
+
+
+def float32(value):
+    return struct.unpack('f', struct.pack('f', value))[0]
+
+
+def degrees(value, div, limit):
+    return value / div if abs(value) <= limit * div else None
+
+
+def position_row(j):
+    t = j['type']
+    longrange = t == 27
+    div = LONGRANGE_LATLON_DIV if longrange else LATLON_DIV
+    if longrange:
+        speed = j['speed'] if j['speed'] != 63 else None
+        course = j['course'] if j['course'] < 360 else None
+    else:
+        speed = float32(j['speed'] / 10.0) if j['speed'] != 1023 else None
+        course = float32(j['course'] / 10.0) if j['course'] < 3600 else None
+    return {
+        'status': j['status'] if t <= 3 or longrange else None,
+        'turn': j['turn'] if t <= 3 and abs(j['turn']) != 128 else None,
+        'speed': speed,
+        'accuracy': j['accuracy'],
+        'lon': degrees(j['lon'], div, 180),
+        'lat': degrees(j['lat'], div, 90),
+        'course': course,
+        'heading': j['heading'] if not longrange and j['heading'] < 360
+        else None,
+        'second': j['second'] if not longrange and j['second'] < 60
+        else None,
+        'raim': j['raim'],
+    }
+
+
+def fields(stamp):
+    """The numbers of an ETA or timestamp, each as received."""
+    return [int(n) for n in re.findall(r'\d+', stamp)]
+
+
+def static_row(j):
+    """Type 5, or the parts of type 24 the report carries."""
+    row = {k: j.get(k) for k in (
+        'imo', 'ais_version', 'callsign', 'shipname', 'shiptype',
+        'vendorid', 'model', 'serial', 'mothership_mmsi', 'to_bow',
+        'to_stern', 'to_port', 'to_starboard', 'epfd', 'destination',
+        'dte')}
+    row.update(eta_month=None, eta_day=None, eta_hour=None,
+               eta_minute=None, draught=None)
+    if j['type'] == 5:
+        month, day, hour, minute = fields(j['eta'])
+        row.update(eta_month=month or None, eta_day=day or None,
+                   eta_hour=hour if hour != 24 else None,
+                   eta_minute=minute if minute != 60 else None,
+                   draught=float32(j['draught'] / 10.0))
+    return row
+
+
+def base_row(j):
+    year, month, day, hour, minute, second = fields(j['timestamp'])
+    try:
+        datetime.date(year, month, day)
+        date = True
+    except ValueError:
+        date = False
+    valid = date and hour < 24 and minute < 60 and second < 60
+    return {
+        'timestamp': calendar.timegm((year, month, day, hour, minute, second))
+        if valid else None,
+        'year': year if 0 < year <= 9999 else None,
+        'month': month if 0 < month <= 12 else None,
+        'day': day if 0 < day <= 31 else None,
+        'hour': hour if hour < 24 else None,
+        'minute': minute if minute < 60 else None,
+        'second': second if second < 60 else None,
+        'accuracy': j['accuracy'],
+        'lon': degrees(j['lon'], LATLON_DIV, 180),
+        'lat': degrees(j['lat'], LATLON_DIV, 90),
+        'epfd': j['epfd'],
+        'raim': j['raim'],
+    }
+
+
+def binary_row(j):
+    t = j['type']
+    if t in (6, 8):
+        dac, fid = j['dac'], j['fid']
+    elif j['structured']:
+        dac, fid = j['app_id'] >> 6, j['app_id'] & 0x3f
+    else:
+        dac = fid = None
+    row = {
+        'dest_mmsi': j['dest_mmsi'] if t == 6 or (t != 8 and j['addressed'])
+        else None,
+        'dac': dac,
+        'fid': fid,
+        'data': None,
+    }
+    # decoded application data leaves no raw bits behind
+    if 'data' in j:
+        bitcount, _, data = j['data'].partition(':')
+        row.update(bitcount=int(bitcount), data=bytes.fromhex(data))
+    return row
+
+
+ROWS = {'positions': position_row, 'static': static_row,
+        'base': base_row, 'binary': binary_row}
+
+
+def build(workdir):
+    here = os.path.dirname(os.path.abspath(__file__))
+    src = os.path.join(here, '..')
+    cli = os.path.join(workdir, 'libais')
+    cc = shlex.split(os.environ.get('CC', 'cc'))
+    cflags = shlex.split(os.environ.get('CFLAGS',
+                                        '-O1 -g -fno-omit-frame-pointer'))
+    subprocess.run(cc + cflags + SANITIZE + ['-I', src, '-o', cli]
+                   + [os.path.join(src, s) for s in SOURCES]
+                   + ['-lm', '-lpthread'], check=True)
+    return cli
+
+
+def check_streams(cli, workdir, lines):
+    log = os.path.join(workdir, 'corpus.nmea')
+    with open(log, 'w') as fp:
+        fp.write('\n'.join(lines) + '\n')
+    reports = subprocess.run([cli, '-q', '-u', log], check=True,
+                             stdout=subprocess.PIPE).stdout
+    reports = [json.loads(r) for r in reports.decode().splitlines()]
+    prefix = os.path.join(workdir, 'out')
+    subprocess.run([cli, '-q', '-f', 'arrow', '-o', prefix, log], check=True)
+
+    counts = {}
+    for family, types in FAMILIES.items():
+        table = pyarrow.ipc.open_stream(
+            '%s.%s.arrow' % (prefix, family)).read_all()
+        table.validate(full=True)
+        if 'timestamp' in table.column_names:
+            table = table.set_column(
+                table.column_names.index('timestamp'), 'timestamp',
+                table.column('timestamp').cast('int64'))
+        rows = table.to_pylist()
+        expected = [j for j in reports if j['type'] in types]
+        assert len(rows) == len(expected), \
+            '%s: %d rows for %d messages' % (family, len(rows), len(expected))
+        for row, j in zip(rows, expected):
+            want = {'type': j['type'], 'repeat': j['repeat'],
+                    'mmsi': j['mmsi']}
+            want.update(ROWS[family](j))
+            got = {k: row[k] for k in want}
+            assert got == want, '%s\n json  %s\n arrow %s\n want  %s' % (
+                family, j, row, want)
+        assert {j['type'] for j in expected} == set(types), family
+        counts[family] = len(rows)
+    return counts
+
+
+def main():
+    count = int(sys.argv[1]) if len(sys.argv) > 1 else 20000
+    seed = int(sys.argv[2]) if len(sys.argv) > 2 else 1
+    with tempfile.TemporaryDirectory() as workdir:
+        cli = build(workdir)
+        counts = check_streams(cli, workdir, corpus(count, seed))
+    print('test_arrow: %d messages, %s; ok' % (
+        count, ', '.join('%d %s' % (n, f) for f, n in counts.items())))
+
+
+if __name__ == '__main__':
+    main()
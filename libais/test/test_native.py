@@ -0,0 +1,58 @@
+"""Native reports must equal the JSON reports parsed by json.loads().
+
+For every message of a seeded random corpus covering types 1-27,
+decode_many(native=True) has to give exactly the dict, key order
+included, that json.loads() makes of the JSON report.  Build the
+module in place first, then run this from anywhere:
+
+    cd libais && python3 setup.py build_ext --inplace
+    python3 libais/test/test_native.py [messages [seed]]
+"""
+import json
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import libais
+
+from corpus import corpus, put, sentences
+
+
+def check_equivalence(lines):
+    reports = libais.Decoder().decode_many(lines)
+    natives = libais.Decoder().decode_many(lines, native=True)
+    seen = set()
+    for line, report, native in zip(lines, reports, natives):
+        assert (report is None) == (native is None), line
+        if report is None:
+            continue
+        parsed = json.loads(report)
+        assert list(parsed.items()) == list(native.items()), \
+            '%s\n json   %s\n native %s' % (line, parsed, native)
+        seen.add(native['type'])
+    missing = set(range(1, 28)) - seen
+    assert not missing, 'no message of type %s decoded' % sorted(missing)
+    return len(seen)
+
+
+def check_type9_speed():
+    """Type 9 speed comes from its own field, not type 1's."""
+    bits = format(9, '06b') + '0' * 162
+    bits = put(bits, 8, 30, 123456789)     # mmsi
+    bits = put(bits, 50, 10, 123)          # speed, knots
+    line = sentences(bits, 0, 'A')[0]
+    report = json.loads(libais.Decoder().decode(line))
+    native = libais.Decoder().decode(line, native=True)
+    assert report['speed'] == native['speed'] == 123, (report, native)
+
+
+def main():
+    count = int(sys.argv[1]) if len(sys.argv) > 1 else 20000
+    seed = int(sys.argv[2]) if len(sys.argv) > 2 else 1
+    ntypes = check_equivalence(corpus(count, seed))
+    check_type9_speed()
+    print('test_native: %d messages, %d types; ok' % (count, ntypes))
+
+
+if __name__ == '__main__':
+    main()